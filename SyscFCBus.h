@@ -18,452 +18,125 @@
  */
 
 /** \file  SyscFCBus.h
- *  \brief Declares the Bus structure, it's helpers, and the Bus_src class.
+ *  \brief Declares the Bus_src class.
  *
- *  This file declares the Bus structure along with it's helper types,
- *  functions and constants and the Bus_src class.
+ *  This file declares the Bus_src class, which requests frames from a
+ *  SyscDrv driver.  The Bus structure and it's helpers are declared in
+ *  SyscFCBusCore.h, which is included here.
  *
  */
 
 #ifndef _SYSCFCBUS_H_
     #define _SYSCFCBUS_H_
 
-    #include <iostream>
-    #include <iomanip>
-    #include <type_traits>
-    #include <systemc>
-    #include <SyscMsg.h>
+    #include <SyscFCBusCore.h>
     #include <SyscDrv.h>
     #include <SyscJson.h>
 
-    /** \brief Namespace for the SyscFCBus templates
-     *
-     */
-
     namespace SyscFCBus
     {
-        using namespace std;
-
-        /** \class no_connect
-         *  \brief Value assigned to mod element for 8-bit Bus instances.
-         */
-
-        class no_connect {};
-
-        inline bool operator==(const no_connect& l, const no_connect & r)
-        {
-            return true;
-        }
-
-        inline bool operator!=(const no_connect& l, const no_connect & r)
-        {
-            return false;
-        }
-
-        inline ostream& operator<<(ostream& os, const no_connect & arg)
-        {
-            os << "null";
-            return os;
-        }
-
-        inline void sc_trace(sc_trace_file * tf, const no_connect & arg, const std::string & nm)
-        {
-            sc_trace(tf, false, nm);
-        }
-
-        /** \struct typ_mod
-         *  \brief Type definition for Bus.mod
-         */
-
-        template <unsigned T_be> struct typ_mod     { using typ = uint32_t;   };
-        template <>              struct typ_mod<1U> { using typ = bool;       };
-        template <>              struct typ_mod<0U> { using typ = no_connect; };
-
-        /** \struct typ_dat
-         *  \brief Type definition for Bus.dat
-         */
-
-        template <unsigned T_be> struct typ_dat     { using typ = uint32_t;          };
-        template <>              struct typ_dat<3U> { using typ = uint64_t;          };
-        template <>              struct typ_dat<4U> { using typ = sc_dt::sc_bv<128>; };
-        template <>              struct typ_dat<5U> { using typ = sc_dt::sc_bv<256>; };
-        template <>              struct typ_dat<6U> { using typ = sc_dt::sc_bv<512>; };
-
-        /** \struct typ_scdat
-         *  \brief  Type definition for manipulating Bus.dat using sc_dt::sc_uint or sc_dt::sc_bv semantics
-         */
-
-        template <unsigned T_be> struct typ_scdat     { using typ = sc_dt::sc_uint<32>; };
-        template <>              struct typ_scdat<3U> { using typ = sc_dt::sc_uint<64>; };
-        template <>              struct typ_scdat<4U> { using typ = sc_dt::sc_bv<128>;  };
-        template <>              struct typ_scdat<5U> { using typ = sc_dt::sc_bv<256>;  };
-        template <>              struct typ_scdat<6U> { using typ = sc_dt::sc_bv<512>;  };
-
-        template <unsigned T_be> using Mod   = typename typ_mod<T_be>::typ;
-        template <unsigned T_be> using Dat   = typename typ_dat<T_be>::typ;
-        template <unsigned T_be> using SCDat = typename typ_scdat<T_be>::typ;
-
-        /** \struct Bus
-         *  \brief  Representation of a frame or cell as carried on a datapath.
-         *
-         *  <h2 class="mp">Template Parameter</h2>
+        /** \class  Frm_drv
+         *  \brief  Frame source that requests frames from a SyscDrv driver
          *
-         *  %Bus width is specified by T_be.
-         *  The "be" in T_be stands for "byte exponent" and the number of bytes in
-         *  the bus is 2^T_be.
-         *
-         *  <h2 class="mp">%Bus Fields</h2>
-         *
-         *  %Bus fields are
-         *  + usr[31:0]
-         *  + err
-         *  + val
-         *  + sof
-         *  + eof
-         *  + dat[((M*8)-1):0]
-         *  + mod[(N-1):0]
-         *
-         *  Where N is the byte exponent and M is 2^N.
-         *
-         *  <h3 class="mp">Mod Field</h3>
-         *
-         *  When T_be = 0, mod is instantiated as the empty class SyscFCBus::no_connect.
-         */
-        /** \fn    Bus::static_assert()
-         *  \brief Ensures failure at compile time for unsupported values of T_be
-         */
-        /** \fn    Bus::operator=()
-         *  \brief Copy constructor for Bus instances
-         */
-        /** \var   Bus::usr
-         *  \brief Unspecified 32-bit field for application use.  May be used for
-         *  the ATM cell fields {usr[3:0], vpi[11:0], vci[15:0]}.
-         */
-        /** \var   Bus::err
-         *  \brief Indicates that the frame has an error in this or a previous clock
-         */
-        /** \var   Bus::val
-         *  \brief Indicates that the data in the Bus structure is valid
-         */
-        /** \var   Bus::sof
-         *  \brief Indicates that the Bus structure is the first in the frame
-         */
-        /** \var   Bus::eof
-         *  \brief Indicates that the Bus structure is the last in the frame
-         */
-        /** \var   Bus::mod
-         *  \brief Indicates the number of valid bytes
-         */
-        /** \var   Bus::dat
-         *  \brief For the datapath bytes
+         *  Each request to the driver handler returns one frame encoded as
+         *  {"frame_len": N, "frame": ["XX", ...]}.  The decoded bytes are kept in
+         *  two alternating buffers to meet the Frm_src validity rule.
          */
 
-        template <unsigned T_be>
-        struct Bus
+        class Frm_drv : public Frm_src
         {
-            static_assert((T_be < 7), "Bus byte count out of range");
-
-            uint32_t  usr;
-            bool      err;
-            bool      val;
-            bool      sof;
-            bool      eof;
-            Mod<T_be> mod;
-            Dat<T_be> dat;
-
-            static constexpr uint32_t bits_usr = 31;
-            static constexpr uint32_t bits_mod = T_be;
-            static constexpr uint32_t bits_dat = 8 * (1 << T_be);
-
-            Bus<T_be>& operator=(const Bus<T_be>& arg)
-            {
-                if (this == &arg)
-                {
-                    return *this;
-                }
+            private:
+                unique_ptr<SyscMsg::Msg>   msg;
+                Log_src                    lg;
+                SyscDrv::DrvClient       * drv;
+                string                     drv_handler;
+                string                     drv_req;
+                vector<uint8_t>            buf[2];
+                unsigned                   buf_idx;
 
-                usr = arg.usr;
-                err = arg.err;
-                val = arg.val;
-                sof = arg.sof;
-                eof = arg.eof;
-                mod = arg.mod;
-                dat = arg.dat;
+            public:
+                Frm_drv(const string &, SyscDrv::DrvClient*, const string &, const string &);
+                ~Frm_drv(void);
 
-                return *this;
-            }
+                bool get_frame(const uint8_t *&, unsigned &);
         };
 
-        template <unsigned T_be>
-        typename std::enable_if<(T_be == 0U), Bus<T_be>>::type bus_rst(void)
-        {
-            return {0,false,false,false,false,{},0};
-        }
-
-        template <unsigned T_be>
-        typename std::enable_if<(T_be == 1U), Bus<T_be>>::type bus_rst(void)
-        {
-            return {0,false,false,false,false,false,0};
-        }
-
-        template <unsigned T_be>
-        typename std::enable_if<(T_be > 1U), Bus<T_be>>::type bus_rst(void)
-        {
-            return {0,false,false,false,false,0,0};
-        }
-
-        template <unsigned T_be>
-        typename std::enable_if<(T_be == 0U), Mod<T_be>>::type mod_rst(void)
-        {
-            return {};
-        }
-
-        template <unsigned T_be>
-        typename std::enable_if<(T_be == 1U), Mod<T_be>>::type mod_rst(void)
-        {
-            return false;
-        }
-
-        template <unsigned T_be>
-        typename std::enable_if<(T_be > 1U), Mod<T_be>>::type mod_rst(void)
+        inline Frm_drv::Frm_drv(const string & arg_nm, SyscDrv::DrvClient * arg_di, const string & arg_dh, const string & arg_dr)
+            : lg(arg_nm)
         {
-            return 0;
+            this->msg         = unique_ptr<SyscMsg::Msg>(new SyscMsg::Msg(arg_nm));
+            this->drv         = arg_di;
+            this->drv_handler = arg_dh;
+            this->drv_req     = arg_dr;
+            this->buf_idx     = 0;
         }
 
-        template <unsigned T_be>
-        typename std::enable_if<(T_be == 0U), Mod<T_be>>::type mod_set(uint32_t arg)
-        {
-            return {};
-        }
+        inline Frm_drv::~Frm_drv(void) { }
 
-        template <unsigned T_be>
-        typename std::enable_if<(T_be == 1U), Mod<T_be>>::type mod_set(uint32_t arg)
+        inline bool Frm_drv::get_frame(const uint8_t *& arg_dat, unsigned & arg_cnt)
         {
-            return (arg != 0);
-        }
-
-        template <unsigned T_be>
-        typename std::enable_if<(T_be > 1U), Mod<T_be>>::type mod_set(uint32_t arg)
-        {
-            return arg;
-        }
+            string             str_res_data     = "";
+            string             str_search       = "";
+            string             str_context      = "";
+            string             SP               = SyscMsg::Chars::SP;
+            SyscJson::JsonFind jfind;
+            ostringstream      os;
+            vector<uint8_t>  & frm              = this->buf[this->buf_idx];
 
-        template <unsigned T_be>
-        typename std::enable_if<(T_be == 0U), unsigned>::type mod_get_uint(Mod<T_be> arg)
-        {
-            return 0;
-        }
+            log_dbg(this->lg, "req is {}", this->drv_req);
 
-        template <unsigned T_be>
-        typename std::enable_if<(T_be > 0U), unsigned>::type mod_get_uint(Mod<T_be> arg)
-        {
-            return arg;
-        }
+            this->drv->request(str_res_data, this->drv_handler, this->drv_req);
 
-        template <unsigned T_be>
-        unsigned bus_get_byte_cnt(Bus<T_be> arg)
-        {
-            unsigned ret = 0;
-            unsigned mod = 0;
-            unsigned max = (1 << T_be);
+            log_dbg(this->lg, "res is {}", str_res_data);
 
-            if (T_be > 0)
-            {
-                mod = mod_get_uint<T_be>(arg.mod);
-            }
+            os << "{\"frame_len\":true}";
+            str_search = os.str();
 
-            if (mod == 0)
+            try
             {
-                 ret = max;
+                jfind.set_search_context(str_res_data);
+                jfind.set_search_path(str_search);
             }
-            else
+            catch (SyscJson::JsonFindErr & err)
             {
-                ret = mod;
+                this->msg->cerr_err("[EXPT] SyscFCBus::Frm_drv::get_frame() JsonFindErr msg:" + SP + err.get_msg());
+                throw;
             }
 
-            return ret;
-        }
+            jfind.find();
+            jfind.get_context_string(str_context);
 
-        template <unsigned T_be>
-        inline bool operator==(const Bus<T_be>& l, const Bus<T_be>& r)
-        {
-            if (l.usr != r.usr) { return false; }
-            if (l.err != r.err) { return false; }
-            if (l.val != r.val) { return false; }
-            if (l.sof != r.sof) { return false; }
-            if (l.eof != r.eof) { return false; }
-            if (l.mod != r.mod) { return false; }
-            if (l.dat != r.dat) { return false; }
-            return true;
-        }
+            frm.resize(stoul(str_context, nullptr, 10));
 
-        template <unsigned T_be>
-        inline bool operator!=(const Bus<T_be>& l, const Bus<T_be>& r)
-        {
-            return !(l == r);
-        }
+            log_dbg(this->lg, "next frame_len is {}", str_context);
 
-        template <unsigned T_be>
-        inline ostream& operator<<(ostream& os, const Bus<T_be>& arg)
-        {
-            char     SP    = '\x020';
-            char     NL    = '\n';
-            unsigned w     = 3;
-            unsigned modn  = (T_be > 4) ? 2 : 1;
-            unsigned datn  = (1 << T_be) * 2;
-            unsigned bits  = 8 * (1 << T_be);
-            unsigned msbh  = bits - 1;
-            unsigned lsbh  = bits / 2;
-            unsigned msbl  = lsbh - 1;
-            string   usrs  = "usr[31:0]";
-            string   mods  = "";
-            string   daths = "";
-            string   datls = "";
-
-            SCDat<T_be> scdat = arg.dat;
-
-            if (T_be == 1U)
-            {
-                mods  = string("mod");
-            }
-            else if (T_be != 0U)
+            for (unsigned i = 0 ; i < frm.size() ; i++)
             {
-                mods  = string("mod[") + to_string(T_be - 1) + ":0]";
-            }
-
-            if (T_be == 6)
-            {
-                daths = string("dat[") + to_string(msbh) + ":" + to_string(lsbh) + "]";
-                datls = string("dat[") + to_string(msbl) + ":0]";
-            }
-            else
-            {
-                datls = string("dat[") + to_string(msbh) + ":0]";
-            }
-
-            if (usrs.size()  > w) { w = usrs.size();  }
-            if (mods.size()  > w) { w = mods.size();  }
-            if (datls.size() > w) { w = datls.size(); }
-            if (daths.size() > w) { w = daths.size(); }
-
-            os << hex;
-            os << SP << setw(w) << setfill(SP) << usrs  << SP << "= 0x" << setw(1) << setfill('0') << arg.usr << NL;
-            os << SP << setw(w) << setfill(SP) << "err" << SP << "= 0x" << setw(1) << setfill('0') << arg.err << NL;
-            os << SP << setw(w) << setfill(SP) << "val" << SP << "= 0x" << setw(1) << setfill('0') << arg.val << NL;
-            os << SP << setw(w) << setfill(SP) << "sof" << SP << "= 0x" << setw(1) << setfill('0') << arg.sof << NL;
-            os << SP << setw(w) << setfill(SP) << "eof" << SP << "= 0x" << setw(1) << setfill('0') << arg.eof << NL;
+                os.str("");
+                os << "{\"frame\":[" << i << ",true]}";
+                str_search = os.str();
 
-            if (T_be > 0)
-            {
-                os << SP << setw(w) << setfill(SP) << mods  << SP << "= 0x" << setw(modn) << setfill('0') << arg.mod << NL;
-            }
+                try
+                {
+                    jfind.set_search_path(str_search);
+                }
+                catch (SyscJson::JsonFindErr & err)
+                {
+                    this->msg->cerr_err("[EXPT] SyscFCBus::Frm_drv::get_frame() JsonFindErr msg:" + SP + err.get_msg());
+                    throw;
+                }
 
-            if (T_be == 6)
-            {
-                unsigned ccnt  = datn / 2;
+                jfind.find();
+                jfind.get_context_string(str_context);
 
-                os << SP << setw(w) << setfill(SP) << daths  << SP << "= 0x" << setw(ccnt) << setfill('0') ;
-                os << scdat.range(msbh, lsbh) << NL;
-                os << SP << setw(w) << setfill(SP) << datls  << SP << "= 0x" << setw(ccnt) << setfill('0') ;
-                os << scdat.range(msbl, 0) << NL;
+                frm[i] = stoul(str_context, nullptr, 16);
             }
-            else
-            {
-                os << SP << setw(w) << setfill(SP) << datls  << SP << "= 0x" << setw(datn) << setfill('0') ;
-                os << scdat.range(msbh,0) << NL;
-            }
-
-            os << flush;
-
-            return os;
-        }
-
-        template <unsigned T_be>
-        inline typename std::enable_if<(T_be == 0U), void>::type
-        sc_trace(sc_trace_file * tf, const Bus<T_be> & arg, const std::string & nm)
-        {
-            sc_trace(tf, arg.usr, nm + ".usr");
-            sc_trace(tf, arg.err, nm + ".err");
-            sc_trace(tf, arg.val, nm + ".val");
-            sc_trace(tf, arg.sof, nm + ".sof");
-            sc_trace(tf, arg.eof, nm + ".eof");
-            sc_trace(tf, arg.dat, nm + ".dat");
-        }
-
-        template <unsigned T_be>
-        inline typename std::enable_if<(T_be == 1U), void>::type
-        sc_trace(sc_trace_file * tf, const Bus<T_be> & arg, const std::string & nm)
-        {
-            sc_trace(tf, arg.usr, nm + ".usr");
-            sc_trace(tf, arg.err, nm + ".err");
-            sc_trace(tf, arg.val, nm + ".val");
-            sc_trace(tf, arg.sof, nm + ".sof");
-            sc_trace(tf, arg.eof, nm + ".eof");
-            sc_trace(tf, arg.mod, nm + ".mod");
-            sc_trace(tf, arg.dat, nm + ".dat");
-        }
-
-        template <unsigned T_be>
-        inline typename std::enable_if<(T_be > 1U), void>::type
-        sc_trace(sc_trace_file * tf, const Bus<T_be> & arg, const std::string & nm)
-        {
-            sc_trace(tf, arg.usr, nm + ".usr");
-            sc_trace(tf, arg.err, nm + ".err");
-            sc_trace(tf, arg.val, nm + ".val");
-            sc_trace(tf, arg.sof, nm + ".sof");
-            sc_trace(tf, arg.eof, nm + ".eof");
-            sc_trace(tf, arg.mod, nm + ".mod");
-            sc_trace(tf, arg.dat, nm + ".dat");
-        }
 
-        typedef vector<string> str_vec;
+            arg_dat       = frm.data();
+            arg_cnt       = frm.size();
+            this->buf_idx = this->buf_idx ^ 1;
 
-        /** \class  Bus_split
-         *  \brief  Breaks out individual signals from a Bus
-         */
-
-        template <unsigned T_be>
-        class Bus_split : public sc_module
-        {
-            public:
-                SC_HAS_PROCESS(Bus_split);
-                Bus_split(sc_module_name);
-                ~Bus_split(void);
-
-                sc_core::sc_out <uint32_t>  usr_o;
-                sc_core::sc_out <bool>      err_o;
-                sc_core::sc_out <bool>      val_o;
-                sc_core::sc_out <bool>      sof_o;
-                sc_core::sc_out <bool>      eof_o;
-                sc_core::sc_out <Mod<T_be>> mod_o;
-                sc_core::sc_out <Dat<T_be>> dat_o;
-                sc_core::sc_in  <Bus<T_be>> bus_i;
-
-                void run(void);
-        };
-
-        template <unsigned T_be>
-        Bus_split<T_be>::Bus_split(sc_module_name arg_nm)
-        {
-            SC_METHOD(run);
-            sensitive << this->bus_i;
-        }
-
-        template <unsigned T_be>
-        Bus_split<T_be>::~Bus_split(void) { }
-
-        template <unsigned T_be>
-        void Bus_split<T_be>::run(void)
-        {
-            Bus<T_be> sig_bus = this->bus_i;
-
-            this->usr_o = sig_bus.usr;
-            this->err_o = sig_bus.err;
-            this->val_o = sig_bus.val;
-            this->sof_o = sig_bus.sof;
-            this->eof_o = sig_bus.eof;
-            this->mod_o = sig_bus.mod;
-            this->dat_o = sig_bus.dat;
+            return true;
         }
 
         /** \class  Bus_src
@@ -471,37 +144,23 @@
          *
          *  The driver method Bus_src::drive() places full frames (mod may indicate
          *  non-zero only when the eof indication is asserted) on the output bus.
+         *  It is a clocked thread around a Bus_src_eng, which holds the frames
+         *  and the state machine.  By default frames are requested from the
+         *  SyscDrv driver given to the constructor.
          *
          *  Other possibly useful driver implementations would be drive_part_frame(),
-         *  where mod may be non-zero on any clock cycle.  Another would be
-         *  drive_cell() which would drive an ATM cell onto the bus.
+         *  where mod may be non-zero on any clock cycle; this is provided by
+         *  set_part().  ATM cells are driven by Bus_cell_src::drive_cell(), in
+         *  SyscFCBusCell.h.  Errors are injected into frames by set_err().
          */
 
         template <unsigned T_be>
         class Bus_src : public sc_module
         {
             private:
-                typedef struct struct_frame
-                {
-                    str_vec  str_bytes;
-                    unsigned byte_cnt;
-                    unsigned byte_last;
-                    unsigned byte_req;
-                    uint64_t bit_cnt;
-                } frame;
-
                 unique_ptr<SyscMsg::Msg>   msg;
-                SyscDrv::DrvClient       * drv;
-                string                     drv_handler;
-                string                     drv_req;
-                frame                    * cur_frm;
-                frame                    * nxt_frm;
-
-                void      get_next_frame(void);
-                void      frame_swap(void);
-                Dat<T_be> get_cur_frame_dat(unsigned);
-                Mod<T_be> get_cur_frame_mod(unsigned);
-                unsigned  incr_drv_cnt(unsigned);
+                Frm_drv                    drv_src;
+                Bus_src_eng<T_be>          eng;
 
             public:
                 SC_HAS_PROCESS(Bus_src);
@@ -521,236 +180,120 @@
                 unsigned                    drv_lc;
 
                 void     drive(void);
+                void     set_frm_src(Frm_src*);
+                void     set_frm_stream(Frm_stream*, unsigned);
+                void     set_pace(uint32_t, uint32_t, unsigned, unsigned);
+                void     set_part(uint64_t, unsigned, unsigned, unsigned);
+                void     set_err(uint64_t, unsigned);
+                void     set_err_rate(enum_err_kind, uint32_t);
                 unsigned get_cur_byte_cnt(void);
                 const str_vec& get_cur_byte_vec(void);
+                Bus_src_eng<T_be>& get_eng(void);
         };
 
         template <unsigned T_be>
         Bus_src<T_be>::Bus_src(sc_module_name arg_nm, SyscDrv::DrvClient * arg_di, string & arg_dh, string & arg_dr)
+            : drv_src(string(arg_nm) + ".drv", arg_di, arg_dh, arg_dr), eng(string(arg_nm) + ".eng")
         {
             this->msg         = unique_ptr<SyscMsg::Msg>(new SyscMsg::Msg(this->name()));
-            this->drv         = arg_di;
-            this->drv_handler = arg_dh;
-            this->drv_req     = arg_dr;
-            this->cur_frm     = nullptr;
-            this->nxt_frm     = nullptr;
+
+            this->eng.set_frm_src(&this->drv_src);
 
             SC_CTHREAD(drive, this->clk_i.pos());
         }
 
         template <unsigned T_be>
-        Bus_src<T_be>::~Bus_src(void) {
-            delete this->cur_frm;
-            delete this->nxt_frm;
-        }
+        Bus_src<T_be>::~Bus_src(void) { }
 
         template <unsigned T_be>
         unsigned Bus_src<T_be>::get_cur_byte_cnt(void)
         {
-            return this->cur_frm->byte_cnt;
+            return this->eng.get_cur_byte_cnt();
         }
 
         template <unsigned T_be>
         const str_vec & Bus_src<T_be>::get_cur_byte_vec(void)
         {
-            return this->cur_frm->str_bytes;
+            return this->eng.get_cur_byte_vec();
         }
 
+        /** \fn    Bus_src::set_frm_src()
+         *  \brief Replaces the SyscDrv driver given to the constructor as the
+         *  source of frames
+         */
+
         template <unsigned T_be>
-        void Bus_src<T_be>::frame_swap(void)
+        void Bus_src<T_be>::set_frm_src(Frm_src * arg_fs)
         {
-            delete this->cur_frm;
-            this->cur_frm = this->nxt_frm;
-            this->nxt_frm = nullptr;
+            this->eng.set_frm_src(arg_fs);
         }
 
+        /** \fn    Bus_src::set_frm_stream()
+         *  \brief Takes frames from a Frm_stream, see Bus_src_eng::set_frm_stream()
+         */
+
         template <unsigned T_be>
-        Mod<T_be> Bus_src<T_be>::get_cur_frame_mod(unsigned arg_cnt)
+        void Bus_src<T_be>::set_frm_stream(Frm_stream * arg_fs, unsigned arg_win)
         {
-            Mod<T_be> ret = mod_rst<T_be>();
-
-            if (T_be == 0U)
-            {
-                return ret;
-            }
-
-            unsigned    cnt  = (1 << T_be);
-            unsigned    dif  = this->cur_frm->byte_cnt - arg_cnt;
-
-            if (dif < cnt)
-            {
-                ret = mod_set<T_be>(dif);
-            }
-
-            return ret;
+            this->eng.set_frm_stream(arg_fs, arg_win);
         }
 
+        /** \fn    Bus_src::set_pace()
+         *  \brief Limits the offered load, see Bus_src_eng::set_pace()
+         */
+
         template <unsigned T_be>
-        Dat<T_be> Bus_src<T_be>::get_cur_frame_dat(unsigned arg_cnt)
+        void Bus_src<T_be>::set_pace(uint32_t arg_num, uint32_t arg_den, unsigned arg_burst, unsigned arg_ovh)
         {
-            SCDat<T_be> dat = 0;
-            unsigned    idx  = arg_cnt;
-            unsigned    cnt  = (1 << T_be);
-            unsigned    lim  = idx + cnt;
-            unsigned    act  = lim;
-            unsigned    msb  = (8 * cnt) - 1;
-            unsigned    lsb  = msb - 7;
-
-            if (this->cur_frm->byte_cnt < lim)
-            {
-                act = this->cur_frm->byte_cnt;
-            }
-
-            while (idx < lim)
-            {
-                if (idx < act)
-                {
-                    dat.range(msb, lsb) = stoul(this->cur_frm->str_bytes.at(idx), 0, 16);
-                }
-                else
-                {
-                    dat.range(msb, lsb) = 0;
-                }
+            this->eng.set_pace(arg_num, arg_den, arg_burst, arg_ovh);
+        }
 
-                msb = msb - 8;
-                lsb = lsb - 8;
-                idx++;
-            }
+        /** \fn    Bus_src::set_part()
+         *  \brief Selects the part-frame mode, see Bus_src_eng::set_part()
+         */
 
-            return dat;
+        template <unsigned T_be>
+        void Bus_src<T_be>::set_part(uint64_t arg_seed, unsigned arg_gap_pct, unsigned arg_gap_max, unsigned arg_part_pct)
+        {
+            this->eng.set_part(arg_seed, arg_gap_pct, arg_gap_max, arg_part_pct);
         }
 
+        /** \fn    Bus_src::set_err()
+         *  \brief Enables error injection, see Bus_src_eng::set_err()
+         */
+
         template <unsigned T_be>
-        unsigned Bus_src<T_be>::incr_drv_cnt(unsigned arg_cnt)
+        void Bus_src<T_be>::set_err(uint64_t arg_seed, unsigned arg_over_len)
         {
-            unsigned    idx  = arg_cnt;
-            unsigned    cnt  = (1 << T_be);
-            unsigned    ret  = idx + cnt;
+            this->eng.set_err(arg_seed, arg_over_len);
+        }
 
-            if (this->cur_frm->byte_cnt < ret)
-            {
-                ret = this->cur_frm->byte_cnt;
-            }
+        /** \fn    Bus_src::set_err_rate()
+         *  \brief Sets the rate of one kind of injected error, see
+         *  Bus_src_eng::set_err_rate()
+         */
 
-            return ret;
+        template <unsigned T_be>
+        void Bus_src<T_be>::set_err_rate(enum_err_kind arg_kind, uint32_t arg_ppm)
+        {
+            this->eng.set_err_rate(arg_kind, arg_ppm);
         }
 
         template <unsigned T_be>
-        void Bus_src<T_be>::get_next_frame(void)
+        Bus_src_eng<T_be> & Bus_src<T_be>::get_eng(void)
         {
-            unsigned           bytes            = (1 << T_be);
-            string             str_res_data     = "";
-            string             str_search       = "";
-            string             str_context      = "";
-            string             SP               = SyscMsg::Chars::SP;
-            SyscJson::JsonFind jfind;
-            ostringstream      os;
-
-            if (false)
-            {
-                this->msg->report_inf("req is" + SP + this->drv_req);
-            }
-
-            this->drv->request(str_res_data, this->drv_handler, this->drv_req);
-
-            if (false)
-            {
-                this->msg->report_inf("res is" + SP + str_res_data);
-            }
-
-            os << "{\"frame_len\":true}";
-            str_search = os.str();
-
-            try
-            {
-                jfind.set_search_context(str_res_data);
-                jfind.set_search_path(str_search);
-            }
-            catch (SyscJson::JsonFindErr & err)
-            {
-                this->msg->cerr_err("[EXPT] SyscFCBus::get_next_frame() JsonFindErr msg:" + SP + err.get_msg());
-                throw;
-            }
-
-            jfind.find();
-            jfind.get_context_string(str_context);
-
-            this->nxt_frm            = new frame;
-            this->nxt_frm->byte_cnt  = stoul(str_context, nullptr, 10);
-            this->nxt_frm->bit_cnt   = this->nxt_frm->byte_cnt * 8;
-
-            if (bytes > this->nxt_frm->byte_cnt)
-            {
-                this->nxt_frm->byte_last = 0;
-            }
-            else
-            {
-                this->nxt_frm->byte_last = this->nxt_frm->byte_cnt - (1 * bytes);
-            }
-
-            if ((2 * bytes) > this->nxt_frm->byte_cnt)
-            {
-                this->nxt_frm->byte_req = 0;
-            }
-            else
-            {
-                this->nxt_frm->byte_req  = this->nxt_frm->byte_cnt - (2 * bytes);
-            }
-
-            if (false)
-            {
-                this->msg->report_inf("next frame_len is" + SP + str_context);
-            }
-
-            for (unsigned i = 0 ; i < this->nxt_frm->byte_cnt ; i++)
-            {
-                os.str("");
-                os << "{\"frame\":[" << i << ",true]}";
-                str_search = os.str();
-
-                try
-                {
-                    jfind.set_search_path(str_search);
-                }
-                catch (SyscJson::JsonFindErr & err)
-                {
-                    this->msg->cerr_err("[EXPT] SyscFCBus::get_next_frame() JsonFindErr msg:" + SP + err.get_msg());
-                    throw;
-                }
-
-                jfind.find();
-                jfind.get_context_string(str_context);
-
-                this->nxt_frm->str_bytes.push_back(str_context);
-            }
+            return this->eng;
         }
 
         template <unsigned T_be>
         void Bus_src<T_be>::drive(void)
         {
-            enum enum_drv_fsm
-            {
-                state_init,
-                state_req,
-                state_ack,
-                state_pen,
-                state_LAST
-            };
-
-            string       SP           = SyscMsg::Chars::SP;
-            unsigned     drv_cnt      = 0;
-            Bus<T_be>    sig_bus      = bus_rst<T_be>();
-            uint64_t     sig_cnt      = 0;
-            bool         sig_req      = false;
-            bool         sig_ack      = false;
-            enum_drv_fsm drv_state    = state_init;
-
-            this->bus_o  = sig_bus;
-            this->req_o  = sig_req;
-            this->cnt_o  = sig_cnt;
+            this->bus_o  = this->eng.get_bus();
+            this->req_o  = this->eng.get_req();
+            this->cnt_o  = this->eng.get_cnt();
             this->sav_o  = true;
-            this->drv_s  = drv_state;
-            this->drv_c  = drv_cnt;
+            this->drv_s  = this->eng.get_state();
+            this->drv_c  = 0;
             this->drv_lc = 0;
             this->drv_ln = 0;
 
@@ -765,179 +308,27 @@
                     continue;
                 }
 
-                sig_ack     = this->ack_i;
-                sig_bus.sof = false;
-                sig_bus.eof = false;
+                this->bus_o  = this->eng.step(true, this->ack_i);
+                this->cnt_o  = this->eng.get_cnt();
+                this->req_o  = this->eng.get_req();
+                this->drv_s  = this->eng.get_state();
+                this->drv_c  = this->eng.get_drv_cnt();
 
-                switch (drv_state)
-                {
-                    case state_init:
-                    {
-                        this->get_next_frame();
-
-                        sig_cnt     = this->nxt_frm->bit_cnt;
-                        sig_req     = true;
-                        sig_bus.dat = 0;
-                        sig_bus.mod = mod_rst<T_be>();
-                        sig_bus.val = false;
-                        drv_state   = state_req;
-
-                        break;
-                    }
-                    case state_req:
-                    {
-                        if (!sig_ack)
-                        {
-                            sig_req     = true;
-                            sig_bus.val = false;
-                            break;
-                        }
-
-                        this->frame_swap();
-
-                        drv_cnt     = 0;
-                        sig_bus.mod = get_cur_frame_mod(drv_cnt);
-                        sig_bus.dat = get_cur_frame_dat(drv_cnt);
-                        sig_bus.sof = true;
-
-                        if (drv_cnt >= this->cur_frm->byte_req)
-                        {
-                            this->get_next_frame();
-
-                            sig_cnt     = this->nxt_frm->bit_cnt;
-                            sig_req     = true;
-                        }
-                        else
-                        {
-                            sig_req     = false;
-                        }
-
-                        if (drv_cnt >= this->cur_frm->byte_last)
-                        {
-                            sig_bus.eof = true;
-                            sig_bus.val = true;
-                            drv_state   = state_req;
-                        }
-                        else if (drv_cnt >= this->cur_frm->byte_req)
-                        {
-                            sig_bus.val = true;
-                            drv_state   = state_pen;
-                        }
-                        else
-                        {
-                            sig_bus.val = true;
-                            drv_state   = state_ack;
-                        }
-
-                        if (false)
-                        {
-                            this->msg->report_inf
-                            (
-                                "SyscFCBus::drive() state_req drv_cnt cur_byte_req cur_byte_last:"
-                                + SP + to_string(drv_cnt)
-                                + SP + to_string(this->cur_frm->byte_req)
-                                + SP + to_string(this->cur_frm->byte_last)
-                            );
-                        }
-
-                        break;
-                    }
-                    case state_ack:
-                    {
-                        drv_cnt     = incr_drv_cnt(drv_cnt);
-                        sig_bus.mod = get_cur_frame_mod(drv_cnt);
-                        sig_bus.dat = get_cur_frame_dat(drv_cnt);
-
-                        if (drv_cnt >= this->cur_frm->byte_req)
-                        {
-                            this->get_next_frame();
-
-                            sig_cnt     = this->nxt_frm->bit_cnt;
-                            sig_req     = true;
-                        }
-                        else
-                        {
-                            sig_req     = false;
-                        }
-
-                        if (drv_cnt >= this->cur_frm->byte_last)
-                        {
-                            sig_bus.eof = true;
-                            sig_bus.val = true;
-                            drv_state   = state_req;
-                        }
-                        else if (drv_cnt >= this->cur_frm->byte_req)
-                        {
-                            sig_bus.val = true;
-                            drv_state   = state_pen;
-                        }
-                        else
-                        {
-                            sig_bus.val = true;
-                            drv_state   = state_ack;
-                        }
-
-                        if (false)
-                        {
-                            this->msg->report_inf
-                            (
-                                "SyscFCBus::drive() state_ack drv_cnt cur_byte_req cur_byte_last:"
-                                + SP + to_string(drv_cnt)
-                                + SP + to_string(this->cur_frm->byte_req)
-                                + SP + to_string(this->cur_frm->byte_last)
-                            );
-                        }
-
-                        break;
-                    }
-                    case state_pen:
-                    {
-                        drv_cnt     = incr_drv_cnt(drv_cnt);
-                        sig_bus.mod = get_cur_frame_mod(drv_cnt);
-                        sig_bus.dat = get_cur_frame_dat(drv_cnt);
-
-                        if (drv_cnt >= this->cur_frm->byte_last)
-                        {
-                            sig_bus.eof = true;
-                            sig_bus.val = true;
-                            drv_state   = state_req;
-                        }
-                        else
-                        {
-                            sig_bus.val = true;
-                            drv_state   = state_pen;
-                        }
-
-                        if (false)
-                        {
-                            this->msg->report_inf
-                            (
-                                "SyscFCBus::drive() state_pen drv_cnt cur_byte_req cur_byte_last:"
-                                + SP + to_string(drv_cnt)
-                                + SP + to_string(this->cur_frm->byte_req)
-                                + SP + to_string(this->cur_frm->byte_last)
-                            );
-                        }
-
-                        break;
-                    }
-                    default:
-                    {
-                        this->msg->report_inf("FSM in default case");
-                        throw "Bus instance" + SP + this->msg->get_str_c_msgid() + SP + "drive() FSM in default case";
-                        break;
-                    }
-                }
-
-                this->bus_o = sig_bus;
-                this->cnt_o = sig_cnt;
-                this->req_o = sig_req;
-                this->drv_s = drv_state;
-                this->drv_c = drv_cnt;
-
-                if (cur_frm != nullptr) { this->drv_lc = this->cur_frm->byte_cnt; }
-                if (nxt_frm != nullptr) { this->drv_ln = this->nxt_frm->byte_cnt; }
+                if (this->eng.get_cur_len() != 0) { this->drv_lc = this->eng.get_cur_len(); }
+                if (this->eng.get_nxt_len() != 0) { this->drv_ln = this->eng.get_nxt_len(); }
             }
         }
+
+        #ifndef SYSCFCBUS_HDR_ONLY
+            extern template class Bus_src<0>;
+            extern template class Bus_src<1>;
+            extern template class Bus_src<2>;
+            extern template class Bus_src<3>;
+            extern template class Bus_src<4>;
+            extern template class Bus_src<5>;
+            extern template class Bus_src<6>;
+            extern template class Bus_src<7>;
+            extern template class Bus_src<8>;
+        #endif
     }
 #endif
@@ -0,0 +1,196 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file  SyscFCBusArray.h
+ *  \brief Declares the Frm_store, Frm_cursor and Bus_src_array classes.
+ *
+ *  Bus_src_array drives many buses from one process, with every port
+ *  reading the frames of one source through a shared Frm_store.
+ */
+
+#ifndef _SYSCFCBUSARRAY_H_
+    #define _SYSCFCBUSARRAY_H_
+
+    #include <memory>
+    #include <unordered_map>
+    #include <SyscFCBusCore.h>
+
+    namespace SyscFCBus
+    {
+        /** \class  Frm_store
+         *  \brief  Frames of one source shared by several readers
+         *
+         *  Frames are taken from the source once, in order, and held until
+         *  trim() says no reader needs them.  A frame with the same bytes as
+         *  one still held shares it's buffer rather than being copied again.
+         */
+
+        class Frm_store
+        {
+            private:
+                typedef struct struct_entry
+                {
+                    shared_ptr<const vector<uint8_t>> buf;
+                    uint64_t                          hash;
+                } entry;
+
+                unique_ptr<SyscMsg::Msg>                                   msg;
+                Frm_src                                                  * src;
+                deque<entry>                                               frames;
+                uint64_t                                                   base;
+                unordered_map<uint64_t, weak_ptr<const vector<uint8_t>>>   live;
+                uint64_t                                                   dup_cnt;
+                bool                                                       exhausted;
+
+            public:
+                Frm_store(const string &, Frm_src*);
+                ~Frm_store(void);
+
+                bool     get(uint64_t, const uint8_t *&, unsigned &);
+                void     trim(uint64_t);
+                uint64_t get_held(void);
+                uint64_t get_dup_cnt(void);
+        };
+
+        /** \class  Frm_cursor
+         *  \brief  One reader's position in a Frm_store
+         *
+         *  Returns the frames of the store in order.  Frames remain valid
+         *  until the store is trimmed past them; Bus_src_array trims to two
+         *  frames behind the slowest cursor, per the Frm_src validity rule.
+         */
+
+        class Frm_cursor : public Frm_src
+        {
+            private:
+                Frm_store * store;
+                uint64_t    pos;
+
+            public:
+                Frm_cursor(Frm_store*);
+                ~Frm_cursor(void);
+
+                bool     get_frame(const uint8_t *&, unsigned &);
+                uint64_t get_pos(void);
+        };
+
+        /** \class  Bus_src_array
+         *  \brief  N frame sources driven from one process
+         *
+         *  Each port has a Bus_src_eng reading through it's own Frm_cursor, so
+         *  every port sends the frames of the shared source in order, each at
+         *  it's own pace.  One method process steps all ports in a loop on the
+         *  rising clock edge, with the same dav, ack, req and cnt signals per
+         *  port as Bus_src, the outputs starting at the idle values of the
+         *  engines.  The store holds the frames between the slowest and the
+         *  fastest port.
+         */
+
+        template <unsigned T_be, unsigned N>
+        class Bus_src_array : public sc_module
+        {
+            private:
+                unique_ptr<SyscMsg::Msg>                 msg;
+                Frm_store                                store;
+                vector<unique_ptr<Frm_cursor>>           cursor;
+                vector<unique_ptr<Bus_src_eng<T_be>>>    eng;
+
+            public:
+                SC_HAS_PROCESS(Bus_src_array);
+                Bus_src_array(sc_module_name, Frm_src*);
+                ~Bus_src_array(void);
+
+                sc_core::sc_out <Bus<T_be>> bus_o[N];
+                sc_core::sc_in  <bool>      dav_i[N];
+                sc_core::sc_out <uint32_t>  cnt_o[N];
+                sc_core::sc_out <bool>      req_o[N];
+                sc_core::sc_in  <bool>      ack_i[N];
+                sc_core::sc_in  <bool>      clk_i;
+
+                void               drive(void);
+                Bus_src_eng<T_be>& get_eng(unsigned);
+                Frm_store&         get_store(void);
+        };
+
+        template <unsigned T_be, unsigned N>
+        Bus_src_array<T_be, N>::Bus_src_array(sc_module_name arg_nm, Frm_src * arg_src)
+            : store(string(arg_nm) + ".store", arg_src)
+        {
+            this->msg = unique_ptr<SyscMsg::Msg>(new SyscMsg::Msg(this->name()));
+
+            for (unsigned i = 0 ; i < N ; i++)
+            {
+                this->cursor.emplace_back(new Frm_cursor(&this->store));
+                this->eng.emplace_back(new Bus_src_eng<T_be>(string(this->name()) + ".eng" + to_string(i)));
+                this->eng[i]->set_frm_src(this->cursor[i].get());
+
+                this->bus_o[i].initialize(this->eng[i]->get_bus());
+                this->cnt_o[i].initialize(this->eng[i]->get_cnt());
+                this->req_o[i].initialize(this->eng[i]->get_req());
+            }
+
+            SC_METHOD(drive);
+            sensitive << this->clk_i.pos();
+            dont_initialize();
+        }
+
+        template <unsigned T_be, unsigned N>
+        Bus_src_array<T_be, N>::~Bus_src_array(void) { }
+
+        template <unsigned T_be, unsigned N>
+        void Bus_src_array<T_be, N>::drive(void)
+        {
+            uint64_t low = UINT64_MAX;
+
+            for (unsigned i = 0 ; i < N ; i++)
+            {
+                Bus_src_eng<T_be> & e = *this->eng[i];
+
+                if (this->dav_i[i].read())
+                {
+                    this->bus_o[i] = e.step(true, this->ack_i[i].read());
+                    this->cnt_o[i] = e.get_cnt();
+                    this->req_o[i] = e.get_req();
+                }
+
+                if (this->cursor[i]->get_pos() < low)
+                {
+                    low = this->cursor[i]->get_pos();
+                }
+            }
+
+            if (low >= 2)
+            {
+                this->store.trim(low - 2);
+            }
+        }
+
+        template <unsigned T_be, unsigned N>
+        Bus_src_eng<T_be> & Bus_src_array<T_be, N>::get_eng(unsigned arg_idx)
+        {
+            return *this->eng[arg_idx];
+        }
+
+        template <unsigned T_be, unsigned N>
+        Frm_store & Bus_src_array<T_be, N>::get_store(void)
+        {
+            return this->store;
+        }
+    }
+#endif
@@ -0,0 +1,281 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/** \file  SyscFCBusAssert.h
+ *  \brief Declares the Bus_rules and Bus_assert classes.
+ *
+ *  Bus_rules checks the framing rules of a Bus beat by beat with a state
+ *  machine held in a table, and Bus_assert applies it to a Bus signal.
+ */
+
+#ifndef _SYSCFCBUSASSERT_H_
+    #define _SYSCFCBUSASSERT_H_
+
+    #include <SyscFCBusCore.h>
+
+    namespace SyscFCBus
+    {
+        /** \enum  enum_bus_rule
+         *  \brief Framing rules checked by Bus_rules, rule_ok when none is
+         *  broken
+         */
+
+        enum enum_bus_rule
+        {
+            rule_ok,
+            rule_sof_in_frm,
+            rule_beat_out_frm,
+            rule_err_dropped,
+            rule_mod_not_eof,
+            rule_gap_in_frm,
+            rule_LAST
+        };
+
+        /** \enum  enum_bus_ctl
+         *  \brief Bits of the packed control word given to Bus_rules::step()
+         */
+
+        enum enum_bus_ctl
+        {
+            ctl_val = 0x01,
+            ctl_sof = 0x02,
+            ctl_eof = 0x04,
+            ctl_err = 0x08,
+            ctl_mod = 0x10,
+            ctl_LAST = 0x20
+        };
+
+        const char * bus_rule_str(enum_bus_rule);
+
+        /** \class  Bus_rules
+         *  \brief  Table-driven checker of the framing rules of a Bus
+         *
+         *  step() takes the control word of each beat accepted from the bus,
+         *  packed by bus_ctl(), and returns the rule it breaks, if any.  The
+         *  state is outside a frame, within a frame, or within a frame after
+         *  err; one table lookup gives both the next state and the rule, so a
+         *  beat costs the same whatever the rules.  The rules are that sof
+         *  only starts a frame, that a beat with val outside a frame has sof,
+         *  that err once asserted stays asserted to eof, that mod is non-zero
+         *  only with eof unless arg_part, and that val is not low within a
+         *  frame unless arg_gap.  The table is built once by the constructor.
+         */
+
+        class Bus_rules
+        {
+            private:
+                uint8_t tab[3][ctl_LAST];
+                uint8_t state;
+
+            public:
+                Bus_rules(bool, bool);
+                ~Bus_rules(void);
+
+                enum_bus_rule step(unsigned arg_ctl)
+                {
+                    uint8_t ent = this->tab[this->state][arg_ctl];
+
+                    this->state = ent & 0x3;
+
+                    return static_cast<enum_bus_rule>(ent >> 2);
+                }
+
+                bool get_in_frm(void);
+        };
+
+        /** \fn    bus_ctl()
+         *  \brief Packs the control fields of a Bus into the word given to
+         *  Bus_rules::step()
+         */
+
+        template <unsigned T_be>
+        unsigned bus_ctl(const Bus<T_be> & arg)
+        {
+            unsigned ret = 0;
+
+            ret = ret | (arg.val ? ctl_val : 0);
+            ret = ret | (arg.sof ? ctl_sof : 0);
+            ret = ret | (arg.eof ? ctl_eof : 0);
+            ret = ret | (arg.err ? ctl_err : 0);
+
+            if (T_be > 0)
+            {
+                ret = ret | ((mod_get_uint<T_be>(arg.mod) != 0) ? ctl_mod : 0);
+            }
+
+            return ret;
+        }
+
+        /** \class  Bus_assert
+         *  \brief  Passive monitor of the framing rules of a Bus
+         *
+         *  Samples bus_i and dav_i on the falling clock edge, as Bus_mon does,
+         *  and steps a Bus_rules on each beat with dav.  The first broken rule
+         *  is reported with it's clock cycle and simulation time; later ones
+         *  are only counted, by rule, for report().  get_pass() is false once
+         *  a rule is broken.  set_expect() names one rule whose violations
+         *  are expected, as rule_sof_in_frm after each dropped eof when errors
+         *  are injected; those are counted apart from the violations and do
+         *  not fail get_pass(), and the caller checks their count against
+         *  the errors it injected with get_rule_cnt().
+         */
+
+        template <unsigned T_be>
+        class Bus_assert : public sc_module
+        {
+            private:
+                unique_ptr<SyscMsg::Msg> msg;
+                Bus_rules                rules;
+                uint64_t                 cyc_cnt;
+                uint64_t                 viol_cnt;
+                uint64_t                 rule_cnt[rule_LAST];
+                enum_bus_rule            expect;
+
+            public:
+                SC_HAS_PROCESS(Bus_assert);
+                Bus_assert(sc_module_name, bool, bool);
+                ~Bus_assert(void);
+
+                sc_core::sc_in  <Bus<T_be>> bus_i;
+                sc_core::sc_in  <bool>      dav_i;
+                sc_core::sc_in  <bool>      clk_i;
+
+                void     check(void);
+                void     set_expect(enum_bus_rule);
+                uint64_t get_viol_cnt(void);
+                uint64_t get_rule_cnt(enum_bus_rule);
+                bool     get_pass(void);
+                void     report(void);
+        };
+
+        template <unsigned T_be>
+        Bus_assert<T_be>::Bus_assert(sc_module_name arg_nm, bool arg_gap, bool arg_part)
+            : rules(arg_gap, arg_part)
+        {
+            this->msg      = unique_ptr<SyscMsg::Msg>(new SyscMsg::Msg(this->name()));
+            this->cyc_cnt  = 0;
+            this->viol_cnt = 0;
+            this->expect   = rule_ok;
+
+            for (unsigned i = 0 ; i < rule_LAST ; i++)
+            {
+                this->rule_cnt[i] = 0;
+            }
+
+            SC_METHOD(check);
+            sensitive << this->clk_i.neg();
+            dont_initialize();
+        }
+
+        template <unsigned T_be>
+        Bus_assert<T_be>::~Bus_assert(void) { }
+
+        template <unsigned T_be>
+        void Bus_assert<T_be>::check(void)
+        {
+            enum_bus_rule rule = rule_ok;
+
+            this->cyc_cnt = this->cyc_cnt + 1;
+
+            if (!this->dav_i.read())
+            {
+                return;
+            }
+
+            rule = this->rules.step(bus_ctl<T_be>(this->bus_i.read()));
+
+            if (rule == rule_ok)
+            {
+                return;
+            }
+
+            this->rule_cnt[rule] = this->rule_cnt[rule] + 1;
+
+            if (rule == this->expect)
+            {
+                return;
+            }
+
+            if (this->viol_cnt == 0)
+            {
+                string SP = SyscMsg::Chars::SP;
+
+                this->msg->report_inf
+                (
+                    "first violation," + SP + bus_rule_str(rule)
+                    + ", at cycle" + SP + to_string(this->cyc_cnt)
+                    + ", time" + SP + sc_time_stamp().to_string()
+                );
+            }
+
+            this->viol_cnt = this->viol_cnt + 1;
+        }
+
+        template <unsigned T_be>
+        void Bus_assert<T_be>::set_expect(enum_bus_rule arg)
+        {
+            this->expect = arg;
+        }
+
+        template <unsigned T_be>
+        uint64_t Bus_assert<T_be>::get_viol_cnt(void)
+        {
+            return this->viol_cnt;
+        }
+
+        template <unsigned T_be>
+        uint64_t Bus_assert<T_be>::get_rule_cnt(enum_bus_rule arg_rule)
+        {
+            return this->rule_cnt[arg_rule];
+        }
+
+        template <unsigned T_be>
+        bool Bus_assert<T_be>::get_pass(void)
+        {
+            return (this->viol_cnt == 0);
+        }
+
+        template <unsigned T_be>
+        void Bus_assert<T_be>::report(void)
+        {
+            string SP = SyscMsg::Chars::SP;
+
+            this->msg->report_inf
+            (
+                "clocks" + SP + to_string(this->cyc_cnt)
+                + ", violations" + SP + to_string(this->viol_cnt)
+            );
+
+            for (unsigned i = rule_ok + 1 ; i < rule_LAST ; i++)
+            {
+                if (this->rule_cnt[i] == 0)
+                {
+                    continue;
+                }
+
+                this->msg->report_inf
+                (
+                    string(bus_rule_str(static_cast<enum_bus_rule>(i))) + SP + to_string(this->rule_cnt[i])
+                    + ((i == this->expect) ? ", expected" : "")
+                );
+            }
+        }
+    }
+#endif
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file  SyscFCBusCache.h
+ *  \brief Declares the Frm_cache class.
+ *
+ *  Frm_cache records the frames a Frm_src produces to a binary file, and
+ *  later replays them from a memory mapping of that file without the
+ *  original source.
+ */
+
+#ifndef _SYSCFCBUSCACHE_H_
+    #define _SYSCFCBUSCACHE_H_
+
+    #include <cstdio>
+    #include <SyscFCBusCore.h>
+
+    namespace SyscFCBus
+    {
+        /** \class  Frm_cache
+         *  \brief  Record and replay cache of frames
+         *
+         *  The cache file is named from a hash of the driver handler name and
+         *  request string, and the file header repeats both, so a change in
+         *  either selects a different file and never replays stale frames.
+         *
+         *  The file is a header followed by one record per frame, each a 32-bit
+         *  byte count and the frame bytes.  The header frame count is written
+         *  when recording completes, so an interrupted recording is never
+         *  replayed.  A replay holds only the frames of the recorded run, so
+         *  open_replay() takes the frame count needed and refuses a file that
+         *  holds fewer.
+         *
+         *  In record mode get_frame() forwards to the recorded source and appends
+         *  the frame to the file.  In replay mode get_frame() returns pointers
+         *  into the mapped file.
+         */
+
+        class Frm_cache : public Frm_src
+        {
+            private:
+                typedef struct struct_cache_hdr
+                {
+                    char     magic[8];
+                    uint32_t version;
+                    uint32_t key_len;
+                    uint64_t frm_cnt;
+                } cache_hdr;
+
+                enum enum_cache_mode
+                {
+                    cache_off,
+                    cache_record,
+                    cache_replay
+                };
+
+                unique_ptr<SyscMsg::Msg> msg;
+                string                   key;
+                string                   path;
+                string                   tmp_path;
+                enum_cache_mode          mode;
+                Frm_src                * src;
+                FILE                   * fp;
+                const uint8_t          * map;
+                size_t                   map_len;
+                size_t                   map_pos;
+                uint64_t                 frm_cnt;
+
+            public:
+                Frm_cache(const string &, const string &, const string &, const string &);
+                ~Frm_cache(void);
+
+                bool          open_replay(uint64_t arg_min = 0);
+                void          open_record(Frm_src*);
+                void          close(void);
+                bool          get_frame(const uint8_t *&, unsigned &);
+                uint64_t      get_frm_cnt(void);
+                const string& get_path(void);
+        };
+    }
+#endif
@@ -0,0 +1,507 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file  SyscFCBusCell.h
+ *  \brief Declares the Cell_sched, Cell_eng, Bus_cell_src, Cell_chk and
+ *  Bus_cell_chk classes.
+ *
+ *  These drive and check ATM cells, each carrying the
+ *  {usr[3:0], vpi[11:0], vci[15:0]} of it's virtual circuit in Bus.usr,
+ *  where usr[3:0] is the {pt[2:0], clp} of the header.
+ */
+
+#ifndef _SYSCFCBUSCELL_H_
+    #define _SYSCFCBUSCELL_H_
+
+    #include <unordered_map>
+    #include <SyscFCBusCore.h>
+
+    namespace SyscFCBus
+    {
+        uint8_t  cell_hec(const uint8_t *);
+        uint32_t cell_usr(const uint8_t *);
+        void     cell_hdr(uint32_t, uint8_t *);
+        void     cell_pay(uint32_t, uint32_t, uint8_t *);
+
+        /** \class  Cell_sched
+         *  \brief  Calendar wheel choosing the virtual circuit of each cell
+         *
+         *  Each circuit added with add_vc() sends one cell every period cell
+         *  times.  The wheel has a slot per cell time, holding a list of the
+         *  circuits due then.  next() moves the current slot's list to the
+         *  end of a ready list and takes the head of the ready list, so the
+         *  cost per cell does not depend on the number of circuits, up to the
+         *  65536 allowed.  When several circuits fall due in one slot, the
+         *  later ones are sent in the following cell times and keep their
+         *  schedule, so their long run rates are held.
+         */
+
+        class Cell_sched
+        {
+            private:
+                typedef struct struct_vc
+                {
+                    uint32_t usr;
+                    uint8_t  hdr[5];
+                    unsigned period;
+                    uint64_t due;
+                    uint32_t seq;
+                    int32_t  nxt;
+                } vc;
+
+                unique_ptr<SyscMsg::Msg>   msg;
+                vector<vc>                 vcs;
+                vector<int32_t>            slot_head;
+                vector<int32_t>            slot_tail;
+                int32_t                    rdy_head;
+                int32_t                    rdy_tail;
+                uint64_t                   mask;
+                uint64_t                   now;
+
+                void slot_put(unsigned, uint64_t);
+
+            public:
+                static constexpr unsigned vc_max = 65536;
+
+                Cell_sched(const string &, unsigned);
+                ~Cell_sched(void);
+
+                unsigned        add_vc(uint32_t, unsigned, unsigned);
+                bool            next(unsigned &);
+                uint32_t        get_usr(unsigned);
+                const uint8_t * get_hdr(unsigned);
+                uint32_t        take_seq(unsigned);
+                uint32_t        get_seq(unsigned);
+                unsigned        get_vc_cnt(void);
+        };
+
+        /** \class  Cell_eng
+         *  \brief  Cell source state, stepped once per clock
+         *
+         *  Drives one cell, or one idle cell time, every beats() clocks, with
+         *  the circuit chosen by a Cell_sched.  A cell is the five byte header
+         *  followed by 48 payload bytes, or only the payload when the header
+         *  is left out, and the payload starts with the circuit's sequence
+         *  number.  The offset, byte count and mod of each beat are fixed by
+         *  the cell length and T_be, so they are computed once.
+         */
+
+        template <unsigned T_be>
+        class Cell_eng
+        {
+            private:
+                unique_ptr<SyscMsg::Msg>   msg;
+                Cell_sched               * sched;
+                unsigned                   cell_len;
+                vector<unsigned>           beat_off;
+                vector<unsigned>           beat_cnt;
+                vector<Mod<T_be>>          beat_mod;
+                uint8_t                    cell[53];
+                unsigned                   beat;
+                bool                       busy;
+                Bus<T_be>                  sig_bus;
+                uint64_t                   cell_cnt;
+                uint64_t                   idle_cnt;
+
+            public:
+                Cell_eng(const string &, Cell_sched*, bool);
+                ~Cell_eng(void);
+
+                const Bus<T_be>& step(bool);
+                const Bus<T_be>& get_bus(void);
+                unsigned         beats(void);
+                uint64_t         get_cell_cnt(void);
+                uint64_t         get_idle_cnt(void);
+        };
+
+        template <unsigned T_be>
+        Cell_eng<T_be>::Cell_eng(const string & arg_nm, Cell_sched * arg_sched, bool arg_hdr)
+        {
+            unsigned bytes = (1 << T_be);
+
+            this->msg      = unique_ptr<SyscMsg::Msg>(new SyscMsg::Msg(arg_nm));
+            this->sched    = arg_sched;
+            this->cell_len = arg_hdr ? 53 : 48;
+            this->beat     = 0;
+            this->busy     = false;
+            this->sig_bus  = bus_rst<T_be>();
+            this->cell_cnt = 0;
+            this->idle_cnt = 0;
+
+            for (unsigned off = 0 ; off < this->cell_len ; off = off + bytes)
+            {
+                unsigned  cnt = ((this->cell_len - off) < bytes) ? (this->cell_len - off) : bytes;
+                Mod<T_be> mod = mod_rst<T_be>();
+
+                if ((T_be != 0U) && (cnt < bytes))
+                {
+                    mod = mod_set<T_be>(cnt);
+                }
+
+                this->beat_off.push_back(off);
+                this->beat_cnt.push_back(cnt);
+                this->beat_mod.push_back(mod);
+            }
+        }
+
+        template <unsigned T_be>
+        Cell_eng<T_be>::~Cell_eng(void) { }
+
+        template <unsigned T_be>
+        unsigned Cell_eng<T_be>::beats(void)
+        {
+            return this->beat_off.size();
+        }
+
+        template <unsigned T_be>
+        const Bus<T_be> & Cell_eng<T_be>::get_bus(void)
+        {
+            return this->sig_bus;
+        }
+
+        template <unsigned T_be>
+        uint64_t Cell_eng<T_be>::get_cell_cnt(void)
+        {
+            return this->cell_cnt;
+        }
+
+        template <unsigned T_be>
+        uint64_t Cell_eng<T_be>::get_idle_cnt(void)
+        {
+            return this->idle_cnt;
+        }
+
+        /** \fn    Cell_eng::step()
+         *  \brief Advances by one clock; when arg_dav is false the outputs are
+         *  held and nothing advances
+         */
+
+        template <unsigned T_be>
+        const Bus<T_be> & Cell_eng<T_be>::step(bool arg_dav)
+        {
+            if (!arg_dav)
+            {
+                return this->sig_bus;
+            }
+
+            if (this->beat == 0)
+            {
+                unsigned vc  = 0;
+                uint8_t* pay = this->cell + (this->cell_len - 48);
+
+                this->busy = this->sched->next(vc);
+
+                if (this->busy)
+                {
+                    if (this->cell_len == 53)
+                    {
+                        memcpy(this->cell, this->sched->get_hdr(vc), 5);
+                    }
+
+                    cell_pay(this->sched->get_usr(vc), this->sched->take_seq(vc), pay);
+
+                    this->sig_bus.usr = this->sched->get_usr(vc);
+                    this->cell_cnt    = this->cell_cnt + 1;
+                }
+                else
+                {
+                    this->idle_cnt    = this->idle_cnt + 1;
+                }
+            }
+
+            if (this->busy)
+            {
+                this->sig_bus.val = true;
+                this->sig_bus.sof = (this->beat == 0);
+                this->sig_bus.eof = ((this->beat + 1) == this->beats());
+                this->sig_bus.mod = this->beat_mod[this->beat];
+                this->sig_bus.dat = dat_from_bytes<T_be>(this->cell + this->beat_off[this->beat], this->beat_cnt[this->beat]);
+            }
+            else
+            {
+                this->sig_bus.val = false;
+                this->sig_bus.sof = false;
+                this->sig_bus.eof = false;
+            }
+
+            this->beat = ((this->beat + 1) == this->beats()) ? 0 : (this->beat + 1);
+
+            return this->sig_bus;
+        }
+
+        /** \class  Bus_cell_src
+         *  \brief  Cell source for datapath
+         *
+         *  The drive_cell() counterpart of Bus_src, stepping a Cell_eng on the
+         *  rising clock edge.  Cells are sent at the rates of the Cell_sched,
+         *  so there is no request and acknowledge.
+         */
+
+        template <unsigned T_be>
+        class Bus_cell_src : public sc_module
+        {
+            private:
+                unique_ptr<SyscMsg::Msg>   msg;
+                Cell_eng<T_be>             eng;
+
+            public:
+                SC_HAS_PROCESS(Bus_cell_src);
+                Bus_cell_src(sc_module_name, Cell_sched*, bool);
+                ~Bus_cell_src(void);
+
+                sc_core::sc_out <Bus<T_be>> bus_o;
+                sc_core::sc_in  <bool>      dav_i;
+                sc_core::sc_in  <bool>      clk_i;
+
+                void            drive_cell(void);
+                Cell_eng<T_be>& get_eng(void);
+        };
+
+        template <unsigned T_be>
+        Bus_cell_src<T_be>::Bus_cell_src(sc_module_name arg_nm, Cell_sched * arg_sched, bool arg_hdr)
+            : eng(string(arg_nm) + ".eng", arg_sched, arg_hdr)
+        {
+            this->msg = unique_ptr<SyscMsg::Msg>(new SyscMsg::Msg(this->name()));
+
+            SC_METHOD(drive_cell);
+            sensitive << this->clk_i.pos();
+            dont_initialize();
+        }
+
+        template <unsigned T_be>
+        Bus_cell_src<T_be>::~Bus_cell_src(void) { }
+
+        template <unsigned T_be>
+        void Bus_cell_src<T_be>::drive_cell(void)
+        {
+            if (this->dav_i.read())
+            {
+                this->bus_o = this->eng.step(true);
+            }
+        }
+
+        template <unsigned T_be>
+        Cell_eng<T_be> & Bus_cell_src<T_be>::get_eng(void)
+        {
+            return this->eng;
+        }
+
+        /** \class  Cell_chk
+         *  \brief  Checks cells beat by beat
+         *
+         *  put() takes each beat accepted from the bus.  Each cell is checked
+         *  for it's length, for a header matching Bus.usr and a good HEC when
+         *  the header is carried, and for the payload of the next sequence
+         *  number of it's circuit.
+         */
+
+        template <unsigned T_be>
+        class Cell_chk
+        {
+            private:
+                unique_ptr<SyscMsg::Msg>             msg;
+                unsigned                             cell_len;
+                uint8_t                              cell[64];
+                unsigned                             cnt;
+                uint32_t                             usr;
+                unordered_map<uint32_t, uint32_t>    seq;
+                uint64_t                             cell_cnt;
+                uint64_t                             err_cnt;
+
+                void check(void);
+
+            public:
+                Cell_chk(const string &, bool);
+                ~Cell_chk(void);
+
+                void     put(const Bus<T_be> &);
+                uint64_t get_cell_cnt(void);
+                uint64_t get_err_cnt(void);
+                unsigned get_vc_cnt(void);
+        };
+
+        template <unsigned T_be>
+        Cell_chk<T_be>::Cell_chk(const string & arg_nm, bool arg_hdr)
+        {
+            this->msg      = unique_ptr<SyscMsg::Msg>(new SyscMsg::Msg(arg_nm));
+            this->cell_len = arg_hdr ? 53 : 48;
+            this->cnt      = 0;
+            this->usr      = 0;
+            this->cell_cnt = 0;
+            this->err_cnt  = 0;
+        }
+
+        template <unsigned T_be>
+        Cell_chk<T_be>::~Cell_chk(void) { }
+
+        template <unsigned T_be>
+        void Cell_chk<T_be>::put(const Bus<T_be> & arg_bus)
+        {
+            unsigned cnt = bus_get_byte_cnt<T_be>(arg_bus);
+            uint8_t  tmp[1 << T_be];
+            string   SP  = SyscMsg::Chars::SP;
+
+            if (!arg_bus.val)
+            {
+                return;
+            }
+
+            if (arg_bus.sof)
+            {
+                if (this->cnt != 0)
+                {
+                    this->msg->cerr_err("cell started before eof of previous cell");
+                    this->err_cnt = this->err_cnt + 1;
+                }
+
+                this->cnt = 0;
+                this->usr = arg_bus.usr;
+            }
+
+            dat_to_bytes<T_be>(arg_bus.dat, tmp);
+
+            if ((this->cnt + cnt) > this->cell_len)
+            {
+                this->msg->cerr_err("cell longer than" + SP + to_string(this->cell_len) + SP + "bytes");
+                this->err_cnt = this->err_cnt + 1;
+                cnt           = this->cell_len - this->cnt;
+            }
+
+            memcpy(this->cell + this->cnt, tmp, cnt);
+            this->cnt = this->cnt + cnt;
+
+            if (arg_bus.eof)
+            {
+                this->check();
+                this->cnt = 0;
+            }
+        }
+
+        template <unsigned T_be>
+        void Cell_chk<T_be>::check(void)
+        {
+            uint8_t  pay[48];
+            uint32_t key = this->usr & 0x0FFFFFFF;
+            uint32_t exp = 0;
+            string   SP  = SyscMsg::Chars::SP;
+            bool     ok  = (this->cnt == this->cell_len);
+
+            this->cell_cnt = this->cell_cnt + 1;
+
+            if (ok && (this->cell_len == 53))
+            {
+                ok = (cell_usr(this->cell) == this->usr) && (cell_hec(this->cell) == this->cell[4]);
+            }
+
+            auto it = this->seq.find(key);
+
+            if (it != this->seq.end())
+            {
+                exp = it->second;
+            }
+
+            cell_pay(this->usr, exp, pay);
+
+            if (ok && (memcmp(this->cell + (this->cell_len - 48), pay, 48) != 0))
+            {
+                ok = false;
+            }
+
+            if (!ok)
+            {
+                ostringstream os;
+
+                os << hex << this->usr;
+                this->msg->cerr_err("bad cell for usr" + SP + os.str() + SP + "expecting sequence" + SP + to_string(exp));
+                this->err_cnt = this->err_cnt + 1;
+            }
+
+            this->seq[key] = exp + 1;
+        }
+
+        template <unsigned T_be>
+        uint64_t Cell_chk<T_be>::get_cell_cnt(void)
+        {
+            return this->cell_cnt;
+        }
+
+        template <unsigned T_be>
+        uint64_t Cell_chk<T_be>::get_err_cnt(void)
+        {
+            return this->err_cnt;
+        }
+
+        template <unsigned T_be>
+        unsigned Cell_chk<T_be>::get_vc_cnt(void)
+        {
+            return this->seq.size();
+        }
+
+        /** \class  Bus_cell_chk
+         *  \brief  Cell checker for datapath, passing the beats accepted on
+         *  each rising clock edge to a Cell_chk
+         */
+
+        template <unsigned T_be>
+        class Bus_cell_chk : public sc_module
+        {
+            private:
+                Cell_chk<T_be>             chk;
+
+            public:
+                SC_HAS_PROCESS(Bus_cell_chk);
+                Bus_cell_chk(sc_module_name, bool);
+                ~Bus_cell_chk(void);
+
+                sc_core::sc_in  <Bus<T_be>> bus_i;
+                sc_core::sc_in  <bool>      dav_i;
+                sc_core::sc_in  <bool>      clk_i;
+
+                void            check(void);
+                Cell_chk<T_be>& get_chk(void);
+        };
+
+        template <unsigned T_be>
+        Bus_cell_chk<T_be>::Bus_cell_chk(sc_module_name arg_nm, bool arg_hdr)
+            : chk(string(arg_nm), arg_hdr)
+        {
+            SC_METHOD(check);
+            sensitive << this->clk_i.pos();
+            dont_initialize();
+        }
+
+        template <unsigned T_be>
+        Bus_cell_chk<T_be>::~Bus_cell_chk(void) { }
+
+        template <unsigned T_be>
+        void Bus_cell_chk<T_be>::check(void)
+        {
+            if (this->dav_i.read())
+            {
+                this->chk.put(this->bus_i.read());
+            }
+        }
+
+        template <unsigned T_be>
+        Cell_chk<T_be> & Bus_cell_chk<T_be>::get_chk(void)
+        {
+            return this->chk;
+        }
+    }
+#endif
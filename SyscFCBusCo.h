@@ -0,0 +1,361 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file  SyscFCBusCo.h
+ *  \brief Declares the coroutine traffic scripting classes.
+ *
+ *  A traffic script is a C++20 coroutine returning Bus_co<T_be> that
+ *  yields frames, idle beats or single beats:
+ *
+ *      Bus_co<3> script(void)
+ *      {
+ *          vector<uint8_t> buf(64, 0x55);
+ *
+ *          co_yield frame(buf);
+ *          co_yield idle(4);
+ *          co_yield beat(b);
+ *      }
+ *
+ *  Co_drv steps a script once per clock.  The coroutine frame is allocated
+ *  once, when the script is called; yielding and stepping allocate
+ *  nothing, and no thread stack is needed per script.  The contents of this
+ *  file are only compiled when the compiler supports coroutines.
+ */
+
+#ifndef _SYSCFCBUSCO_H_
+    #define _SYSCFCBUSCO_H_
+
+    #include <SyscFCBusCore.h>
+
+    #if defined(__cpp_impl_coroutine) && (__cpp_impl_coroutine >= 201902L)
+        #include <coroutine>
+
+        namespace SyscFCBus
+        {
+            /** \struct co_frame
+             *  \brief  A frame yielded by a script, driven from sof to eof
+             *
+             *  The bytes must stay valid until the script is next resumed,
+             *  which a buffer local to the script does.
+             */
+
+            struct co_frame
+            {
+                const uint8_t * dat;
+                unsigned        cnt;
+                uint32_t        usr;
+                bool            err;
+            };
+
+            /** \struct co_idle
+             *  \brief  A number of beats with val clear yielded by a script
+             */
+
+            struct co_idle
+            {
+                unsigned cnt;
+            };
+
+            /** \struct co_beat
+             *  \brief  A single beat yielded by a script, driven as given
+             */
+
+            template <unsigned T_be>
+            struct co_beat
+            {
+                Bus<T_be> bus;
+            };
+
+            inline co_frame frame(const uint8_t * arg_dat, unsigned arg_cnt, uint32_t arg_usr = 0, bool arg_err = false)
+            {
+                return {arg_dat, arg_cnt, arg_usr, arg_err};
+            }
+
+            inline co_frame frame(const vector<uint8_t> & arg_buf, uint32_t arg_usr = 0, bool arg_err = false)
+            {
+                return {arg_buf.data(), unsigned(arg_buf.size()), arg_usr, arg_err};
+            }
+
+            inline co_idle idle(unsigned arg_cnt)
+            {
+                return {arg_cnt};
+            }
+
+            template <unsigned T_be>
+            co_beat<T_be> beat(const Bus<T_be> & arg_bus)
+            {
+                return {arg_bus};
+            }
+
+            /** \class  Bus_co
+             *  \brief  Return type of a traffic script coroutine
+             *
+             *  Owns the coroutine.  next() resumes it to it's next co_yield and
+             *  returns false once it has returned.
+             */
+
+            template <unsigned T_be>
+            class Bus_co
+            {
+                public:
+                    enum enum_item
+                    {
+                        item_none,
+                        item_frame,
+                        item_idle,
+                        item_beat
+                    };
+
+                    struct promise_type
+                    {
+                        enum_item  kind;
+                        co_frame   frm;
+                        co_idle    idl;
+                        Bus<T_be>  bus;
+
+                        Bus_co get_return_object(void)
+                        {
+                            return Bus_co(std::coroutine_handle<promise_type>::from_promise(*this));
+                        }
+
+                        std::suspend_always initial_suspend(void) noexcept { return {}; }
+                        std::suspend_always final_suspend(void) noexcept   { return {}; }
+
+                        std::suspend_always yield_value(const co_frame & arg)
+                        {
+                            this->kind = item_frame;
+                            this->frm  = arg;
+                            return {};
+                        }
+
+                        std::suspend_always yield_value(const co_idle & arg)
+                        {
+                            this->kind = item_idle;
+                            this->idl  = arg;
+                            return {};
+                        }
+
+                        std::suspend_always yield_value(const co_beat<T_be> & arg)
+                        {
+                            this->kind = item_beat;
+                            this->bus  = arg.bus;
+                            return {};
+                        }
+
+                        void return_void(void) { }
+                        void unhandled_exception(void) { throw; }
+                    };
+
+                private:
+                    std::coroutine_handle<promise_type> hdl;
+
+                public:
+                    explicit Bus_co(std::coroutine_handle<promise_type> arg) : hdl(arg) { }
+                    Bus_co(Bus_co && arg) noexcept : hdl(arg.hdl) { arg.hdl = nullptr; }
+                    Bus_co(const Bus_co &) = delete;
+                    Bus_co & operator=(const Bus_co &) = delete;
+
+                    ~Bus_co(void)
+                    {
+                        if (this->hdl)
+                        {
+                            this->hdl.destroy();
+                        }
+                    }
+
+                    bool next(void)
+                    {
+                        if (!this->hdl || this->hdl.done())
+                        {
+                            return false;
+                        }
+
+                        this->hdl.promise().kind = item_none;
+                        this->hdl.resume();
+
+                        return !this->hdl.done();
+                    }
+
+                    promise_type & get(void)
+                    {
+                        return this->hdl.promise();
+                    }
+            };
+
+            /** \class  Co_drv
+             *  \brief  Steps a traffic script once per clock
+             *
+             *  step() takes the dav sampled at the clock edge and returns the
+             *  Bus to drive until the next edge, resuming the script only when
+             *  the previous item has been driven.  Frames are driven as by
+             *  Bus_src: mod is non-zero only on the eof beat, err is given on
+             *  the eof beat and usr on every beat.  Once the script returns the
+             *  bus is idle and get_done() is true.
+             */
+
+            template <unsigned T_be>
+            class Co_drv
+            {
+                private:
+                    Bus_co<T_be>   co;
+                    Bus<T_be>      sig_bus;
+                    co_frame       frm;
+                    unsigned       frm_pos;
+                    unsigned       idl_cnt;
+                    bool           done;
+
+                public:
+                    Co_drv(Bus_co<T_be> &&);
+
+                    const Bus<T_be>& step(bool);
+                    bool             get_done(void);
+            };
+
+            template <unsigned T_be>
+            Co_drv<T_be>::Co_drv(Bus_co<T_be> && arg_co) : co(std::move(arg_co))
+            {
+                this->sig_bus = bus_rst<T_be>();
+                this->frm     = {nullptr, 0, 0, false};
+                this->frm_pos = 0;
+                this->idl_cnt = 0;
+                this->done    = false;
+            }
+
+            template <unsigned T_be>
+            const Bus<T_be> & Co_drv<T_be>::step(bool arg_dav)
+            {
+                unsigned max = (1 << T_be);
+
+                if (!arg_dav)
+                {
+                    return this->sig_bus;
+                }
+
+                this->sig_bus = bus_rst<T_be>();
+
+                while (true)
+                {
+                    if (this->frm_pos < this->frm.cnt)
+                    {
+                        unsigned rem = this->frm.cnt - this->frm_pos;
+                        unsigned cnt = (rem < max) ? rem : max;
+
+                        this->sig_bus.usr = this->frm.usr;
+                        this->sig_bus.val = true;
+                        this->sig_bus.sof = (this->frm_pos == 0);
+                        this->sig_bus.eof = (rem <= max);
+                        this->sig_bus.err = this->sig_bus.eof && this->frm.err;
+                        this->sig_bus.mod = (cnt == max) ? mod_rst<T_be>() : mod_set<T_be>(cnt);
+                        this->sig_bus.dat = dat_from_bytes<T_be>(this->frm.dat + this->frm_pos, cnt);
+                        this->frm_pos     = this->frm_pos + cnt;
+
+                        return this->sig_bus;
+                    }
+
+                    if (this->idl_cnt > 0)
+                    {
+                        this->idl_cnt--;
+
+                        return this->sig_bus;
+                    }
+
+                    if (this->done || !this->co.next())
+                    {
+                        this->done = true;
+
+                        return this->sig_bus;
+                    }
+
+                    auto & prm = this->co.get();
+
+                    if (prm.kind == Bus_co<T_be>::item_frame)
+                    {
+                        this->frm     = prm.frm;
+                        this->frm_pos = 0;
+                    }
+                    else if (prm.kind == Bus_co<T_be>::item_idle)
+                    {
+                        this->idl_cnt = prm.idl.cnt;
+                    }
+                    else if (prm.kind == Bus_co<T_be>::item_beat)
+                    {
+                        this->sig_bus = prm.bus;
+
+                        return this->sig_bus;
+                    }
+                }
+            }
+
+            template <unsigned T_be>
+            bool Co_drv<T_be>::get_done(void)
+            {
+                return this->done;
+            }
+
+            /** \class  Bus_co_src
+             *  \brief  Drives a Bus from a traffic script
+             *
+             *  A method process on the rising clock edge, rather than a thread,
+             *  so many scripts can run without a stack each.
+             */
+
+            template <unsigned T_be>
+            class Bus_co_src : public sc_module
+            {
+                private:
+                    Co_drv<T_be> drv;
+
+                public:
+                    SC_HAS_PROCESS(Bus_co_src);
+                    Bus_co_src(sc_module_name, Bus_co<T_be> &&);
+                    ~Bus_co_src(void);
+
+                    sc_core::sc_out <Bus<T_be>> bus_o;
+                    sc_core::sc_in  <bool>      dav_i;
+                    sc_core::sc_in  <bool>      clk_i;
+
+                    void run(void);
+                    bool get_done(void);
+            };
+
+            template <unsigned T_be>
+            Bus_co_src<T_be>::Bus_co_src(sc_module_name arg_nm, Bus_co<T_be> && arg_co) : drv(std::move(arg_co))
+            {
+                SC_METHOD(run);
+                sensitive << this->clk_i.pos();
+                dont_initialize();
+            }
+
+            template <unsigned T_be>
+            Bus_co_src<T_be>::~Bus_co_src(void) { }
+
+            template <unsigned T_be>
+            void Bus_co_src<T_be>::run(void)
+            {
+                this->bus_o = this->drv.step(this->dav_i.read());
+            }
+
+            template <unsigned T_be>
+            bool Bus_co_src<T_be>::get_done(void)
+            {
+                return this->drv.get_done();
+            }
+        }
+    #endif
+#endif
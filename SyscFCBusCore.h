@@ -0,0 +1,2676 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file  SyscFCBusCore.h
+ *  \brief Declares the Bus structure, it's helpers, and the Bus_src_eng,
+ *  Bus_split, Bus_split_clk, Bus_merge, Bus_mon and Bus_gearbox classes.
+ *
+ *  This file holds everything in SyscFCBus that does not depend on SyscDrv
+ *  or SyscJson, so that units which only connect a Bus to a verilated model
+ *  need not include those headers.
+ *
+ *  Unless SYSCFCBUS_HDR_ONLY is defined, the instantiations for T_be 0
+ *  through 8 are declared extern and are provided by the syscfcbus library.
+ */
+
+#ifndef _SYSCFCBUSCORE_H_
+    #define _SYSCFCBUSCORE_H_
+
+    #include <iostream>
+    #include <iomanip>
+    #include <sstream>
+    #include <deque>
+    #include <type_traits>
+    #include <cstring>
+    #include <endian.h>
+    #include <systemc>
+    #include <SyscMsg.h>
+    #include <SyscFCBusLog.h>
+
+    /** \brief Namespace for the SyscFCBus templates
+     *
+     */
+
+    namespace SyscFCBus
+    {
+        using namespace std;
+
+        /** \class no_connect
+         *  \brief Value assigned to mod element for 8-bit Bus instances.
+         */
+
+        class no_connect {};
+
+        inline bool operator==(const no_connect& l, const no_connect & r)
+        {
+            return true;
+        }
+
+        inline bool operator!=(const no_connect& l, const no_connect & r)
+        {
+            return false;
+        }
+
+        inline ostream& operator<<(ostream& os, const no_connect & arg)
+        {
+            os << "null";
+            return os;
+        }
+
+        inline void sc_trace(sc_trace_file * tf, const no_connect & arg, const std::string & nm)
+        {
+            sc_trace(tf, false, nm);
+        }
+
+        /** \class Dat_wide
+         *  \brief Value of T_bits bits held in 32-bit words, for Bus.dat wider
+         *  than 512 bits
+         *
+         *  sc_dt::sc_bv keeps it's words on the heap, so every copy of a Bus
+         *  would allocate.  Dat_wide keeps them inline, with word 0 the least
+         *  significant as for sc_bv::get_word(), and offers the get_word() and
+         *  set_word() used by dat_from_bytes(), dat_to_bytes() and the
+         *  Verilator binding.  It converts to the sc_bv of SCDat for the
+         *  occasional use of sc_bv semantics, such as printing.
+         */
+
+        template <unsigned T_bits>
+        class Dat_wide
+        {
+            public:
+                static constexpr unsigned words = T_bits / 32;
+
+                uint32_t w[words];
+
+                Dat_wide(void)            { memset(this->w, 0, sizeof(this->w)); }
+                Dat_wide(uint64_t arg)    { memset(this->w, 0, sizeof(this->w)); this->w[0] = arg; this->w[1] = arg >> 32; }
+
+                uint32_t get_word(unsigned arg_idx) const          { return this->w[arg_idx]; }
+                void     set_word(unsigned arg_idx, uint32_t arg)  { this->w[arg_idx] = arg; }
+
+                Dat_wide operator~(void) const
+                {
+                    Dat_wide ret;
+
+                    for (unsigned i = 0 ; i < words ; i++)
+                    {
+                        ret.w[i] = ~this->w[i];
+                    }
+
+                    return ret;
+                }
+
+                operator sc_dt::sc_bv<T_bits>(void) const
+                {
+                    sc_dt::sc_bv<T_bits> ret;
+
+                    for (unsigned i = 0 ; i < words ; i++)
+                    {
+                        ret.set_word(i, this->w[i]);
+                    }
+
+                    return ret;
+                }
+        };
+
+        template <unsigned T_bits>
+        inline bool operator==(const Dat_wide<T_bits>& l, const Dat_wide<T_bits>& r)
+        {
+            return memcmp(l.w, r.w, sizeof(l.w)) == 0;
+        }
+
+        template <unsigned T_bits>
+        inline bool operator!=(const Dat_wide<T_bits>& l, const Dat_wide<T_bits>& r)
+        {
+            return !(l == r);
+        }
+
+        template <unsigned T_bits>
+        ostream& operator<<(ostream& os, const Dat_wide<T_bits>& arg)
+        {
+            for (unsigned i = Dat_wide<T_bits>::words ; i > 0 ; i--)
+            {
+                os << hex << setw(8) << setfill('0') << arg.w[i - 1];
+            }
+
+            return os;
+        }
+
+        /** \fn    sc_trace()
+         *  \brief Traces a Dat_wide as it's 32-bit words, nm(0) the least
+         *  significant
+         */
+
+        template <unsigned T_bits>
+        void sc_trace(sc_trace_file * tf, const Dat_wide<T_bits> & arg, const std::string & nm)
+        {
+            for (unsigned i = 0 ; i < Dat_wide<T_bits>::words ; i++)
+            {
+                sc_trace(tf, arg.w[i], nm + "(" + to_string(i) + ")");
+            }
+        }
+
+        /** \struct typ_mod
+         *  \brief Type definition for Bus.mod
+         */
+
+        template <unsigned T_be> struct typ_mod     { using typ = uint32_t;   };
+        template <>              struct typ_mod<1U> { using typ = bool;       };
+        template <>              struct typ_mod<0U> { using typ = no_connect; };
+
+        /** \struct typ_dat
+         *  \brief Type definition for Bus.dat
+         */
+
+        template <unsigned T_be> struct typ_dat     { using typ = uint32_t;          };
+        template <>              struct typ_dat<3U> { using typ = uint64_t;          };
+        template <>              struct typ_dat<4U> { using typ = sc_dt::sc_bv<128>; };
+        template <>              struct typ_dat<5U> { using typ = sc_dt::sc_bv<256>; };
+        template <>              struct typ_dat<6U> { using typ = sc_dt::sc_bv<512>; };
+        template <>              struct typ_dat<7U> { using typ = Dat_wide<1024>;    };
+        template <>              struct typ_dat<8U> { using typ = Dat_wide<2048>;    };
+
+        /** \struct typ_scdat
+         *  \brief  Type definition for manipulating Bus.dat using sc_dt::sc_uint or sc_dt::sc_bv semantics
+         */
+
+        template <unsigned T_be> struct typ_scdat     { using typ = sc_dt::sc_uint<32>; };
+        template <>              struct typ_scdat<3U> { using typ = sc_dt::sc_uint<64>; };
+        template <>              struct typ_scdat<4U> { using typ = sc_dt::sc_bv<128>;  };
+        template <>              struct typ_scdat<5U> { using typ = sc_dt::sc_bv<256>;  };
+        template <>              struct typ_scdat<6U> { using typ = sc_dt::sc_bv<512>;  };
+        template <>              struct typ_scdat<7U> { using typ = sc_dt::sc_bv<1024>; };
+        template <>              struct typ_scdat<8U> { using typ = sc_dt::sc_bv<2048>; };
+
+        template <unsigned T_be> using Mod   = typename typ_mod<T_be>::typ;
+        template <unsigned T_be> using Dat   = typename typ_dat<T_be>::typ;
+        template <unsigned T_be> using SCDat = typename typ_scdat<T_be>::typ;
+
+        /** \struct Bus
+         *  \brief  Representation of a frame or cell as carried on a datapath.
+         *
+         *  <h2 class="mp">Template Parameter</h2>
+         *
+         *  %Bus width is specified by T_be.
+         *  The "be" in T_be stands for "byte exponent" and the number of bytes in
+         *  the bus is 2^T_be.
+         *
+         *  <h2 class="mp">%Bus Fields</h2>
+         *
+         *  %Bus fields are
+         *  + usr[31:0]
+         *  + err
+         *  + val
+         *  + sof
+         *  + eof
+         *  + dat[((M*8)-1):0]
+         *  + mod[(N-1):0]
+         *
+         *  Where N is the byte exponent and M is 2^N.
+         *
+         *  <h3 class="mp">Mod Field</h3>
+         *
+         *  When T_be = 0, mod is instantiated as the empty class SyscFCBus::no_connect.
+         *
+         *  <h3 class="mp">Dat Field</h3>
+         *
+         *  When T_be is 7 or 8, dat is instantiated as SyscFCBus::Dat_wide, which
+         *  holds it's words inline rather than on the heap as sc_dt::sc_bv does.
+         */
+        /** \fn    Bus::static_assert()
+         *  \brief Ensures failure at compile time for unsupported values of T_be
+         */
+        /** \fn    Bus::operator=()
+         *  \brief Copy constructor for Bus instances
+         */
+        /** \var   Bus::usr
+         *  \brief Unspecified 32-bit field for application use.  May be used for
+         *  the ATM cell fields {usr[3:0], vpi[11:0], vci[15:0]}.
+         */
+        /** \var   Bus::err
+         *  \brief Indicates that the frame has an error in this or a previous clock
+         */
+        /** \var   Bus::val
+         *  \brief Indicates that the data in the Bus structure is valid
+         */
+        /** \var   Bus::sof
+         *  \brief Indicates that the Bus structure is the first in the frame
+         */
+        /** \var   Bus::eof
+         *  \brief Indicates that the Bus structure is the last in the frame
+         */
+        /** \var   Bus::mod
+         *  \brief Indicates the number of valid bytes
+         */
+        /** \var   Bus::dat
+         *  \brief For the datapath bytes
+         */
+
+        template <unsigned T_be>
+        struct Bus
+        {
+            static_assert((T_be < 9), "Bus byte count out of range");
+
+            uint32_t  usr;
+            bool      err;
+            bool      val;
+            bool      sof;
+            bool      eof;
+            Mod<T_be> mod;
+            Dat<T_be> dat;
+
+            static constexpr uint32_t bits_usr = 31;
+            static constexpr uint32_t bits_mod = T_be;
+            static constexpr uint32_t bits_dat = 8 * (1 << T_be);
+
+            Bus<T_be>& operator=(const Bus<T_be>& arg)
+            {
+                if (this == &arg)
+                {
+                    return *this;
+                }
+
+                usr = arg.usr;
+                err = arg.err;
+                val = arg.val;
+                sof = arg.sof;
+                eof = arg.eof;
+                mod = arg.mod;
+                dat = arg.dat;
+
+                return *this;
+            }
+        };
+
+        template <unsigned T_be>
+        typename std::enable_if<(T_be == 0U), Bus<T_be>>::type bus_rst(void)
+        {
+            return {0,false,false,false,false,{},0};
+        }
+
+        template <unsigned T_be>
+        typename std::enable_if<(T_be == 1U), Bus<T_be>>::type bus_rst(void)
+        {
+            return {0,false,false,false,false,false,0};
+        }
+
+        template <unsigned T_be>
+        typename std::enable_if<(T_be > 1U), Bus<T_be>>::type bus_rst(void)
+        {
+            return {0,false,false,false,false,0,0};
+        }
+
+        template <unsigned T_be>
+        typename std::enable_if<(T_be == 0U), Mod<T_be>>::type mod_rst(void)
+        {
+            return {};
+        }
+
+        template <unsigned T_be>
+        typename std::enable_if<(T_be == 1U), Mod<T_be>>::type mod_rst(void)
+        {
+            return false;
+        }
+
+        template <unsigned T_be>
+        typename std::enable_if<(T_be > 1U), Mod<T_be>>::type mod_rst(void)
+        {
+            return 0;
+        }
+
+        template <unsigned T_be>
+        typename std::enable_if<(T_be == 0U), Mod<T_be>>::type mod_set(uint32_t arg)
+        {
+            return {};
+        }
+
+        template <unsigned T_be>
+        typename std::enable_if<(T_be == 1U), Mod<T_be>>::type mod_set(uint32_t arg)
+        {
+            return (arg != 0);
+        }
+
+        template <unsigned T_be>
+        typename std::enable_if<(T_be > 1U), Mod<T_be>>::type mod_set(uint32_t arg)
+        {
+            return arg;
+        }
+
+        template <unsigned T_be>
+        typename std::enable_if<(T_be == 0U), unsigned>::type mod_get_uint(Mod<T_be> arg)
+        {
+            return 0;
+        }
+
+        template <unsigned T_be>
+        typename std::enable_if<(T_be > 0U), unsigned>::type mod_get_uint(Mod<T_be> arg)
+        {
+            return arg;
+        }
+
+        template <unsigned T_be>
+        unsigned bus_get_byte_cnt(Bus<T_be> arg)
+        {
+            unsigned ret = 0;
+            unsigned mod = 0;
+            unsigned max = (1 << T_be);
+
+            if (T_be > 0)
+            {
+                mod = mod_get_uint<T_be>(arg.mod);
+            }
+
+            if (mod == 0)
+            {
+                 ret = max;
+            }
+            else
+            {
+                ret = mod;
+            }
+
+            return ret;
+        }
+
+        /** \fn    dat_from_bytes()
+         *  \brief Packs arg_cnt bytes into a Bus.dat value, first byte in the most
+         *  significant position, zero filling the remaining bytes
+         *
+         *  Works a 64-bit or 32-bit word at a time rather than through
+         *  SCDat::range(), since it is called once per beat.
+         */
+
+        template <unsigned T_be>
+        typename std::enable_if<(T_be < 4U), Dat<T_be>>::type dat_from_bytes(const uint8_t * arg_buf, unsigned arg_cnt)
+        {
+            uint64_t tmp = 0;
+
+            memcpy(&tmp, arg_buf, arg_cnt);
+
+            return Dat<T_be>(be64toh(tmp) >> (64 - (8 << T_be)));
+        }
+
+        template <unsigned T_be>
+        typename std::enable_if<(T_be >= 4U), Dat<T_be>>::type dat_from_bytes(const uint8_t * arg_buf, unsigned arg_cnt)
+        {
+            constexpr unsigned nw  = (1 << T_be) / 4;
+            Dat<T_be>          ret;
+            uint8_t            buf[1 << T_be];
+            uint32_t           tmp;
+
+            memcpy(buf, arg_buf, arg_cnt);
+            memset(buf + arg_cnt, 0, (1 << T_be) - arg_cnt);
+
+            for (unsigned w = 0 ; w < nw ; w++)
+            {
+                memcpy(&tmp, buf + (4 * w), 4);
+                ret.set_word(nw - 1 - w, be32toh(tmp));
+            }
+
+            return ret;
+        }
+
+        /** \fn    dat_to_bytes()
+         *  \brief Unpacks all bytes of a Bus.dat value, most significant first
+         */
+
+        template <unsigned T_be>
+        typename std::enable_if<(T_be < 4U), void>::type dat_to_bytes(const Dat<T_be> & arg_dat, uint8_t * arg_buf)
+        {
+            uint64_t tmp = htobe64(uint64_t(arg_dat) << (64 - (8 << T_be)));
+
+            memcpy(arg_buf, &tmp, 1 << T_be);
+        }
+
+        template <unsigned T_be>
+        typename std::enable_if<(T_be >= 4U), void>::type dat_to_bytes(const Dat<T_be> & arg_dat, uint8_t * arg_buf)
+        {
+            constexpr unsigned nw  = (1 << T_be) / 4;
+            uint32_t           tmp;
+
+            for (unsigned w = 0 ; w < nw ; w++)
+            {
+                tmp = htobe32(arg_dat.get_word(nw - 1 - w));
+                memcpy(arg_buf + (4 * w), &tmp, 4);
+            }
+        }
+
+        template <unsigned T_be>
+        inline bool operator==(const Bus<T_be>& l, const Bus<T_be>& r)
+        {
+            if (l.usr != r.usr) { return false; }
+            if (l.err != r.err) { return false; }
+            if (l.val != r.val) { return false; }
+            if (l.sof != r.sof) { return false; }
+            if (l.eof != r.eof) { return false; }
+            if (l.mod != r.mod) { return false; }
+            if (l.dat != r.dat) { return false; }
+            return true;
+        }
+
+        template <unsigned T_be>
+        inline bool operator!=(const Bus<T_be>& l, const Bus<T_be>& r)
+        {
+            return !(l == r);
+        }
+
+        template <unsigned T_be>
+        ostream& operator<<(ostream& os, const Bus<T_be>& arg)
+        {
+            char     SP    = '\x020';
+            char     NL    = '\n';
+            unsigned w     = 3;
+            unsigned modn  = (T_be > 4) ? 2 : 1;
+            unsigned datn  = (1 << T_be) * 2;
+            unsigned bits  = 8 * (1 << T_be);
+            unsigned lines = (T_be >= 6) ? (1 << (T_be - 5)) : 1;
+            unsigned lbits = bits / lines;
+            string   usrs  = "usr[31:0]";
+            string   mods  = "";
+            string   dats  = string("dat[") + to_string(bits - 1) + ":" + to_string(bits - lbits) + "]";
+
+            SCDat<T_be> scdat = arg.dat;
+
+            if (T_be == 1U)
+            {
+                mods  = string("mod");
+            }
+            else if (T_be != 0U)
+            {
+                mods  = string("mod[") + to_string(T_be - 1) + ":0]";
+            }
+
+            if (usrs.size()  > w) { w = usrs.size();  }
+            if (mods.size()  > w) { w = mods.size();  }
+            if (dats.size()  > w) { w = dats.size();  }
+
+            os << hex;
+            os << SP << setw(w) << setfill(SP) << usrs  << SP << "= 0x" << setw(1) << setfill('0') << arg.usr << NL;
+            os << SP << setw(w) << setfill(SP) << "err" << SP << "= 0x" << setw(1) << setfill('0') << arg.err << NL;
+            os << SP << setw(w) << setfill(SP) << "val" << SP << "= 0x" << setw(1) << setfill('0') << arg.val << NL;
+            os << SP << setw(w) << setfill(SP) << "sof" << SP << "= 0x" << setw(1) << setfill('0') << arg.sof << NL;
+            os << SP << setw(w) << setfill(SP) << "eof" << SP << "= 0x" << setw(1) << setfill('0') << arg.eof << NL;
+
+            if (T_be > 0)
+            {
+                os << SP << setw(w) << setfill(SP) << mods  << SP << "= 0x" << setw(modn) << setfill('0') << arg.mod << NL;
+            }
+
+            for (unsigned i = lines ; i > 0 ; i--)
+            {
+                unsigned msb  = (i * lbits) - 1;
+                unsigned lsb  = (i - 1) * lbits;
+                string   nm   = string("dat[") + to_string(msb) + ":" + to_string(lsb) + "]";
+
+                os << SP << setw(w) << setfill(SP) << nm  << SP << "= 0x" << setw(datn / lines) << setfill('0') ;
+                os << scdat.range(msb, lsb) << NL;
+            }
+
+            os << flush;
+
+            return os;
+        }
+
+        template <unsigned T_be>
+        typename std::enable_if<(T_be == 0U), void>::type
+        sc_trace(sc_trace_file * tf, const Bus<T_be> & arg, const std::string & nm)
+        {
+            sc_trace(tf, arg.usr, nm + ".usr");
+            sc_trace(tf, arg.err, nm + ".err");
+            sc_trace(tf, arg.val, nm + ".val");
+            sc_trace(tf, arg.sof, nm + ".sof");
+            sc_trace(tf, arg.eof, nm + ".eof");
+            sc_trace(tf, arg.dat, nm + ".dat");
+        }
+
+        template <unsigned T_be>
+        typename std::enable_if<(T_be == 1U), void>::type
+        sc_trace(sc_trace_file * tf, const Bus<T_be> & arg, const std::string & nm)
+        {
+            sc_trace(tf, arg.usr, nm + ".usr");
+            sc_trace(tf, arg.err, nm + ".err");
+            sc_trace(tf, arg.val, nm + ".val");
+            sc_trace(tf, arg.sof, nm + ".sof");
+            sc_trace(tf, arg.eof, nm + ".eof");
+            sc_trace(tf, arg.mod, nm + ".mod");
+            sc_trace(tf, arg.dat, nm + ".dat");
+        }
+
+        template <unsigned T_be>
+        typename std::enable_if<(T_be > 1U), void>::type
+        sc_trace(sc_trace_file * tf, const Bus<T_be> & arg, const std::string & nm)
+        {
+            sc_trace(tf, arg.usr, nm + ".usr");
+            sc_trace(tf, arg.err, nm + ".err");
+            sc_trace(tf, arg.val, nm + ".val");
+            sc_trace(tf, arg.sof, nm + ".sof");
+            sc_trace(tf, arg.eof, nm + ".eof");
+            sc_trace(tf, arg.mod, nm + ".mod");
+            sc_trace(tf, arg.dat, nm + ".dat");
+        }
+
+        typedef vector<string> str_vec;
+
+        /** \class Frm_src
+         *  \brief Interface for a source of frames
+         *
+         *  get_frame() returns false when the source is exhausted.  The bytes it
+         *  returns must stay valid until the source has returned two further
+         *  frames, since Bus_src drives one frame while holding the next.
+         *  get_usr() gives the Bus.usr value for the frame last returned.
+         */
+
+        class Frm_src
+        {
+            public:
+                virtual ~Frm_src(void) { }
+
+                virtual bool     get_frame(const uint8_t *&, unsigned &) = 0;
+                virtual uint32_t get_usr(void) { return 0; }
+        };
+
+        /** \class Frm_stream
+         *  \brief Interface for a source that delivers each frame in chunks
+         *
+         *  get_frame_len() starts the next frame and returns false when the
+         *  source is exhausted.  get_chunk() then copies up to arg_max of the
+         *  frame's bytes, in order, and returns the count copied.  Bytes of a
+         *  frame not read before the next get_frame_len() are discarded.
+         */
+
+        class Frm_stream
+        {
+            public:
+                virtual ~Frm_stream(void) { }
+
+                virtual bool     get_frame_len(unsigned &)      = 0;
+                virtual unsigned get_chunk(uint8_t *, unsigned) = 0;
+        };
+
+        /** \enum  enum_err_kind
+         *  \brief Kinds of error injected by Bus_src_eng::set_err()
+         */
+
+        enum enum_err_kind
+        {
+            err_none,
+            err_flip,
+            err_err,
+            err_trunc,
+            err_eof,
+            err_runt,
+            err_over,
+            err_LAST
+        };
+
+        /** \struct err_plan
+         *  \brief The error injected into one frame
+         *
+         *  pos is the byte at which the error is injected: the byte flipped,
+         *  the first byte of the beat from which err is asserted, or the last
+         *  byte of a truncated or runt frame.  len is the frame length as
+         *  driven, and orig the length of the frame from the source.  Bytes of
+         *  an oversize frame past orig are the low byte of their position.
+         */
+
+        typedef struct struct_err_plan
+        {
+            enum_err_kind kind;
+            unsigned      pos;
+            unsigned      bit;
+            unsigned      len;
+            unsigned      orig;
+        } err_plan;
+
+        /** \var   be_max
+         *  \brief Largest supported value of T_be
+         */
+
+        constexpr unsigned be_max = 8;
+
+        /** \fn    be_dispatch()
+         *  \brief Calls T_op<T_be>::run() for a value of T_be chosen at run time
+         *
+         *  Every instantiation of T_op from 0 to be_max is compiled, and the one
+         *  matching arg_be is called.  The selection is made once, typically while
+         *  building a test bench, so the modules that T_op<T_be>::run() creates
+         *  keep fully monomorphic clocked processes.
+         */
+
+        template <template <unsigned> class T_op, typename... T_args>
+        auto be_dispatch(unsigned arg_be, T_args&&... arg_args) -> decltype(T_op<0U>::run(arg_args...))
+        {
+            switch (arg_be)
+            {
+                case 0U: { return T_op<0U>::run(std::forward<T_args>(arg_args)...); }
+                case 1U: { return T_op<1U>::run(std::forward<T_args>(arg_args)...); }
+                case 2U: { return T_op<2U>::run(std::forward<T_args>(arg_args)...); }
+                case 3U: { return T_op<3U>::run(std::forward<T_args>(arg_args)...); }
+                case 4U: { return T_op<4U>::run(std::forward<T_args>(arg_args)...); }
+                case 5U: { return T_op<5U>::run(std::forward<T_args>(arg_args)...); }
+                case 6U: { return T_op<6U>::run(std::forward<T_args>(arg_args)...); }
+                case 7U: { return T_op<7U>::run(std::forward<T_args>(arg_args)...); }
+                case 8U: { return T_op<8U>::run(std::forward<T_args>(arg_args)...); }
+            }
+
+            throw string("SyscFCBus::be_dispatch() byte exponent") + " " + to_string(arg_be) + " " + "out of range";
+        }
+
+        /** \class  Bus_src_eng
+         *  \brief  Frame driving state machine of Bus_src, stepped one clock at
+         *  a time without the SystemC kernel
+         *
+         *  step() advances the machine by one rising clock edge given the dav
+         *  and ack inputs sampled at that edge, and returns the Bus to drive
+         *  until the next edge; get_cnt() and get_req() give the other
+         *  outputs.  Bus_src calls step() from it's clocked thread, and a plain
+         *  C++ Verilator harness may call it directly from it's eval() loop.
+         *
+         *  Frames come from a Frm_src, which holds each whole frame in memory, or
+         *  from a Frm_stream set with set_frm_stream(), which is read into a
+         *  window of fixed size as the frame is driven, so frames of any length
+         *  use bounded memory.
+         *
+         *  set_pace() limits the offered load with a token bucket, see
+         *  Bus_src_eng::set_pace().  set_part() selects the part-frame mode,
+         *  with gaps and short beats within frames, see
+         *  Bus_src_eng::set_part().  set_err() injects errors into frames, see
+         *  Bus_src_eng::set_err().
+         */
+
+        template <unsigned T_be>
+        class Bus_src_eng
+        {
+            public:
+                enum enum_drv_fsm
+                {
+                    state_init,
+                    state_req,
+                    state_ack,
+                    state_pen,
+                    state_LAST
+                };
+
+            private:
+                typedef struct struct_frame
+                {
+                    const uint8_t * bytes;
+                    uint8_t       * win;
+                    unsigned        win_base;
+                    unsigned        win_cnt;
+                    str_vec         str_bytes;
+                    unsigned        byte_cnt;
+                    unsigned        byte_last;
+                    unsigned        byte_req;
+                    uint64_t        bit_cnt;
+                    uint32_t        usr;
+                } frame;
+
+                unique_ptr<SyscMsg::Msg>   msg;
+                Log_src                    lg;
+                Frm_src                  * frm_src;
+                Frm_stream               * frm_stream;
+                vector<uint8_t>            win_buf[2];
+                unsigned                   win_idx;
+                unsigned                   cur_pos;
+                frame                    * cur_frm;
+                frame                    * nxt_frm;
+                Bus<T_be>                  sig_bus;
+                uint64_t                   sig_cnt;
+                bool                       sig_req;
+                unsigned                   drv_cnt;
+                enum_drv_fsm               drv_state;
+                uint64_t                   pace_num;
+                uint64_t                   pace_den;
+                int64_t                    pace_cap;
+                unsigned                   pace_ovh;
+                int64_t                    pace_tok;
+                uint64_t                   pace_tok_clk;
+                uint64_t                   pace_nxt_clk;
+                uint64_t                   pace_clk;
+                bool                       part_on;
+                uint64_t                   part_rnd;
+                unsigned                   part_gap_pct;
+                unsigned                   part_gap_max;
+                unsigned                   part_pct;
+                vector<uint16_t>           part_plan;
+                unsigned                   part_idx;
+                unsigned                   part_pos;
+                bool                       err_on;
+                uint64_t                   err_rnd;
+                uint32_t                   err_ppm[err_LAST];
+                uint32_t                   err_ppm_sum;
+                unsigned                   err_over_len;
+                uint64_t                   err_cnt[err_LAST];
+                err_plan                   err_cur;
+                deque<err_plan>            err_log;
+                unsigned                   err_pos;
+                unsigned                   err_pad;
+                Bus<T_be>                  err_bus;
+
+                void      get_next_frame(void);
+                bool      pace_ready(void);
+                unsigned  part_rand(unsigned);
+                void      part_plan_build(void);
+                void      part_beat(void);
+                unsigned  err_rand(unsigned);
+                void      err_plan_build(void);
+                void      err_beat(void);
+                void      err_pad_beat(void);
+                const Bus<T_be>& step_frm(bool, bool);
+                void      frame_swap(void);
+                void      stream_fill(frame *, unsigned, unsigned);
+                const uint8_t * get_cur_frame_bytes(unsigned, unsigned);
+                Dat<T_be> get_cur_frame_dat(unsigned);
+                Mod<T_be> get_cur_frame_mod(unsigned);
+                unsigned  incr_drv_cnt(unsigned);
+
+            public:
+                Bus_src_eng(const string &);
+                ~Bus_src_eng(void);
+
+                const Bus<T_be>& step(bool, bool);
+                const Bus<T_be>& get_bus(void);
+                uint32_t  get_cnt(void);
+                bool      get_req(void);
+                unsigned  get_state(void);
+                unsigned  get_drv_cnt(void);
+                unsigned  get_cur_len(void);
+                unsigned  get_nxt_len(void);
+                void      set_frm_src(Frm_src*);
+                void      set_frm_stream(Frm_stream*, unsigned);
+                void      set_pace(uint32_t, uint32_t, unsigned, unsigned);
+                void      set_part(uint64_t, unsigned, unsigned, unsigned);
+                void      set_err(uint64_t, unsigned);
+                void      set_err_rate(enum_err_kind, uint32_t);
+                bool      pop_err_plan(err_plan &);
+                uint64_t  get_err_cnt(enum_err_kind);
+                unsigned  get_cur_byte_cnt(void);
+                const str_vec& get_cur_byte_vec(void);
+                const uint8_t* get_cur_bytes(void);
+        };
+
+        template <unsigned T_be>
+        Bus_src_eng<T_be>::Bus_src_eng(const string & arg_nm) : lg(arg_nm)
+        {
+            this->msg         = unique_ptr<SyscMsg::Msg>(new SyscMsg::Msg(arg_nm));
+            this->frm_src     = nullptr;
+            this->frm_stream  = nullptr;
+            this->win_idx     = 0;
+            this->cur_pos     = 0;
+            this->cur_frm     = nullptr;
+            this->nxt_frm     = nullptr;
+            this->sig_bus     = bus_rst<T_be>();
+            this->sig_cnt     = 0;
+            this->sig_req     = false;
+            this->drv_cnt     = 0;
+            this->drv_state   = state_init;
+            this->pace_clk    = 0;
+
+            this->part_on     = false;
+            this->part_idx    = 0;
+            this->part_pos    = 0;
+
+            this->err_on      = false;
+            this->err_rnd     = 1;
+            this->err_ppm_sum = 0;
+            this->err_pos     = 0;
+            this->err_pad     = 0;
+            this->err_bus     = bus_rst<T_be>();
+            this->err_cur     = { err_none, 0, 0, 0, 0 };
+
+            for (unsigned i = 0 ; i < err_LAST ; i++)
+            {
+                this->err_ppm[i] = 0;
+                this->err_cnt[i] = 0;
+            }
+
+            this->set_pace(0, 1, 0, 0);
+        }
+
+        template <unsigned T_be>
+        Bus_src_eng<T_be>::~Bus_src_eng(void)
+        {
+            delete this->cur_frm;
+            delete this->nxt_frm;
+        }
+
+        template <unsigned T_be>
+        unsigned Bus_src_eng<T_be>::get_cur_byte_cnt(void)
+        {
+            return this->cur_frm->byte_cnt;
+        }
+
+        template <unsigned T_be>
+        const str_vec & Bus_src_eng<T_be>::get_cur_byte_vec(void)
+        {
+            static const char hex[] = "0123456789ABCDEF";
+            frame           * frm   = this->cur_frm;
+            string            SP    = SyscMsg::Chars::SP;
+
+            if (this->frm_stream != nullptr)
+            {
+                this->msg->report_inf("whole frame is not held when streaming");
+                throw "Bus instance" + SP + this->msg->get_str_c_msgid() + SP + "get_cur_byte_vec() called when streaming";
+            }
+
+            if (frm->str_bytes.size() != frm->byte_cnt)
+            {
+                frm->str_bytes.resize(frm->byte_cnt);
+
+                for (unsigned i = 0 ; i < frm->byte_cnt ; i++)
+                {
+                    char tmp[2] = { hex[frm->bytes[i] >> 4], hex[frm->bytes[i] & 0xF] };
+
+                    frm->str_bytes[i].assign(tmp, 2);
+                }
+            }
+
+            return frm->str_bytes;
+        }
+
+        /** \fn    Bus_src_eng::get_cur_bytes()
+         *  \brief Returns the bytes of the frame being driven, which are held
+         *  until the frame ends
+         */
+
+        template <unsigned T_be>
+        const uint8_t * Bus_src_eng<T_be>::get_cur_bytes(void)
+        {
+            string SP = SyscMsg::Chars::SP;
+
+            if (this->frm_stream != nullptr)
+            {
+                this->msg->report_inf("whole frame is not held when streaming");
+                throw "Bus instance" + SP + this->msg->get_str_c_msgid() + SP + "get_cur_bytes() called when streaming";
+            }
+
+            return this->cur_frm->bytes;
+        }
+
+        /** \fn    Bus_src_eng::set_frm_src()
+         *  \brief Sets the source of frames
+         */
+
+        template <unsigned T_be>
+        void Bus_src_eng<T_be>::set_frm_src(Frm_src * arg_fs)
+        {
+            this->frm_src = arg_fs;
+        }
+
+        /** \fn    Bus_src_eng::set_frm_stream()
+         *  \brief Takes frames from a Frm_stream in place of any Frm_src, reading
+         *  each frame through a window of arg_win bytes
+         *
+         *  The window is rounded up to a whole number of beats, and to no less
+         *  than four beats so the tail of a frame fits when the next frame is
+         *  started.
+         */
+
+        template <unsigned T_be>
+        void Bus_src_eng<T_be>::set_frm_stream(Frm_stream * arg_fs, unsigned arg_win)
+        {
+            unsigned bytes = (1 << T_be);
+            unsigned win   = ((arg_win + bytes - 1) / bytes) * bytes;
+
+            if (win < (4 * bytes))
+            {
+                win = 4 * bytes;
+            }
+
+            this->frm_stream = arg_fs;
+            this->win_buf[0].assign(win, 0);
+            this->win_buf[1].assign(win, 0);
+        }
+
+        /** \fn    Bus_src_eng::set_pace()
+         *  \brief Limits the offered load to arg_num/arg_den bytes per clock,
+         *  counting arg_ovh bytes of overhead per frame and allowing bursts of
+         *  up to arg_burst bytes
+         *
+         *  Each frame costs it's length plus arg_ovh bytes of tokens, which
+         *  accrue at arg_num/arg_den bytes per step(), stalled or not, up to
+         *  arg_burst.  A frame is started once the bucket holds it's cost, or
+         *  is full when the cost is larger than arg_burst, and idle beats are
+         *  driven until then.  The clock at which the tokens will suffice is
+         *  computed when the frame is ready, so the bucket is not updated on
+         *  each clock.  The remainder carries over between frames, so the long
+         *  run load is exact; 40% of a 64 bit bus is set_pace(16, 5, ...), and
+         *  arg_ovh 20 accounts for the preamble and inter-frame gap of 802.3.
+         *  An arg_num of zero, the default, removes the limit.
+         */
+
+        template <unsigned T_be>
+        void Bus_src_eng<T_be>::set_pace(uint32_t arg_num, uint32_t arg_den, unsigned arg_burst, unsigned arg_ovh)
+        {
+            string SP = SyscMsg::Chars::SP;
+
+            if (arg_den == 0)
+            {
+                this->msg->report_inf("pace denominator is zero");
+                throw "Bus instance" + SP + this->msg->get_str_c_msgid() + SP + "set_pace() denominator is zero";
+            }
+
+            this->pace_num     = arg_num;
+            this->pace_den     = arg_den;
+            this->pace_cap     = int64_t(arg_burst) * arg_den;
+            this->pace_ovh     = arg_ovh;
+            this->pace_tok     = this->pace_cap;
+            this->pace_tok_clk = this->pace_clk;
+            this->pace_nxt_clk = 0;
+        }
+
+        /** \fn    Bus_src_eng::pace_ready()
+         *  \brief Returns true, taking the tokens, when the next frame may
+         *  start on this clock
+         */
+
+        template <unsigned T_be>
+        bool Bus_src_eng<T_be>::pace_ready(void)
+        {
+            if (this->pace_num == 0)
+            {
+                return true;
+            }
+
+            if (this->pace_clk < this->pace_nxt_clk)
+            {
+                return false;
+            }
+
+            int64_t  cost = int64_t(this->nxt_frm->byte_cnt + this->pace_ovh) * this->pace_den;
+            int64_t  need = (cost < this->pace_cap) ? cost : this->pace_cap;
+
+            this->pace_tok     = this->pace_tok + int64_t((this->pace_clk - this->pace_tok_clk) * this->pace_num);
+            this->pace_tok     = (this->pace_tok > this->pace_cap) ? this->pace_cap : this->pace_tok;
+            this->pace_tok_clk = this->pace_clk;
+
+            if (this->pace_tok < need)
+            {
+                this->pace_nxt_clk = this->pace_clk + ((need - this->pace_tok) + this->pace_num - 1) / this->pace_num;
+                return false;
+            }
+
+            this->pace_tok = this->pace_tok - cost;
+
+            return true;
+        }
+
+        /** \fn    Bus_src_eng::set_part()
+         *  \brief Selects the part-frame mode, where beats within a frame may
+         *  be short and may be separated by gaps
+         *
+         *  After each beat but the last, a gap of 1 to arg_gap_max clocks with
+         *  val low follows with probability arg_gap_pct percent, and each beat
+         *  carries fewer than the full bus width of bytes, with mod non-zero,
+         *  with probability arg_part_pct percent.  The pattern comes from a
+         *  generator seeded with arg_seed, so a run can be repeated.  A plan
+         *  of the beats of each frame is made when the frame is started, so
+         *  each clock only reads the next entry of the plan.
+         */
+
+        template <unsigned T_be>
+        void Bus_src_eng<T_be>::set_part(uint64_t arg_seed, unsigned arg_gap_pct, unsigned arg_gap_max, unsigned arg_part_pct)
+        {
+            this->part_on      = true;
+            this->part_rnd     = (arg_seed == 0) ? 1 : arg_seed;
+            this->part_gap_pct = arg_gap_pct;
+            this->part_gap_max = (arg_gap_max == 0) ? 1 : arg_gap_max;
+            this->part_pct     = arg_part_pct;
+        }
+
+        template <unsigned T_be>
+        unsigned Bus_src_eng<T_be>::part_rand(unsigned arg_lim)
+        {
+            this->part_rnd = this->part_rnd ^ (this->part_rnd << 13);
+            this->part_rnd = this->part_rnd ^ (this->part_rnd >> 7);
+            this->part_rnd = this->part_rnd ^ (this->part_rnd << 17);
+
+            return this->part_rnd % arg_lim;
+        }
+
+        /** \fn    Bus_src_eng::part_plan_build()
+         *  \brief Makes the plan of the current frame, one entry per clock
+         *  holding the bytes of the beat, or zero for a gap
+         */
+
+        template <unsigned T_be>
+        void Bus_src_eng<T_be>::part_plan_build(void)
+        {
+            unsigned bytes = (1 << T_be);
+            unsigned len   = this->cur_frm->byte_cnt;
+            unsigned pos   = 0;
+            string   SP    = SyscMsg::Chars::SP;
+
+            if (len == 0)
+            {
+                this->msg->report_inf("empty frame in part-frame mode");
+                throw "Bus instance" + SP + this->msg->get_str_c_msgid() + SP + "part_plan_build() empty frame";
+            }
+
+            this->part_plan.clear();
+            this->part_idx = 0;
+            this->part_pos = 0;
+
+            while (pos < len)
+            {
+                unsigned cnt = bytes;
+
+                if ((pos != 0) && (this->part_rand(100) < this->part_gap_pct))
+                {
+                    this->part_plan.insert(this->part_plan.end(), 1 + this->part_rand(this->part_gap_max), 0);
+                }
+
+                if ((bytes > 1) && (this->part_rand(100) < this->part_pct))
+                {
+                    cnt = 1 + this->part_rand(bytes - 1);
+                }
+
+                cnt = ((len - pos) < cnt) ? (len - pos) : cnt;
+                pos = pos + cnt;
+
+                this->part_plan.push_back(cnt);
+            }
+        }
+
+        /** \fn    Bus_src_eng::part_beat()
+         *  \brief Drives the next entry of the plan, requesting the next frame
+         *  two entries before the end
+         */
+
+        template <unsigned T_be>
+        void Bus_src_eng<T_be>::part_beat(void)
+        {
+            unsigned bytes = (1 << T_be);
+            unsigned cnt   = this->part_plan[this->part_idx];
+
+            this->part_idx = this->part_idx + 1;
+
+            if (cnt == 0)
+            {
+                this->sig_bus.val = false;
+            }
+            else
+            {
+                this->drv_cnt     = this->part_pos;
+                this->part_pos    = this->part_pos + cnt;
+                this->sig_bus.mod = (cnt < bytes) ? mod_set<T_be>(cnt) : mod_rst<T_be>();
+                this->sig_bus.dat = dat_from_bytes<T_be>(this->get_cur_frame_bytes(this->drv_cnt, cnt), cnt);
+                this->sig_bus.sof = (this->drv_cnt == 0);
+                this->sig_bus.eof = (this->part_pos == this->cur_frm->byte_cnt);
+                this->sig_bus.val = true;
+            }
+
+            if ((this->drv_state != state_pen) && ((this->part_idx + 2) >= this->part_plan.size()))
+            {
+                this->get_next_frame();
+
+                this->sig_cnt     = this->nxt_frm->bit_cnt;
+                this->sig_req     = true;
+                this->drv_state   = state_pen;
+            }
+            else if (this->drv_state != state_pen)
+            {
+                this->sig_req     = false;
+                this->drv_state   = state_ack;
+            }
+
+            if (this->sig_bus.eof)
+            {
+                this->drv_state   = state_req;
+            }
+        }
+
+        /** \fn    Bus_src_eng::set_err()
+         *  \brief Enables error injection, seeded with arg_seed, padding
+         *  oversize frames to more than arg_over_len bytes
+         *
+         *  Each frame carries at most one error, of a kind drawn when it's
+         *  sof is driven with the rates given to set_err_rate().  The kind
+         *  and position are fixed then, so each later beat of the frame only
+         *  compares it's position with the plan.  Bit flips change one bit of
+         *  dat, err is asserted from one beat to eof, truncated and runt
+         *  frames end early, with val low on the beats that would have
+         *  followed, a dropped eof leaves the frame open until the next sof,
+         *  and an oversize frame is padded with beats driven while the frame
+         *  state machine is held.  The plan of each frame is kept for
+         *  pop_err_plan(), so a checker can expect the error.
+         */
+
+        template <unsigned T_be>
+        void Bus_src_eng<T_be>::set_err(uint64_t arg_seed, unsigned arg_over_len)
+        {
+            this->err_on       = true;
+            this->err_rnd      = (arg_seed == 0) ? 1 : arg_seed;
+            this->err_over_len = arg_over_len;
+            this->err_bus      = this->sig_bus;
+        }
+
+        /** \fn    Bus_src_eng::set_err_rate()
+         *  \brief Sets the rate of one kind of error, in frames per million
+         */
+
+        template <unsigned T_be>
+        void Bus_src_eng<T_be>::set_err_rate(enum_err_kind arg_kind, uint32_t arg_ppm)
+        {
+            string   SP  = SyscMsg::Chars::SP;
+            uint32_t sum = this->err_ppm_sum - this->err_ppm[arg_kind] + arg_ppm;
+
+            if ((arg_kind == err_none) || (arg_kind >= err_LAST) || (sum > 1000000))
+            {
+                this->msg->report_inf("bad error kind or rates above one million per million frames");
+                throw "Bus instance" + SP + this->msg->get_str_c_msgid() + SP + "set_err_rate() bad kind or rate";
+            }
+
+            this->err_ppm[arg_kind] = arg_ppm;
+            this->err_ppm_sum       = sum;
+        }
+
+        /** \fn    Bus_src_eng::pop_err_plan()
+         *  \brief Takes the plan of the oldest frame started and not yet
+         *  taken, returning false when there is none
+         *
+         *  At most 256 plans are kept; older plans are discarded.
+         */
+
+        template <unsigned T_be>
+        bool Bus_src_eng<T_be>::pop_err_plan(err_plan & arg_plan)
+        {
+            if (this->err_log.empty())
+            {
+                return false;
+            }
+
+            arg_plan = this->err_log.front();
+            this->err_log.pop_front();
+
+            return true;
+        }
+
+        template <unsigned T_be>
+        uint64_t Bus_src_eng<T_be>::get_err_cnt(enum_err_kind arg_kind)
+        {
+            return this->err_cnt[arg_kind];
+        }
+
+        template <unsigned T_be>
+        unsigned Bus_src_eng<T_be>::err_rand(unsigned arg_lim)
+        {
+            this->err_rnd = this->err_rnd ^ (this->err_rnd << 13);
+            this->err_rnd = this->err_rnd ^ (this->err_rnd >> 7);
+            this->err_rnd = this->err_rnd ^ (this->err_rnd << 17);
+
+            return this->err_rnd % arg_lim;
+        }
+
+        /** \fn    Bus_src_eng::err_plan_build()
+         *  \brief Draws the error of the current frame
+         */
+
+        template <unsigned T_be>
+        void Bus_src_eng<T_be>::err_plan_build(void)
+        {
+            unsigned   len  = this->cur_frm->byte_cnt;
+            uint32_t   rnd  = this->err_rand(1000000);
+            err_plan & plan = this->err_cur;
+
+            plan = { err_none, 0, 0, len, len };
+
+            for (unsigned i = err_none + 1 ; i < err_LAST ; i++)
+            {
+                if (rnd < this->err_ppm[i])
+                {
+                    plan.kind = static_cast<enum_err_kind>(i);
+                    break;
+                }
+
+                rnd = rnd - this->err_ppm[i];
+            }
+
+            if (len == 0)
+            {
+                plan.kind = err_none;
+            }
+
+            switch (plan.kind)
+            {
+                case err_flip:
+                case err_err:
+                {
+                    plan.pos = this->err_rand(len);
+                    plan.bit = this->err_rand(8);
+                    break;
+                }
+                case err_trunc:
+                case err_runt:
+                {
+                    unsigned lim = ((plan.kind == err_runt) && (len > 64)) ? 64 : len;
+
+                    plan.kind = (lim < 2) ? err_none : plan.kind;
+                    plan.pos  = (lim < 2) ? 0 : this->err_rand(lim - 1);
+                    plan.len  = (lim < 2) ? len : (plan.pos + 1);
+                    break;
+                }
+                case err_eof:
+                {
+                    plan.pos = len - 1;
+                    break;
+                }
+                case err_over:
+                {
+                    plan.pos = len;
+                    plan.len = ((len > this->err_over_len) ? len : this->err_over_len) + 1 + this->err_rand(1 << T_be);
+                    break;
+                }
+                default:
+                {
+                    break;
+                }
+            }
+
+            this->err_cnt[plan.kind] = this->err_cnt[plan.kind] + 1;
+
+            if (this->err_log.size() == 256)
+            {
+                this->err_log.pop_front();
+            }
+
+            this->err_log.push_back(plan);
+        }
+
+        /** \fn    Bus_src_eng::err_beat()
+         *  \brief Applies the plan of the current frame to the beat in err_bus
+         */
+
+        template <unsigned T_be>
+        void Bus_src_eng<T_be>::err_beat(void)
+        {
+            unsigned         bytes = (1 << T_be);
+            unsigned         cnt   = bus_get_byte_cnt<T_be>(this->err_bus);
+            unsigned         pos   = this->err_pos;
+            const err_plan & plan  = this->err_cur;
+            uint8_t          tmp[1 << T_be];
+
+            this->err_pos = pos + cnt;
+
+            switch (plan.kind)
+            {
+                case err_flip:
+                {
+                    if ((plan.pos >= pos) && (plan.pos < this->err_pos))
+                    {
+                        dat_to_bytes<T_be>(this->err_bus.dat, tmp);
+                        tmp[plan.pos - pos] = tmp[plan.pos - pos] ^ (1 << plan.bit);
+                        this->err_bus.dat = dat_from_bytes<T_be>(tmp, bytes);
+                    }
+
+                    break;
+                }
+                case err_err:
+                {
+                    this->err_bus.err = (plan.pos < this->err_pos);
+                    break;
+                }
+                case err_trunc:
+                case err_runt:
+                {
+                    if (pos > plan.pos)
+                    {
+                        this->err_bus.val = false;
+                        this->err_bus.eof = false;
+                    }
+                    else if (plan.pos < this->err_pos)
+                    {
+                        cnt               = plan.pos - pos + 1;
+                        this->err_bus.mod = (cnt < bytes) ? mod_set<T_be>(cnt) : mod_rst<T_be>();
+                        this->err_bus.eof = true;
+                    }
+
+                    break;
+                }
+                case err_eof:
+                {
+                    this->err_bus.eof = false;
+                    break;
+                }
+                case err_over:
+                {
+                    if (this->err_bus.eof)
+                    {
+                        unsigned end = ((plan.len - pos) < bytes) ? plan.len : (pos + bytes);
+
+                        dat_to_bytes<T_be>(this->err_bus.dat, tmp);
+
+                        for (unsigned i = cnt ; i < (end - pos) ; i++)
+                        {
+                            tmp[i] = (pos + i) & 0xFF;
+                        }
+
+                        this->err_pos     = end;
+                        this->err_pad     = plan.len - end;
+                        this->err_bus.dat = dat_from_bytes<T_be>(tmp, end - pos);
+                        this->err_bus.mod = ((end - pos) < bytes) ? mod_set<T_be>(end - pos) : mod_rst<T_be>();
+                        this->err_bus.eof = (this->err_pad == 0);
+                    }
+
+                    break;
+                }
+                default:
+                {
+                    break;
+                }
+            }
+        }
+
+        /** \fn    Bus_src_eng::err_pad_beat()
+         *  \brief Drives the next beat of padding of an oversize frame
+         */
+
+        template <unsigned T_be>
+        void Bus_src_eng<T_be>::err_pad_beat(void)
+        {
+            unsigned bytes = (1 << T_be);
+            unsigned cnt   = (this->err_pad < bytes) ? this->err_pad : bytes;
+            uint8_t  tmp[1 << T_be];
+
+            for (unsigned i = 0 ; i < cnt ; i++)
+            {
+                tmp[i] = (this->err_pos + i) & 0xFF;
+            }
+
+            this->err_pos     = this->err_pos + cnt;
+            this->err_pad     = this->err_pad - cnt;
+            this->err_bus.dat = dat_from_bytes<T_be>(tmp, cnt);
+            this->err_bus.mod = (cnt < bytes) ? mod_set<T_be>(cnt) : mod_rst<T_be>();
+            this->err_bus.val = true;
+            this->err_bus.sof = false;
+            this->err_bus.eof = (this->err_pad == 0);
+        }
+
+        template <unsigned T_be>
+        void Bus_src_eng<T_be>::frame_swap(void)
+        {
+            delete this->cur_frm;
+            this->cur_frm = this->nxt_frm;
+            this->nxt_frm = nullptr;
+            this->cur_pos = 0;
+        }
+
+        /** \fn    Bus_src_eng::stream_fill()
+         *  \brief Moves the window of arg_frm to start at byte arg_off and reads
+         *  from the stream until at least arg_cnt bytes from there are held
+         */
+
+        template <unsigned T_be>
+        void Bus_src_eng<T_be>::stream_fill(frame * arg_frm, unsigned arg_off, unsigned arg_cnt)
+        {
+            unsigned win_len = this->win_buf[0].size();
+            unsigned win_end = arg_frm->win_base + arg_frm->win_cnt;
+            string   SP      = SyscMsg::Chars::SP;
+
+            if ((arg_off + arg_cnt) <= win_end)
+            {
+                return;
+            }
+
+            memmove(arg_frm->win, arg_frm->win + (arg_off - arg_frm->win_base), win_end - arg_off);
+
+            arg_frm->win_cnt  = win_end - arg_off;
+            arg_frm->win_base = arg_off;
+
+            while ((arg_frm->win_cnt < win_len) && ((arg_frm->win_base + arg_frm->win_cnt) < arg_frm->byte_cnt))
+            {
+                unsigned rem = arg_frm->byte_cnt - (arg_frm->win_base + arg_frm->win_cnt);
+                unsigned max = win_len - arg_frm->win_cnt;
+                unsigned cnt = this->frm_stream->get_chunk(arg_frm->win + arg_frm->win_cnt, (rem < max) ? rem : max);
+
+                if (cnt == 0)
+                {
+                    this->msg->report_inf("frame stream ended within a frame");
+                    throw "Bus instance" + SP + this->msg->get_str_c_msgid() + SP + "stream_fill() frame stream ended within a frame";
+                }
+
+                arg_frm->win_cnt = arg_frm->win_cnt + cnt;
+            }
+        }
+
+        template <unsigned T_be>
+        const uint8_t * Bus_src_eng<T_be>::get_cur_frame_bytes(unsigned arg_off, unsigned arg_cnt)
+        {
+            if (this->frm_stream == nullptr)
+            {
+                return this->cur_frm->bytes + arg_off;
+            }
+
+            this->stream_fill(this->cur_frm, arg_off, arg_cnt);
+            this->cur_pos = arg_off;
+
+            return this->cur_frm->win + (arg_off - this->cur_frm->win_base);
+        }
+
+        template <unsigned T_be>
+        Mod<T_be> Bus_src_eng<T_be>::get_cur_frame_mod(unsigned arg_cnt)
+        {
+            Mod<T_be> ret = mod_rst<T_be>();
+
+            if (T_be == 0U)
+            {
+                return ret;
+            }
+
+            unsigned    cnt  = (1 << T_be);
+            unsigned    dif  = this->cur_frm->byte_cnt - arg_cnt;
+
+            if (dif < cnt)
+            {
+                ret = mod_set<T_be>(dif);
+            }
+
+            return ret;
+        }
+
+        template <unsigned T_be>
+        Dat<T_be> Bus_src_eng<T_be>::get_cur_frame_dat(unsigned arg_cnt)
+        {
+            unsigned    cnt  = (1 << T_be);
+            unsigned    dif  = this->cur_frm->byte_cnt - arg_cnt;
+
+            if (dif > cnt)
+            {
+                dif = cnt;
+            }
+
+            return dat_from_bytes<T_be>(this->get_cur_frame_bytes(arg_cnt, dif), dif);
+        }
+
+        template <unsigned T_be>
+        unsigned Bus_src_eng<T_be>::incr_drv_cnt(unsigned arg_cnt)
+        {
+            unsigned    idx  = arg_cnt;
+            unsigned    cnt  = (1 << T_be);
+            unsigned    ret  = idx + cnt;
+
+            if (this->cur_frm->byte_cnt < ret)
+            {
+                ret = this->cur_frm->byte_cnt;
+            }
+
+            return ret;
+        }
+
+        template <unsigned T_be>
+        void Bus_src_eng<T_be>::get_next_frame(void)
+        {
+            unsigned           bytes            = (1 << T_be);
+            const uint8_t    * frm_dat          = nullptr;
+            unsigned           frm_cnt          = 0;
+            string             SP               = SyscMsg::Chars::SP;
+
+            if (this->frm_stream != nullptr)
+            {
+                if (this->cur_frm != nullptr)
+                {
+                    this->stream_fill(this->cur_frm, this->cur_pos, this->cur_frm->byte_cnt - this->cur_pos);
+                }
+
+                if (!this->frm_stream->get_frame_len(frm_cnt))
+                {
+                    this->msg->report_inf("frame stream exhausted");
+                    throw "Bus instance" + SP + this->msg->get_str_c_msgid() + SP + "get_next_frame() frame stream exhausted";
+                }
+            }
+            else if (!this->frm_src->get_frame(frm_dat, frm_cnt))
+            {
+                this->msg->report_inf("frame source exhausted");
+                throw "Bus instance" + SP + this->msg->get_str_c_msgid() + SP + "get_next_frame() frame source exhausted";
+            }
+
+            this->nxt_frm            = new frame;
+            this->nxt_frm->bytes     = frm_dat;
+            this->nxt_frm->win       = nullptr;
+            this->nxt_frm->win_base  = 0;
+            this->nxt_frm->win_cnt   = 0;
+            this->nxt_frm->byte_cnt  = frm_cnt;
+            this->nxt_frm->usr       = (this->frm_stream == nullptr) ? this->frm_src->get_usr() : 0;
+
+            if (this->frm_stream != nullptr)
+            {
+                this->nxt_frm->win = this->win_buf[this->win_idx].data();
+                this->win_idx      = this->win_idx ^ 1;
+            }
+            this->nxt_frm->bit_cnt   = this->nxt_frm->byte_cnt * 8;
+
+            if (bytes > this->nxt_frm->byte_cnt)
+            {
+                this->nxt_frm->byte_last = 0;
+            }
+            else
+            {
+                this->nxt_frm->byte_last = this->nxt_frm->byte_cnt - (1 * bytes);
+            }
+
+            if ((2 * bytes) > this->nxt_frm->byte_cnt)
+            {
+                this->nxt_frm->byte_req = 0;
+            }
+            else
+            {
+                this->nxt_frm->byte_req  = this->nxt_frm->byte_cnt - (2 * bytes);
+            }
+
+            log_dbg(this->lg, "next frame_len is {}", frm_cnt);
+        }
+
+
+        /** \fn    Bus_src_eng::step()
+         *  \brief Advances the state machine by one clock
+         *
+         *  When arg_dav is false the outputs are held and nothing advances.
+         *  With error injection the beat of the state machine is copied and
+         *  changed by the plan of it's frame, and the state machine is held
+         *  while the padding of an oversize frame is driven.
+         */
+
+        template <unsigned T_be>
+        const Bus<T_be> & Bus_src_eng<T_be>::step(bool arg_dav, bool arg_ack)
+        {
+            if (!this->err_on)
+            {
+                return this->step_frm(arg_dav, arg_ack);
+            }
+
+            if (arg_dav && (this->err_pad > 0))
+            {
+                this->pace_clk = this->pace_clk + 1;
+                this->err_pad_beat();
+                return this->err_bus;
+            }
+
+            if (!arg_dav)
+            {
+                this->step_frm(false, arg_ack);
+                return this->err_bus;
+            }
+
+            this->err_bus = this->step_frm(true, arg_ack);
+
+            if (!this->err_bus.val)
+            {
+                return this->err_bus;
+            }
+
+            if (this->err_bus.sof)
+            {
+                this->err_plan_build();
+                this->err_pos = 0;
+            }
+
+            this->err_beat();
+
+            return this->err_bus;
+        }
+
+        template <unsigned T_be>
+        const Bus<T_be> & Bus_src_eng<T_be>::step_frm(bool arg_dav, bool arg_ack)
+        {
+            this->pace_clk = this->pace_clk + 1;
+
+            if (!arg_dav)
+            {
+                return this->sig_bus;
+            }
+
+            this->sig_bus.sof = false;
+            this->sig_bus.eof = false;
+
+            if (this->part_on && ((this->drv_state == state_ack) || (this->drv_state == state_pen)))
+            {
+                this->part_beat();
+                return this->sig_bus;
+            }
+
+            switch (this->drv_state)
+            {
+                case state_init:
+                {
+                    this->get_next_frame();
+
+                    this->sig_cnt     = this->nxt_frm->bit_cnt;
+                    this->sig_req     = true;
+                    this->sig_bus.dat = 0;
+                    this->sig_bus.mod = mod_rst<T_be>();
+                    this->sig_bus.val = false;
+                    this->drv_state   = state_req;
+
+                    break;
+                }
+                case state_req:
+                {
+                    if (!arg_ack || !this->pace_ready())
+                    {
+                        this->sig_req     = true;
+                        this->sig_bus.val = false;
+                        break;
+                    }
+
+                    this->frame_swap();
+
+                    this->sig_bus.usr = this->cur_frm->usr;
+
+                    if (this->part_on)
+                    {
+                        this->part_plan_build();
+                        this->part_beat();
+                        break;
+                    }
+
+                    this->drv_cnt     = 0;
+                    this->sig_bus.mod = this->get_cur_frame_mod(this->drv_cnt);
+                    this->sig_bus.dat = this->get_cur_frame_dat(this->drv_cnt);
+                    this->sig_bus.sof = true;
+
+                    if (this->drv_cnt >= this->cur_frm->byte_req)
+                    {
+                        this->get_next_frame();
+
+                        this->sig_cnt     = this->nxt_frm->bit_cnt;
+                        this->sig_req     = true;
+                    }
+                    else
+                    {
+                        this->sig_req     = false;
+                    }
+
+                    if (this->drv_cnt >= this->cur_frm->byte_last)
+                    {
+                        this->sig_bus.eof = true;
+                        this->sig_bus.val = true;
+                        this->drv_state   = state_req;
+                    }
+                    else if (this->drv_cnt >= this->cur_frm->byte_req)
+                    {
+                        this->sig_bus.val = true;
+                        this->drv_state   = state_pen;
+                    }
+                    else
+                    {
+                        this->sig_bus.val = true;
+                        this->drv_state   = state_ack;
+                    }
+
+                    log_dbg
+                    (
+                        this->lg, "step() state_req drv_cnt {} cur_byte_req {} cur_byte_last {}",
+                        this->drv_cnt, this->cur_frm->byte_req, this->cur_frm->byte_last
+                    );
+
+                    break;
+                }
+                case state_ack:
+                {
+                    this->drv_cnt     = this->incr_drv_cnt(this->drv_cnt);
+                    this->sig_bus.mod = this->get_cur_frame_mod(this->drv_cnt);
+                    this->sig_bus.dat = this->get_cur_frame_dat(this->drv_cnt);
+
+                    if (this->drv_cnt >= this->cur_frm->byte_req)
+                    {
+                        this->get_next_frame();
+
+                        this->sig_cnt     = this->nxt_frm->bit_cnt;
+                        this->sig_req     = true;
+                    }
+                    else
+                    {
+                        this->sig_req     = false;
+                    }
+
+                    if (this->drv_cnt >= this->cur_frm->byte_last)
+                    {
+                        this->sig_bus.eof = true;
+                        this->sig_bus.val = true;
+                        this->drv_state   = state_req;
+                    }
+                    else if (this->drv_cnt >= this->cur_frm->byte_req)
+                    {
+                        this->sig_bus.val = true;
+                        this->drv_state   = state_pen;
+                    }
+                    else
+                    {
+                        this->sig_bus.val = true;
+                        this->drv_state   = state_ack;
+                    }
+
+                    log_dbg
+                    (
+                        this->lg, "step() state_ack drv_cnt {} cur_byte_req {} cur_byte_last {}",
+                        this->drv_cnt, this->cur_frm->byte_req, this->cur_frm->byte_last
+                    );
+
+                    break;
+                }
+                case state_pen:
+                {
+                    this->drv_cnt     = this->incr_drv_cnt(this->drv_cnt);
+                    this->sig_bus.mod = this->get_cur_frame_mod(this->drv_cnt);
+                    this->sig_bus.dat = this->get_cur_frame_dat(this->drv_cnt);
+
+                    if (this->drv_cnt >= this->cur_frm->byte_last)
+                    {
+                        this->sig_bus.eof = true;
+                        this->sig_bus.val = true;
+                        this->drv_state   = state_req;
+                    }
+                    else
+                    {
+                        this->sig_bus.val = true;
+                        this->drv_state   = state_pen;
+                    }
+
+                    log_dbg
+                    (
+                        this->lg, "step() state_pen drv_cnt {} cur_byte_req {} cur_byte_last {}",
+                        this->drv_cnt, this->cur_frm->byte_req, this->cur_frm->byte_last
+                    );
+
+                    break;
+                }
+                default:
+                {
+                    string SP = SyscMsg::Chars::SP;
+
+                    this->msg->report_inf("FSM in default case");
+                    throw "Bus instance" + SP + this->msg->get_str_c_msgid() + SP + "step() FSM in default case";
+                    break;
+                }
+            }
+
+            return this->sig_bus;
+        }
+
+        template <unsigned T_be>
+        const Bus<T_be> & Bus_src_eng<T_be>::get_bus(void)
+        {
+            return this->err_on ? this->err_bus : this->sig_bus;
+        }
+
+        template <unsigned T_be>
+        uint32_t Bus_src_eng<T_be>::get_cnt(void)
+        {
+            return this->sig_cnt;
+        }
+
+        template <unsigned T_be>
+        bool Bus_src_eng<T_be>::get_req(void)
+        {
+            return this->sig_req;
+        }
+
+        template <unsigned T_be>
+        unsigned Bus_src_eng<T_be>::get_state(void)
+        {
+            return this->drv_state;
+        }
+
+        template <unsigned T_be>
+        unsigned Bus_src_eng<T_be>::get_drv_cnt(void)
+        {
+            return this->drv_cnt;
+        }
+
+        template <unsigned T_be>
+        unsigned Bus_src_eng<T_be>::get_cur_len(void)
+        {
+            return (this->cur_frm == nullptr) ? 0 : this->cur_frm->byte_cnt;
+        }
+
+        template <unsigned T_be>
+        unsigned Bus_src_eng<T_be>::get_nxt_len(void)
+        {
+            return (this->nxt_frm == nullptr) ? 0 : this->nxt_frm->byte_cnt;
+        }
+
+        /** \class  Bus_split
+         *  \brief  Breaks out individual signals from a Bus
+         */
+
+        template <unsigned T_be>
+        class Bus_split : public sc_module
+        {
+            public:
+                SC_HAS_PROCESS(Bus_split);
+                Bus_split(sc_module_name);
+                ~Bus_split(void);
+
+                sc_core::sc_out <uint32_t>  usr_o;
+                sc_core::sc_out <bool>      err_o;
+                sc_core::sc_out <bool>      val_o;
+                sc_core::sc_out <bool>      sof_o;
+                sc_core::sc_out <bool>      eof_o;
+                sc_core::sc_out <Mod<T_be>> mod_o;
+                sc_core::sc_out <Dat<T_be>> dat_o;
+                sc_core::sc_in  <Bus<T_be>> bus_i;
+
+                void run(void);
+        };
+
+        template <unsigned T_be>
+        Bus_split<T_be>::Bus_split(sc_module_name arg_nm)
+        {
+            SC_METHOD(run);
+            sensitive << this->bus_i;
+        }
+
+        template <unsigned T_be>
+        Bus_split<T_be>::~Bus_split(void) { }
+
+        template <unsigned T_be>
+        void Bus_split<T_be>::run(void)
+        {
+            Bus<T_be> sig_bus = this->bus_i;
+
+            this->usr_o = sig_bus.usr;
+            this->err_o = sig_bus.err;
+            this->val_o = sig_bus.val;
+            this->sof_o = sig_bus.sof;
+            this->eof_o = sig_bus.eof;
+            this->mod_o = sig_bus.mod;
+            this->dat_o = sig_bus.dat;
+        }
+
+        /** \class  Bus_split_clk
+         *  \brief  Breaks out individual signals from a Bus once per clock
+         *
+         *  Bus_split with bus_i sampled on a clock edge, the rising edge by
+         *  default, and each output written only when it's field differs from
+         *  the previous sample, so static fields such as usr and mod cost no
+         *  signal updates.  get_wr_cnt() and get_clk_cnt() count the output
+         *  writes and the samples; Bus_split makes seven writes per change of
+         *  bus_i.
+         *
+         *  The outputs lag those of Bus_split.  A bus driven on the rising
+         *  edge, as by Bus_src, is sampled on the next rising edge, so the
+         *  outputs follow one clock later; sampled on the falling edge, half
+         *  a clock later.  Logic taking the outputs must allow for the extra
+         *  cycle that Bus_split, which follows bus_i within delta cycles, does
+         *  not add.
+         */
+
+        template <unsigned T_be>
+        class Bus_split_clk : public sc_module
+        {
+            private:
+                unique_ptr<SyscMsg::Msg> msg;
+                Bus<T_be>                prv_bus;
+                bool                     first;
+                uint64_t                 wr_cnt;
+                uint64_t                 clk_cnt;
+
+            public:
+                SC_HAS_PROCESS(Bus_split_clk);
+                Bus_split_clk(sc_module_name, bool arg_neg = false);
+                ~Bus_split_clk(void);
+
+                sc_core::sc_out <uint32_t>  usr_o;
+                sc_core::sc_out <bool>      err_o;
+                sc_core::sc_out <bool>      val_o;
+                sc_core::sc_out <bool>      sof_o;
+                sc_core::sc_out <bool>      eof_o;
+                sc_core::sc_out <Mod<T_be>> mod_o;
+                sc_core::sc_out <Dat<T_be>> dat_o;
+                sc_core::sc_in  <Bus<T_be>> bus_i;
+                sc_core::sc_in  <bool>      clk_i;
+
+                void     run(void);
+                uint64_t get_wr_cnt(void);
+                uint64_t get_clk_cnt(void);
+                void     report(void);
+        };
+
+        template <unsigned T_be>
+        Bus_split_clk<T_be>::Bus_split_clk(sc_module_name arg_nm, bool arg_neg)
+        {
+            this->msg     = unique_ptr<SyscMsg::Msg>(new SyscMsg::Msg(this->name()));
+            this->prv_bus = bus_rst<T_be>();
+            this->first   = true;
+            this->wr_cnt  = 0;
+            this->clk_cnt = 0;
+
+            SC_METHOD(run);
+
+            if (arg_neg)
+            {
+                sensitive << this->clk_i.neg();
+            }
+            else
+            {
+                sensitive << this->clk_i.pos();
+            }
+
+            dont_initialize();
+        }
+
+        template <unsigned T_be>
+        Bus_split_clk<T_be>::~Bus_split_clk(void) { }
+
+        template <unsigned T_be>
+        void Bus_split_clk<T_be>::run(void)
+        {
+            Bus<T_be> sig_bus = this->bus_i;
+            Bus<T_be> & prv   = this->prv_bus;
+            bool        all   = this->first;
+
+            this->clk_cnt++;
+
+            if (all || (sig_bus.usr != prv.usr))
+            {
+                this->usr_o = sig_bus.usr;
+                this->wr_cnt++;
+            }
+
+            if (all || (sig_bus.err != prv.err))
+            {
+                this->err_o = sig_bus.err;
+                this->wr_cnt++;
+            }
+
+            if (all || (sig_bus.val != prv.val))
+            {
+                this->val_o = sig_bus.val;
+                this->wr_cnt++;
+            }
+
+            if (all || (sig_bus.sof != prv.sof))
+            {
+                this->sof_o = sig_bus.sof;
+                this->wr_cnt++;
+            }
+
+            if (all || (sig_bus.eof != prv.eof))
+            {
+                this->eof_o = sig_bus.eof;
+                this->wr_cnt++;
+            }
+
+            if (all || (sig_bus.mod != prv.mod))
+            {
+                this->mod_o = sig_bus.mod;
+                this->wr_cnt++;
+            }
+
+            if (all || (sig_bus.dat != prv.dat))
+            {
+                this->dat_o = sig_bus.dat;
+                this->wr_cnt++;
+            }
+
+            this->prv_bus = sig_bus;
+            this->first   = false;
+        }
+
+        template <unsigned T_be>
+        uint64_t Bus_split_clk<T_be>::get_wr_cnt(void)
+        {
+            return this->wr_cnt;
+        }
+
+        template <unsigned T_be>
+        uint64_t Bus_split_clk<T_be>::get_clk_cnt(void)
+        {
+            return this->clk_cnt;
+        }
+
+        template <unsigned T_be>
+        void Bus_split_clk<T_be>::report(void)
+        {
+            string       SP = SyscMsg::Chars::SP;
+            stringstream ss;
+
+            ss << fixed << setprecision(3) << ((this->clk_cnt == 0) ? 0.0 : (double(this->wr_cnt) / this->clk_cnt));
+
+            this->msg->report_inf
+            (
+                "samples" + SP + to_string(this->clk_cnt)
+                + ", output writes" + SP + to_string(this->wr_cnt)
+                + ", writes per sample" + SP + ss.str() + SP + "of 7"
+            );
+        }
+
+        /** \class  Bus_merge
+         *  \brief  Assembles a Bus from individual signals
+         *
+         *  The reverse of Bus_split, for connecting verilog module outputs.
+         *  The fields are sampled once per clock rather than on every field
+         *  change, and bus_o is written once with all of them.  By default
+         *  they are sampled on the falling edge, so the merged Bus is settled
+         *  for logic clocked on the following rising edge; with arg_neg false
+         *  they are sampled on the rising edge, which adds a clock of latency.
+         */
+
+        template <unsigned T_be>
+        class Bus_merge : public sc_module
+        {
+            public:
+                SC_HAS_PROCESS(Bus_merge);
+                Bus_merge(sc_module_name, bool arg_neg = true);
+                ~Bus_merge(void);
+
+                sc_core::sc_in  <uint32_t>  usr_i;
+                sc_core::sc_in  <bool>      err_i;
+                sc_core::sc_in  <bool>      val_i;
+                sc_core::sc_in  <bool>      sof_i;
+                sc_core::sc_in  <bool>      eof_i;
+                sc_core::sc_in  <Mod<T_be>> mod_i;
+                sc_core::sc_in  <Dat<T_be>> dat_i;
+                sc_core::sc_in  <bool>      clk_i;
+                sc_core::sc_out <Bus<T_be>> bus_o;
+
+                void run(void);
+        };
+
+        template <unsigned T_be>
+        Bus_merge<T_be>::Bus_merge(sc_module_name arg_nm, bool arg_neg)
+        {
+            SC_METHOD(run);
+
+            if (arg_neg)
+            {
+                sensitive << this->clk_i.neg();
+            }
+            else
+            {
+                sensitive << this->clk_i.pos();
+            }
+
+            dont_initialize();
+        }
+
+        template <unsigned T_be>
+        Bus_merge<T_be>::~Bus_merge(void) { }
+
+        template <unsigned T_be>
+        void Bus_merge<T_be>::run(void)
+        {
+            Bus<T_be> sig_bus;
+
+            sig_bus.usr = this->usr_i;
+            sig_bus.err = this->err_i;
+            sig_bus.val = this->val_i;
+            sig_bus.sof = this->sof_i;
+            sig_bus.eof = this->eof_i;
+            sig_bus.mod = this->mod_i;
+            sig_bus.dat = this->dat_i;
+
+            this->bus_o = sig_bus;
+        }
+
+        /** \class  Bus_mon
+         *  \brief  Passive bandwidth and inter-frame-gap monitor for a Bus
+         *
+         *  Samples bus_i and dav_i on the falling clock edge, as Checker does,
+         *  and accumulates line utilisation (valid bytes over clocks times bus
+         *  bytes), frame rate at the configured clock frequency, a frame-size
+         *  histogram and an inter-frame-gap histogram.  The gap is the number
+         *  of clocks between an eof beat and the following sof beat, so
+         *  back-to-back frames have a gap of zero.
+         *
+         *  Histogram storage is sized at construction or by set_frm_hist() and
+         *  set_ifg_hist(); the per-clock method only updates counters.  The
+         *  last bin of each histogram collects all larger values.
+         */
+
+        template <unsigned T_be>
+        class Bus_mon : public sc_module
+        {
+            private:
+                unique_ptr<SyscMsg::Msg> msg;
+                double                   clk_freq_hz;
+                uint64_t                 cyc_cnt;
+                uint64_t                 dav_cnt;
+                uint64_t                 beat_cnt;
+                uint64_t                 byte_cnt;
+                uint64_t                 frm_cnt;
+                uint64_t                 frm_len;
+                uint64_t                 gap_len;
+                bool                     in_frm;
+                bool                     in_gap;
+                unsigned                 frm_bin_bytes;
+                vector<uint64_t>         frm_hist;
+                vector<uint64_t>         ifg_hist;
+
+            public:
+                SC_HAS_PROCESS(Bus_mon);
+                Bus_mon(sc_module_name, double);
+                ~Bus_mon(void);
+
+                sc_core::sc_in  <Bus<T_be>> bus_i;
+                sc_core::sc_in  <bool>      dav_i;
+                sc_core::sc_in  <bool>      clk_i;
+
+                void     mon(void);
+                void     set_frm_hist(unsigned, unsigned);
+                void     set_ifg_hist(unsigned);
+                double   get_util(void);
+                double   get_fps(void);
+                uint64_t get_frm_cnt(void);
+                uint64_t get_byte_cnt(void);
+                const vector<uint64_t>& get_frm_hist(void);
+                const vector<uint64_t>& get_ifg_hist(void);
+                void     report(void);
+        };
+
+        template <unsigned T_be>
+        Bus_mon<T_be>::Bus_mon(sc_module_name arg_nm, double arg_hz)
+        {
+            this->msg         = unique_ptr<SyscMsg::Msg>(new SyscMsg::Msg(this->name()));
+            this->clk_freq_hz = arg_hz;
+            this->cyc_cnt     = 0;
+            this->dav_cnt     = 0;
+            this->beat_cnt    = 0;
+            this->byte_cnt    = 0;
+            this->frm_cnt     = 0;
+            this->frm_len     = 0;
+            this->gap_len     = 0;
+            this->in_frm      = false;
+            this->in_gap      = false;
+
+            this->set_frm_hist(64, 160);
+            this->set_ifg_hist(64);
+
+            SC_METHOD(mon);
+            sensitive << this->clk_i.neg();
+            dont_initialize();
+        }
+
+        template <unsigned T_be>
+        Bus_mon<T_be>::~Bus_mon(void) { }
+
+        template <unsigned T_be>
+        void Bus_mon<T_be>::set_frm_hist(unsigned arg_bin_bytes, unsigned arg_bins)
+        {
+            this->frm_bin_bytes = (arg_bin_bytes == 0) ? 1 : arg_bin_bytes;
+            this->frm_hist.assign((arg_bins == 0) ? 1 : arg_bins, 0);
+        }
+
+        template <unsigned T_be>
+        void Bus_mon<T_be>::set_ifg_hist(unsigned arg_bins)
+        {
+            this->ifg_hist.assign((arg_bins == 0) ? 1 : arg_bins, 0);
+        }
+
+        template <unsigned T_be>
+        void Bus_mon<T_be>::mon(void)
+        {
+            const Bus<T_be> & sig_bus = this->bus_i.read();
+
+            this->cyc_cnt++;
+
+            if (!this->dav_i.read())
+            {
+                if (this->in_gap) { this->gap_len++; }
+                return;
+            }
+
+            this->dav_cnt++;
+
+            if (!sig_bus.val)
+            {
+                if (this->in_gap) { this->gap_len++; }
+                return;
+            }
+
+            unsigned cnt = bus_get_byte_cnt<T_be>(sig_bus);
+
+            this->beat_cnt++;
+            this->byte_cnt += cnt;
+
+            if (sig_bus.sof)
+            {
+                if (this->in_gap)
+                {
+                    uint64_t bin = this->gap_len;
+                    uint64_t lim = this->ifg_hist.size() - 1;
+
+                    this->ifg_hist[(bin < lim) ? bin : lim]++;
+                }
+
+                this->in_frm  = true;
+                this->in_gap  = false;
+                this->frm_len = 0;
+            }
+            else if (this->in_gap)
+            {
+                this->gap_len++;
+            }
+
+            this->frm_len += cnt;
+
+            if (sig_bus.eof && this->in_frm)
+            {
+                uint64_t bin = this->frm_len / this->frm_bin_bytes;
+                uint64_t lim = this->frm_hist.size() - 1;
+
+                this->frm_hist[(bin < lim) ? bin : lim]++;
+                this->frm_cnt++;
+
+                this->in_frm  = false;
+                this->in_gap  = true;
+                this->gap_len = 0;
+            }
+        }
+
+        template <unsigned T_be>
+        double Bus_mon<T_be>::get_util(void)
+        {
+            if (this->cyc_cnt == 0)
+            {
+                return 0.0;
+            }
+
+            return double(this->byte_cnt) / (double(this->cyc_cnt) * double(1U << T_be));
+        }
+
+        template <unsigned T_be>
+        double Bus_mon<T_be>::get_fps(void)
+        {
+            if (this->cyc_cnt == 0)
+            {
+                return 0.0;
+            }
+
+            return double(this->frm_cnt) * this->clk_freq_hz / double(this->cyc_cnt);
+        }
+
+        template <unsigned T_be>
+        uint64_t Bus_mon<T_be>::get_frm_cnt(void)
+        {
+            return this->frm_cnt;
+        }
+
+        template <unsigned T_be>
+        uint64_t Bus_mon<T_be>::get_byte_cnt(void)
+        {
+            return this->byte_cnt;
+        }
+
+        template <unsigned T_be>
+        const vector<uint64_t> & Bus_mon<T_be>::get_frm_hist(void)
+        {
+            return this->frm_hist;
+        }
+
+        template <unsigned T_be>
+        const vector<uint64_t> & Bus_mon<T_be>::get_ifg_hist(void)
+        {
+            return this->ifg_hist;
+        }
+
+        template <unsigned T_be>
+        void Bus_mon<T_be>::report(void)
+        {
+            string        SP = SyscMsg::Chars::SP;
+            ostringstream os;
+
+            os << fixed << setprecision(4) << (100.0 * this->get_util());
+            this->msg->report_inf("utilisation is" + SP + os.str() + SP + "%");
+
+            os.str("");
+            os << fixed << setprecision(1) << this->get_fps();
+            this->msg->report_inf("frame rate is" + SP + os.str() + SP + "frames/s");
+
+            this->msg->report_inf
+            (
+                "clocks" + SP + to_string(this->cyc_cnt)
+                + ", dav clocks" + SP + to_string(this->dav_cnt)
+                + ", beats" + SP + to_string(this->beat_cnt)
+                + ", bytes" + SP + to_string(this->byte_cnt)
+                + ", frames" + SP + to_string(this->frm_cnt)
+            );
+
+            for (unsigned i = 0 ; i < this->frm_hist.size() ; i++)
+            {
+                if (this->frm_hist[i] == 0)
+                {
+                    continue;
+                }
+
+                unsigned lo = i * this->frm_bin_bytes;
+                string   hi = (i == this->frm_hist.size() - 1) ? string("") : to_string(lo + this->frm_bin_bytes - 1);
+
+                this->msg->report_inf
+                (
+                    "frame_len" + SP + to_string(lo) + "-" + hi + SP + to_string(this->frm_hist[i])
+                );
+            }
+
+            for (unsigned i = 0 ; i < this->ifg_hist.size() ; i++)
+            {
+                if (this->ifg_hist[i] == 0)
+                {
+                    continue;
+                }
+
+                string sfx = (i == this->ifg_hist.size() - 1) ? string("+") : string("");
+
+                this->msg->report_inf
+                (
+                    "ifg" + SP + to_string(i) + sfx + SP + to_string(this->ifg_hist[i])
+                );
+            }
+        }
+
+        /** \class  Bus_gearbox
+         *  \brief  Converts a Bus<T_in> to a Bus<T_out>
+         *
+         *  Input beats are accepted on the rising clock edge when bus_i.val and
+         *  dav_o are both set, and output beats are held until taken with dav_i
+         *  set, so back-pressure passes through.  dav_o is registered and is
+         *  set only when the byte buffer can take a whole input beat.
+         *
+         *  Beats are unpacked into and packed from the buffer with
+         *  dat_to_bytes() and dat_from_bytes(), a word at a time.  An output
+         *  beat never holds bytes of two frames.  sof marks the first output
+         *  beat of a frame and eof and mod the last.  usr of the input sof beat
+         *  is repeated on every output beat of the frame, and err on any input
+         *  beat of a frame is given on it's output eof beat.  A frame started
+         *  before the previous one ended closes the previous one with err.
+         *
+         *  step() holds the per-clock logic, so it can be used without a
+         *  simulation.
+         */
+
+        template <unsigned T_in, unsigned T_out>
+        class Bus_gearbox : public sc_module
+        {
+            private:
+                typedef struct struct_seg
+                {
+                    uint64_t end;
+                    uint32_t usr;
+                    bool     err;
+                    bool     closed;
+                    bool     started;
+                } seg;
+
+                vector<uint8_t>   ring;
+                uint64_t          ring_mask;
+                uint64_t          wr_pos;
+                uint64_t          rd_pos;
+                deque<seg>        segs;
+                Bus<T_out>        out_bus;
+                bool              in_rdy;
+
+                void push(const Bus<T_in> &);
+                bool pop(Bus<T_out> &);
+
+            public:
+                SC_HAS_PROCESS(Bus_gearbox);
+                Bus_gearbox(sc_module_name);
+                ~Bus_gearbox(void);
+
+                sc_core::sc_in  <Bus<T_in>>  bus_i;
+                sc_core::sc_out <bool>       dav_o;
+                sc_core::sc_out <Bus<T_out>> bus_o;
+                sc_core::sc_in  <bool>       dav_i;
+                sc_core::sc_in  <bool>       clk_i;
+
+                void run(void);
+                void step(const Bus<T_in> &, bool, Bus<T_out> &, bool &);
+        };
+
+        template <unsigned T_in, unsigned T_out>
+        Bus_gearbox<T_in, T_out>::Bus_gearbox(sc_module_name arg_nm)
+        {
+            uint64_t len = 1;
+
+            while (len < (2 * ((1U << T_in) + (1U << T_out))))
+            {
+                len = len << 1;
+            }
+
+            this->ring.assign(len, 0);
+            this->ring_mask = len - 1;
+            this->wr_pos    = 0;
+            this->rd_pos    = 0;
+            this->out_bus   = bus_rst<T_out>();
+            this->in_rdy    = false;
+
+            SC_METHOD(run);
+            sensitive << this->clk_i.pos();
+            dont_initialize();
+        }
+
+        template <unsigned T_in, unsigned T_out>
+        Bus_gearbox<T_in, T_out>::~Bus_gearbox(void) { }
+
+        template <unsigned T_in, unsigned T_out>
+        void Bus_gearbox<T_in, T_out>::push(const Bus<T_in> & arg_bus)
+        {
+            uint8_t  tmp[1U << T_in];
+            unsigned cnt = bus_get_byte_cnt<T_in>(arg_bus);
+            uint64_t off = this->wr_pos & this->ring_mask;
+            uint64_t fst = this->ring.size() - off;
+
+            if (arg_bus.sof || this->segs.empty() || this->segs.back().closed)
+            {
+                if (!this->segs.empty() && !this->segs.back().closed)
+                {
+                    this->segs.back().end    = this->wr_pos;
+                    this->segs.back().err    = true;
+                    this->segs.back().closed = true;
+                }
+
+                this->segs.push_back({0, arg_bus.usr, !arg_bus.sof, false, false});
+            }
+
+            dat_to_bytes<T_in>(arg_bus.dat, tmp);
+
+            if (fst >= cnt)
+            {
+                memcpy(this->ring.data() + off, tmp, cnt);
+            }
+            else
+            {
+                memcpy(this->ring.data() + off, tmp, fst);
+                memcpy(this->ring.data(), tmp + fst, cnt - fst);
+            }
+
+            this->wr_pos = this->wr_pos + cnt;
+
+            seg & cur = this->segs.back();
+
+            cur.err = cur.err || arg_bus.err;
+
+            if (arg_bus.eof)
+            {
+                cur.end    = this->wr_pos;
+                cur.closed = true;
+            }
+        }
+
+        template <unsigned T_in, unsigned T_out>
+        bool Bus_gearbox<T_in, T_out>::pop(Bus<T_out> & arg_bus)
+        {
+            uint8_t  tmp[1U << T_out];
+            unsigned max = (1U << T_out);
+
+            if (this->segs.empty())
+            {
+                return false;
+            }
+
+            seg    & cur   = this->segs.front();
+            uint64_t avail = (cur.closed ? cur.end : this->wr_pos) - this->rd_pos;
+            bool     last  = cur.closed && (avail <= max);
+
+            if (!last && (avail < max))
+            {
+                return false;
+            }
+
+            unsigned cnt = last ? avail : max;
+            uint64_t off = this->rd_pos & this->ring_mask;
+            uint64_t fst = this->ring.size() - off;
+
+            if (fst >= cnt)
+            {
+                memcpy(tmp, this->ring.data() + off, cnt);
+            }
+            else
+            {
+                memcpy(tmp, this->ring.data() + off, fst);
+                memcpy(tmp + fst, this->ring.data(), cnt - fst);
+            }
+
+            this->rd_pos = this->rd_pos + cnt;
+
+            arg_bus.usr = cur.usr;
+            arg_bus.err = last && cur.err;
+            arg_bus.val = true;
+            arg_bus.sof = !cur.started;
+            arg_bus.eof = last;
+            arg_bus.mod = (cnt == max) ? mod_rst<T_out>() : mod_set<T_out>(cnt);
+            arg_bus.dat = dat_from_bytes<T_out>(tmp, cnt);
+
+            cur.started = true;
+
+            if (last)
+            {
+                this->segs.pop_front();
+            }
+
+            return true;
+        }
+
+        /** \fn    Bus_gearbox::step()
+         *  \brief Advances one clock given the input beat and downstream dav
+         *  sampled at the edge, returning the output beat and dav_o to drive
+         */
+
+        template <unsigned T_in, unsigned T_out>
+        void Bus_gearbox<T_in, T_out>::step(const Bus<T_in> & arg_in, bool arg_dav, Bus<T_out> & arg_out, bool & arg_rdy)
+        {
+            if (this->out_bus.val && arg_dav)
+            {
+                this->out_bus = bus_rst<T_out>();
+            }
+
+            if (arg_in.val && this->in_rdy)
+            {
+                this->push(arg_in);
+            }
+
+            if (!this->out_bus.val)
+            {
+                this->pop(this->out_bus);
+            }
+
+            this->in_rdy = (this->ring.size() - (this->wr_pos - this->rd_pos)) >= (1U << T_in);
+
+            arg_out = this->out_bus;
+            arg_rdy = this->in_rdy;
+        }
+
+        template <unsigned T_in, unsigned T_out>
+        void Bus_gearbox<T_in, T_out>::run(void)
+        {
+            Bus<T_out> sig_bus = bus_rst<T_out>();
+            bool       sig_rdy = false;
+
+            this->step(this->bus_i.read(), this->dav_i.read(), sig_bus, sig_rdy);
+
+            this->bus_o = sig_bus;
+            this->dav_o = sig_rdy;
+        }
+
+        #ifndef SYSCFCBUS_HDR_ONLY
+            extern template ostream& operator<< <0>(ostream&, const Bus<0>&);
+            extern template void sc_trace<0>(sc_trace_file*, const Bus<0>&, const std::string&);
+            extern template class Bus_src_eng<0>;
+            extern template class Bus_split<0>;
+            extern template class Bus_split_clk<0>;
+            extern template class Bus_merge<0>;
+            extern template class Bus_mon<0>;
+
+            extern template ostream& operator<< <1>(ostream&, const Bus<1>&);
+            extern template void sc_trace<1>(sc_trace_file*, const Bus<1>&, const std::string&);
+            extern template class Bus_src_eng<1>;
+            extern template class Bus_split<1>;
+            extern template class Bus_split_clk<1>;
+            extern template class Bus_merge<1>;
+            extern template class Bus_mon<1>;
+
+            extern template ostream& operator<< <2>(ostream&, const Bus<2>&);
+            extern template void sc_trace<2>(sc_trace_file*, const Bus<2>&, const std::string&);
+            extern template class Bus_src_eng<2>;
+            extern template class Bus_split<2>;
+            extern template class Bus_split_clk<2>;
+            extern template class Bus_merge<2>;
+            extern template class Bus_mon<2>;
+
+            extern template ostream& operator<< <3>(ostream&, const Bus<3>&);
+            extern template void sc_trace<3>(sc_trace_file*, const Bus<3>&, const std::string&);
+            extern template class Bus_src_eng<3>;
+            extern template class Bus_split<3>;
+            extern template class Bus_split_clk<3>;
+            extern template class Bus_merge<3>;
+            extern template class Bus_mon<3>;
+
+            extern template ostream& operator<< <4>(ostream&, const Bus<4>&);
+            extern template void sc_trace<4>(sc_trace_file*, const Bus<4>&, const std::string&);
+            extern template class Bus_src_eng<4>;
+            extern template class Bus_split<4>;
+            extern template class Bus_split_clk<4>;
+            extern template class Bus_merge<4>;
+            extern template class Bus_mon<4>;
+
+            extern template ostream& operator<< <5>(ostream&, const Bus<5>&);
+            extern template void sc_trace<5>(sc_trace_file*, const Bus<5>&, const std::string&);
+            extern template class Bus_src_eng<5>;
+            extern template class Bus_split<5>;
+            extern template class Bus_split_clk<5>;
+            extern template class Bus_merge<5>;
+            extern template class Bus_mon<5>;
+
+            extern template ostream& operator<< <6>(ostream&, const Bus<6>&);
+            extern template void sc_trace<6>(sc_trace_file*, const Bus<6>&, const std::string&);
+            extern template class Bus_src_eng<6>;
+            extern template class Bus_split<6>;
+            extern template class Bus_split_clk<6>;
+            extern template class Bus_merge<6>;
+            extern template class Bus_mon<6>;
+
+            extern template ostream& operator<< <7>(ostream&, const Bus<7>&);
+            extern template void sc_trace<7>(sc_trace_file*, const Bus<7>&, const std::string&);
+            extern template class Bus_src_eng<7>;
+            extern template class Bus_split<7>;
+            extern template class Bus_split_clk<7>;
+            extern template class Bus_merge<7>;
+            extern template class Bus_mon<7>;
+
+            extern template ostream& operator<< <8>(ostream&, const Bus<8>&);
+            extern template void sc_trace<8>(sc_trace_file*, const Bus<8>&, const std::string&);
+            extern template class Bus_src_eng<8>;
+            extern template class Bus_split<8>;
+            extern template class Bus_split_clk<8>;
+            extern template class Bus_merge<8>;
+            extern template class Bus_mon<8>;
+        #endif
+    }
+#endif
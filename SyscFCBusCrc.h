@@ -0,0 +1,188 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/** \file  SyscFCBusCrc.h
+ *  \brief Declares the Ethernet CRC32 helpers and the Frm_fcs,
+ *  Frm_fcs_stream and Fcs_chk classes.
+ *
+ *  The CRC is the reflected CRC32 of IEEE 802.3, computed eight bytes at a
+ *  time from tables (slicing-by-8).  Frm_fcs and Frm_fcs_stream append the
+ *  FCS to the frames of a source; Fcs_chk checks it beat by beat.
+ */
+
+#ifndef _SYSCFCBUSCRC_H_
+    #define _SYSCFCBUSCRC_H_
+
+    #include <SyscFCBusCore.h>
+
+    namespace SyscFCBus
+    {
+        /** \var   fcs_len
+         *  \brief Byte count of the FCS
+         */
+
+        constexpr unsigned fcs_len       = 4;
+
+        /** \var   crc32_init
+         *  \brief CRC register value at the start of a frame
+         */
+
+        constexpr uint32_t crc32_init    = 0xFFFFFFFF;
+
+        /** \var   crc32_residue
+         *  \brief CRC register value after a frame and it's good FCS
+         */
+
+        constexpr uint32_t crc32_residue = 0xDEBB20E3;
+
+        uint32_t crc32_upd(uint32_t, const uint8_t *, unsigned);
+        uint32_t crc32(const uint8_t *, unsigned);
+
+        /** \class  Frm_fcs
+         *  \brief  Frame source appending the FCS to the frames of another
+         *
+         *  Each frame is copied once into one of two alternating buffers, to
+         *  meet the Frm_src validity rule, with the CRC computed over the copy
+         *  and it's complement appended least significant byte first.
+         */
+
+        class Frm_fcs : public Frm_src
+        {
+            private:
+                Frm_src           * src;
+                vector<uint8_t>     buf[2];
+                unsigned            buf_idx;
+
+            public:
+                Frm_fcs(Frm_src*);
+                ~Frm_fcs(void);
+
+                bool     get_frame(const uint8_t *&, unsigned &);
+                uint32_t get_usr(void);
+        };
+
+        /** \class  Frm_fcs_stream
+         *  \brief  Frame stream appending the FCS to the frames of another
+         *
+         *  The CRC is updated with each chunk as it is read from the source,
+         *  and the FCS is returned after the last byte of the frame, so no
+         *  frame is held or read twice.
+         */
+
+        class Frm_fcs_stream : public Frm_stream
+        {
+            private:
+                Frm_stream        * src;
+                unsigned            len;
+                unsigned            pos;
+                uint32_t            crc;
+
+            public:
+                Frm_fcs_stream(Frm_stream*);
+                ~Frm_fcs_stream(void);
+
+                bool     get_frame_len(unsigned &);
+                unsigned get_chunk(uint8_t *, unsigned);
+        };
+
+        /** \class  Fcs_chk
+         *  \brief  Checks the FCS of frames beat by beat
+         *
+         *  put() takes each beat accepted from the bus and updates the CRC
+         *  with the bytes given by mod.  At eof the CRC register, having
+         *  covered the FCS too, must equal crc32_residue; put() returns false
+         *  for a beat ending a frame whose FCS is bad.
+         */
+
+        template <unsigned T_be>
+        class Fcs_chk
+        {
+            private:
+                uint32_t crc;
+                uint64_t frm_cnt;
+                uint64_t bad_cnt;
+
+            public:
+                Fcs_chk(void);
+                ~Fcs_chk(void);
+
+                bool     put(const Bus<T_be> &);
+                uint64_t get_frm_cnt(void);
+                uint64_t get_bad_cnt(void);
+        };
+
+        template <unsigned T_be>
+        Fcs_chk<T_be>::Fcs_chk(void)
+        {
+            this->crc     = crc32_init;
+            this->frm_cnt = 0;
+            this->bad_cnt = 0;
+        }
+
+        template <unsigned T_be>
+        Fcs_chk<T_be>::~Fcs_chk(void) { }
+
+        template <unsigned T_be>
+        bool Fcs_chk<T_be>::put(const Bus<T_be> & arg_bus)
+        {
+            uint8_t tmp[1 << T_be];
+
+            if (!arg_bus.val)
+            {
+                return true;
+            }
+
+            if (arg_bus.sof)
+            {
+                this->crc = crc32_init;
+            }
+
+            dat_to_bytes<T_be>(arg_bus.dat, tmp);
+            this->crc = crc32_upd(this->crc, tmp, bus_get_byte_cnt<T_be>(arg_bus));
+
+            if (!arg_bus.eof)
+            {
+                return true;
+            }
+
+            this->frm_cnt = this->frm_cnt + 1;
+
+            if (this->crc != crc32_residue)
+            {
+                this->bad_cnt = this->bad_cnt + 1;
+                return false;
+            }
+
+            return true;
+        }
+
+        template <unsigned T_be>
+        uint64_t Fcs_chk<T_be>::get_frm_cnt(void)
+        {
+            return this->frm_cnt;
+        }
+
+        template <unsigned T_be>
+        uint64_t Fcs_chk<T_be>::get_bad_cnt(void)
+        {
+            return this->bad_cnt;
+        }
+    }
+#endif
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file  SyscFCBusGen.h
+ *  \brief Declares the Frm_gen_dot3 class.
+ */
+
+#ifndef _SYSCFCBUSGEN_H_
+    #define _SYSCFCBUSGEN_H_
+
+    #include <SyscFCBusCore.h>
+
+    namespace SyscFCBus
+    {
+        /** \class  Frm_gen_dot3
+         *  \brief  Frame stream generating 802.3 frames of increasing length
+         *
+         *  Each frame is the header CA:BB:BB:BB:BB:BB, 5A:AA:AA:AA:AA:AA and a
+         *  16-bit length field, followed by a payload whose byte i is i modulo
+         *  256.  The first payload is pay_first bytes; each following payload
+         *  is pay_step bytes longer, returning to pay_wrap after one of at least
+         *  pay_max bytes.  With (50, 1500, 1, 64) this is the sequence of
+         *  dot3_incr_len in pydrv_server.py, which the test benches use for
+         *  TB_FRAME_STREAM by wrapping to 64, or to pay_first when larger.
+         *  The frames are never stored, so any length can be generated.
+         */
+
+        class Frm_gen_dot3 : public Frm_stream
+        {
+            private:
+                unsigned pay_max;
+                unsigned pay_step;
+                unsigned pay_wrap;
+                unsigned pay_len;
+                unsigned pos;
+                bool     started;
+
+            public:
+                Frm_gen_dot3(unsigned, unsigned, unsigned, unsigned);
+                ~Frm_gen_dot3(void);
+
+                bool     get_frame_len(unsigned &);
+                unsigned get_chunk(uint8_t *, unsigned);
+        };
+    }
+#endif
@@ -0,0 +1,331 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file  SyscFCBusLog.h
+ *  \brief Declares the Log and Log_src classes and the log_err(),
+ *  log_inf() and log_dbg() functions.
+ *
+ *  Messages are filtered by level at compile time, captured without
+ *  formatting into a ring, and formatted and written by a background
+ *  thread into a buffered sink.
+ */
+
+#ifndef _SYSCFCBUSLOG_H_
+    #define _SYSCFCBUSLOG_H_
+
+    #include <atomic>
+    #include <condition_variable>
+    #include <cstdio>
+    #include <deque>
+    #include <mutex>
+    #include <sstream>
+    #include <string>
+    #include <thread>
+    #include <type_traits>
+    #include <vector>
+    #include <systemc>
+
+    /** \def   SYSCFCBUS_LOG_LEVEL
+     *  \brief Highest level of message compiled in, lvl_inf by default
+     *
+     *  Calls above this level are empty inline functions.  Setting it to 3
+     *  compiles in the lvl_dbg messages of Bus_src_eng and Frm_drv.
+     */
+
+    #ifndef SYSCFCBUS_LOG_LEVEL
+        #define SYSCFCBUS_LOG_LEVEL 2
+    #endif
+
+    namespace SyscFCBus
+    {
+        /** \enum  enum_log_lvl
+         *  \brief Levels of message, compared with SYSCFCBUS_LOG_LEVEL
+         */
+
+        enum enum_log_lvl
+        {
+            lvl_off = 0,
+            lvl_err = 1,
+            lvl_inf = 2,
+            lvl_dbg = 3
+        };
+
+        static const unsigned log_arg_max  = 6;
+        static const unsigned log_ring_len = 4096;
+
+        /** \struct Log_arg
+         *  \brief  One captured argument of a message
+         *
+         *  Numbers are held by value.  Strings, and other types by way of
+         *  their operator<<, are copied into the text of the record, and off
+         *  is their offset there.
+         */
+
+        typedef struct struct_log_arg
+        {
+            enum { kind_u, kind_i, kind_d, kind_s } kind;
+
+            union
+            {
+                uint64_t u;
+                int64_t  i;
+                double   d;
+                size_t   off;
+            };
+        } Log_arg;
+
+        /** \struct Log_rec
+         *  \brief  One captured message
+         *
+         *  fmt has the static lifetime of a string literal; each {} in it is
+         *  replaced by the next argument when the record is formatted.
+         */
+
+        typedef struct struct_log_rec
+        {
+            enum_log_lvl      lvl;
+            unsigned          src;
+            sc_core::sc_time  t;
+            const char      * fmt;
+            unsigned          argc;
+            Log_arg           arg[log_arg_max];
+            std::string       txt;
+        } Log_rec;
+
+        /** \class  Log
+         *  \brief  Ring of captured messages and the thread that drains it
+         *
+         *  There is one Log, returned by Log::get().  Records are put by one
+         *  thread, the simulation thread, and taken by the drain thread,
+         *  which wakes when the ring is half full, on flush(), or every
+         *  10 ms, formats them into a buffer and writes the buffer to the
+         *  sink, stderr unless set_path() is given a file.  A full ring holds
+         *  the putting thread until the drain thread makes room, so no
+         *  message is lost; the ring is drained when the program exits.
+         */
+
+        class Log
+        {
+            private:
+                std::vector<Log_rec>        ring;
+                std::atomic<uint64_t>       head;
+                std::atomic<uint64_t>       tail;
+                std::atomic<uint64_t>       done;
+                std::atomic<bool>           stop;
+                std::atomic<bool>           kick;
+                std::mutex                  mtx;
+                std::condition_variable     cv;
+                std::thread                 thr;
+                std::deque<std::string>     src_nm;
+                FILE                      * sink;
+                bool                        sink_own;
+                uint64_t                    put_cnt[lvl_dbg + 1];
+
+                Log(void);
+                void drain(void);
+                void write(const Log_rec &, std::string &);
+
+            public:
+                ~Log(void);
+
+                static Log & get(void);
+
+                unsigned    add_src(const std::string &);
+                void        set_path(const std::string &);
+                void        flush(void);
+                uint64_t    get_put_cnt(enum_log_lvl);
+
+                /** \fn    Log::rec_open()
+                 *  \brief Returns the record to fill next, waiting for the
+                 *  drain thread if the ring is full
+                 */
+
+                Log_rec & rec_open(void)
+                {
+                    uint64_t h = this->head.load(std::memory_order_relaxed);
+
+                    while ((h - this->tail.load(std::memory_order_acquire)) >= log_ring_len)
+                    {
+                        this->kick.store(true, std::memory_order_relaxed);
+                        this->cv.notify_one();
+                        std::this_thread::yield();
+                    }
+
+                    return this->ring[h % log_ring_len];
+                }
+
+                /** \fn    Log::rec_close()
+                 *  \brief Passes the record filled since rec_open() to the
+                 *  drain thread
+                 */
+
+                void rec_close(const Log_rec & arg_rec)
+                {
+                    uint64_t h = this->head.load(std::memory_order_relaxed) + 1;
+
+                    this->put_cnt[arg_rec.lvl] = this->put_cnt[arg_rec.lvl] + 1;
+                    this->head.store(h, std::memory_order_release);
+
+                    if ((h - this->tail.load(std::memory_order_relaxed)) == (log_ring_len / 2))
+                    {
+                        this->kick.store(true, std::memory_order_relaxed);
+                        this->cv.notify_one();
+                    }
+                }
+        };
+
+        /** \class  Log_src
+         *  \brief  Name of a source of messages, registered once with Log
+         */
+
+        class Log_src
+        {
+            private:
+                unsigned id;
+
+            public:
+                Log_src(const std::string &);
+                ~Log_src(void);
+
+                unsigned get_id(void) const { return this->id; }
+        };
+
+        /** \fn    log_arg_put()
+         *  \brief Captures one argument into a record
+         */
+
+        template <typename T>
+        typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value, void>::type
+        log_arg_put(Log_rec &, Log_arg & arg_arg, const T & arg)
+        {
+            arg_arg.kind = Log_arg::kind_u;
+            arg_arg.u    = arg;
+        }
+
+        template <typename T>
+        typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, void>::type
+        log_arg_put(Log_rec &, Log_arg & arg_arg, const T & arg)
+        {
+            arg_arg.kind = Log_arg::kind_i;
+            arg_arg.i    = arg;
+        }
+
+        template <typename T>
+        typename std::enable_if<std::is_floating_point<T>::value, void>::type
+        log_arg_put(Log_rec &, Log_arg & arg_arg, const T & arg)
+        {
+            arg_arg.kind = Log_arg::kind_d;
+            arg_arg.d    = arg;
+        }
+
+        inline void log_arg_put(Log_rec & arg_rec, Log_arg & arg_arg, const char * arg)
+        {
+            arg_arg.kind = Log_arg::kind_s;
+            arg_arg.off  = arg_rec.txt.size();
+            arg_rec.txt.append(arg);
+            arg_rec.txt.push_back('\0');
+        }
+
+        inline void log_arg_put(Log_rec & arg_rec, Log_arg & arg_arg, const std::string & arg)
+        {
+            arg_arg.kind = Log_arg::kind_s;
+            arg_arg.off  = arg_rec.txt.size();
+            arg_rec.txt.append(arg);
+            arg_rec.txt.push_back('\0');
+        }
+
+        template <typename T>
+        typename std::enable_if<!std::is_arithmetic<T>::value && !std::is_convertible<T, const char *>::value, void>::type
+        log_arg_put(Log_rec & arg_rec, Log_arg & arg_arg, const T & arg)
+        {
+            std::ostringstream os;
+
+            os << arg;
+            log_arg_put(arg_rec, arg_arg, os.str());
+        }
+
+        inline void log_args_put(Log_rec &, unsigned) { }
+
+        template <typename T, typename... T_rest>
+        void log_args_put(Log_rec & arg_rec, unsigned arg_idx, const T & arg, const T_rest & ... arg_rest)
+        {
+            log_arg_put(arg_rec, arg_rec.arg[arg_idx], arg);
+            log_args_put(arg_rec, arg_idx + 1, arg_rest...);
+        }
+
+        /** \fn    log_put()
+         *  \brief Captures a message of level T_lvl, or nothing when T_lvl is
+         *  above SYSCFCBUS_LOG_LEVEL
+         */
+
+        template <enum_log_lvl T_lvl, typename... T>
+        inline typename std::enable_if<(T_lvl > SYSCFCBUS_LOG_LEVEL), void>::type
+        log_put(const Log_src &, const char *, const T & ...) { }
+
+        template <enum_log_lvl T_lvl, typename... T>
+        inline typename std::enable_if<(T_lvl <= SYSCFCBUS_LOG_LEVEL), void>::type
+        log_put(const Log_src & arg_src, const char * arg_fmt, const T & ... arg)
+        {
+            static_assert(sizeof...(T) <= log_arg_max, "too many arguments to log_put()");
+
+            Log     & lg  = Log::get();
+            Log_rec & rec = lg.rec_open();
+
+            rec.lvl  = T_lvl;
+            rec.src  = arg_src.get_id();
+            rec.t    = sc_core::sc_time_stamp();
+            rec.fmt  = arg_fmt;
+            rec.argc = sizeof...(T);
+            rec.txt.clear();
+
+            log_args_put(rec, 0, arg...);
+            lg.rec_close(rec);
+        }
+
+        /** \fn    log_err()
+         *  \brief Captures a message of level lvl_err
+         */
+
+        template <typename... T>
+        inline void log_err(const Log_src & arg_src, const char * arg_fmt, const T & ... arg)
+        {
+            log_put<lvl_err>(arg_src, arg_fmt, arg...);
+        }
+
+        /** \fn    log_inf()
+         *  \brief Captures a message of level lvl_inf
+         */
+
+        template <typename... T>
+        inline void log_inf(const Log_src & arg_src, const char * arg_fmt, const T & ... arg)
+        {
+            log_put<lvl_inf>(arg_src, arg_fmt, arg...);
+        }
+
+        /** \fn    log_dbg()
+         *  \brief Captures a message of level lvl_dbg
+         */
+
+        template <typename... T>
+        inline void log_dbg(const Log_src & arg_src, const char * arg_fmt, const T & ... arg)
+        {
+            log_put<lvl_dbg>(arg_src, arg_fmt, arg...);
+        }
+    }
+#endif
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file  SyscFCBusSched.h
+ *  \brief Declares the Sched_bitmap and Frm_sched classes.
+ */
+
+#ifndef _SYSCFCBUSSCHED_H_
+    #define _SYSCFCBUSSCHED_H_
+
+    #include <SyscFCBusCore.h>
+
+    namespace SyscFCBus
+    {
+        /** \class  Sched_bitmap
+         *  \brief  Hierarchical bitmap with constant-time search
+         *
+         *  Each level holds one bit per 64-bit word of the level below, set
+         *  when that word is non-zero, up to a single top word.  find_next()
+         *  visits at most two words per level, so the cost is fixed by the
+         *  number of levels, four for 16M bits.
+         */
+
+        class Sched_bitmap
+        {
+            private:
+                vector<vector<uint64_t>> lvl;
+                uint64_t                 bits;
+
+                int64_t find_lvl(unsigned, uint64_t);
+
+            public:
+                Sched_bitmap(void);
+
+                void    resize(uint64_t);
+                void    set(uint64_t);
+                void    clr(uint64_t);
+                bool    get(uint64_t);
+                int64_t find_next(uint64_t);
+                bool    empty(void);
+        };
+
+        /** \class  Frm_sched
+         *  \brief  Frame source choosing among queues of frames
+         *
+         *  Each queue is a Frm_src added with add_queue(), with a weight and
+         *  a Bus.usr tag.  The mode selects the scheduler:
+         *
+         *  | mode       | choice of next frame                                 |
+         *  |------------|------------------------------------------------------|
+         *  | sched_prio | first non-exhausted queue in the order added         |
+         *  | sched_wrr  | round robin, weight frames per queue per turn        |
+         *  | sched_drr  | deficit round robin, weight bytes of credit per turn |
+         *
+         *  Queues still holding frames are kept in a Sched_bitmap, so a choice
+         *  costs the same with thousands of queues as with a few.  For DRR
+         *  this holds when the weight is no smaller than the largest frame;
+         *  smaller weights take a turn per weight of frame length.
+         *
+         *  A frame is taken from it's queue only when the scheduler needs it,
+         *  so each queue's frames stay valid as the Frm_src rule requires.
+         *  Frames and bytes sent per queue are counted for fairness checks.
+         */
+
+        class Frm_sched : public Frm_src
+        {
+            public:
+                enum enum_sched_mode
+                {
+                    sched_prio,
+                    sched_wrr,
+                    sched_drr
+                };
+
+            private:
+                typedef struct struct_queue
+                {
+                    Frm_src       * src;
+                    unsigned        weight;
+                    uint32_t        usr;
+                    const uint8_t * head_dat;
+                    unsigned        head_cnt;
+                    bool            head_val;
+                    uint64_t        credit;
+                    uint64_t        frm_cnt;
+                    uint64_t        byte_cnt;
+                } queue;
+
+                unique_ptr<SyscMsg::Msg> msg;
+                enum_sched_mode          mode;
+                vector<queue>            queues;
+                Sched_bitmap             active;
+                bool                     started;
+                uint64_t                 cur;
+                bool                     cur_new;
+                uint32_t                 usr;
+
+                bool peek(uint64_t);
+                void take(uint64_t, const uint8_t *&, unsigned &);
+                void advance(void);
+
+            public:
+                Frm_sched(const string &, enum_sched_mode);
+                ~Frm_sched(void);
+
+                unsigned add_queue(Frm_src*, unsigned, uint32_t);
+                bool     get_frame(const uint8_t *&, unsigned &);
+                uint32_t get_usr(void);
+                unsigned get_queue_cnt(void);
+                uint64_t get_frm_cnt(unsigned);
+                uint64_t get_byte_cnt(unsigned);
+        };
+    }
+#endif
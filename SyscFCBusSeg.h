@@ -0,0 +1,564 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file  SyscFCBusSeg.h
+ *  \brief Declares the Bus_seg structure, it's helpers, and the Seg_eng,
+ *  Bus_seg_src, Seg_chk, Bus_seg_chk and Bus_seg_split classes.
+ *
+ *  A Bus_seg carries several frames per beat, as in the segmented
+ *  interfaces of 400G and 800G MACs.
+ */
+
+#ifndef _SYSCFCBUSSEG_H_
+    #define _SYSCFCBUSSEG_H_
+
+    #include <SyscFCBusCore.h>
+
+    namespace SyscFCBus
+    {
+        /** \struct Bus_seg
+         *  \brief  Datapath of 2^T_be bytes split into 2^T_se segments, each
+         *  of which may start or end a frame
+         *
+         *  %Bus fields are
+         *  + val[(S-1):0]
+         *  + sof[(S-1):0]
+         *  + eof[(S-1):0]
+         *  + err[(S-1):0]
+         *  + mod[((S*(N-T_se))-1):0]
+         *  + dat[((M*8)-1):0]
+         *
+         *  Where S is 2^T_se, N is T_be and M is 2^N.  Bit s of val, sof, eof
+         *  and err belongs to segment s, and bits (s*(N-T_se)) upward of mod
+         *  hold the byte count of segment s, zero when full, as Bus.mod does
+         *  for the whole bus.  Segment 0 holds the first bytes, in the most
+         *  significant bits of dat.  A frame starts at the start of a segment
+         *  and the segment after it's last may start the next frame, so a
+         *  beat holds up to S frames.  There is no usr field.
+         */
+
+        template <unsigned T_be, unsigned T_se>
+        struct Bus_seg
+        {
+            static_assert((T_be < 9), "Bus_seg byte count out of range");
+            static_assert((T_se <= T_be) && (T_se < 6), "Bus_seg segment count out of range");
+            static_assert((((1 << T_se) * (T_be - T_se)) <= 64), "Bus_seg mod wider than 64 bits");
+
+            uint32_t  val;
+            uint32_t  sof;
+            uint32_t  eof;
+            uint32_t  err;
+            uint64_t  mod;
+            Dat<T_be> dat;
+
+            static constexpr unsigned segs      = (1 << T_se);
+            static constexpr unsigned seg_bytes = (1 << (T_be - T_se));
+            static constexpr unsigned bits_mod  = T_be - T_se;
+        };
+
+        template <unsigned T_be, unsigned T_se>
+        inline bool operator==(const Bus_seg<T_be, T_se>& l, const Bus_seg<T_be, T_se>& r)
+        {
+            if (l.val != r.val) { return false; }
+            if (l.sof != r.sof) { return false; }
+            if (l.eof != r.eof) { return false; }
+            if (l.err != r.err) { return false; }
+            if (l.mod != r.mod) { return false; }
+            if (l.dat != r.dat) { return false; }
+            return true;
+        }
+
+        template <unsigned T_be, unsigned T_se>
+        ostream& operator<<(ostream& os, const Bus_seg<T_be, T_se>& arg)
+        {
+            SCDat<T_be> scdat = arg.dat;
+
+            os << hex;
+            os << " val = 0x" << arg.val << " sof = 0x" << arg.sof << " eof = 0x" << arg.eof;
+            os << " err = 0x" << arg.err << " mod = 0x" << arg.mod << " dat = 0x" << scdat.range((8 << T_be) - 1, 0);
+            os << flush;
+
+            return os;
+        }
+
+        template <unsigned T_be, unsigned T_se>
+        void sc_trace(sc_trace_file * tf, const Bus_seg<T_be, T_se> & arg, const std::string & nm)
+        {
+            sc_trace(tf, arg.val, nm + ".val");
+            sc_trace(tf, arg.sof, nm + ".sof");
+            sc_trace(tf, arg.eof, nm + ".eof");
+            sc_trace(tf, arg.err, nm + ".err");
+            sc_trace(tf, arg.mod, nm + ".mod");
+            sc_trace(tf, arg.dat, nm + ".dat");
+        }
+
+        template <unsigned T_be, unsigned T_se>
+        Bus_seg<T_be, T_se> bus_seg_rst(void)
+        {
+            Bus_seg<T_be, T_se> ret;
+
+            ret.val = 0;
+            ret.sof = 0;
+            ret.eof = 0;
+            ret.err = 0;
+            ret.mod = 0;
+            ret.dat = 0;
+
+            return ret;
+        }
+
+        /** \fn    seg_get_byte_cnt()
+         *  \brief Returns the number of valid bytes in segment arg_seg
+         */
+
+        template <unsigned T_be, unsigned T_se>
+        unsigned seg_get_byte_cnt(const Bus_seg<T_be, T_se> & arg, unsigned arg_seg)
+        {
+            constexpr unsigned mb  = Bus_seg<T_be, T_se>::bits_mod;
+            unsigned           mod = (arg.mod >> (arg_seg * mb)) & ((1ULL << mb) - 1);
+
+            return (mod == 0) ? Bus_seg<T_be, T_se>::seg_bytes : mod;
+        }
+
+        /** \class  Seg_eng
+         *  \brief  Segmented bus source state, stepped once per clock
+         *
+         *  Packs the frames of a Frm_src into the segments of each beat,
+         *  starting each frame in the segment after the end of the previous
+         *  one, so a short frame wastes at most one segment rather than most
+         *  of a beat.  Frames are copied into the beat as they are packed and
+         *  the next frame is taken only when the current one is finished.
+         *  When the source is exhausted the remaining segments are idle.
+         */
+
+        template <unsigned T_be, unsigned T_se>
+        class Seg_eng
+        {
+            private:
+                unique_ptr<SyscMsg::Msg>   msg;
+                Frm_src                  * frm_src;
+                const uint8_t            * frm_dat;
+                unsigned                   frm_cnt;
+                unsigned                   frm_pos;
+                bool                       frm_val;
+                bool                       done;
+                Bus_seg<T_be, T_se>        sig_bus;
+                uint64_t                   sent_frm;
+                uint64_t                   sent_beat;
+
+            public:
+                Seg_eng(const string &, Frm_src*);
+                ~Seg_eng(void);
+
+                const Bus_seg<T_be, T_se>& step(bool);
+                const Bus_seg<T_be, T_se>& get_bus(void);
+                uint64_t                   get_frm_cnt(void);
+                uint64_t                   get_beat_cnt(void);
+                bool                       get_done(void);
+        };
+
+        template <unsigned T_be, unsigned T_se>
+        Seg_eng<T_be, T_se>::Seg_eng(const string & arg_nm, Frm_src * arg_src)
+        {
+            this->msg       = unique_ptr<SyscMsg::Msg>(new SyscMsg::Msg(arg_nm));
+            this->frm_src   = arg_src;
+            this->frm_dat   = nullptr;
+            this->frm_cnt   = 0;
+            this->frm_pos   = 0;
+            this->frm_val   = false;
+            this->done      = false;
+            this->sig_bus   = bus_seg_rst<T_be, T_se>();
+            this->sent_frm  = 0;
+            this->sent_beat = 0;
+        }
+
+        template <unsigned T_be, unsigned T_se>
+        Seg_eng<T_be, T_se>::~Seg_eng(void) { }
+
+        /** \fn    Seg_eng::step()
+         *  \brief Advances by one clock; when arg_dav is false the outputs are
+         *  held and nothing advances
+         */
+
+        template <unsigned T_be, unsigned T_se>
+        const Bus_seg<T_be, T_se> & Seg_eng<T_be, T_se>::step(bool arg_dav)
+        {
+            constexpr unsigned sb = Bus_seg<T_be, T_se>::seg_bytes;
+            constexpr unsigned mb = Bus_seg<T_be, T_se>::bits_mod;
+            uint8_t            tmp[1 << T_be];
+
+            if (!arg_dav)
+            {
+                return this->sig_bus;
+            }
+
+            this->sig_bus = bus_seg_rst<T_be, T_se>();
+
+            memset(tmp, 0, sizeof(tmp));
+
+            for (unsigned s = 0 ; s < Bus_seg<T_be, T_se>::segs ; s++)
+            {
+                if (!this->frm_val && !this->done)
+                {
+                    this->frm_val = this->frm_src->get_frame(this->frm_dat, this->frm_cnt);
+                    this->frm_pos = 0;
+                    this->done    = !this->frm_val;
+
+                    if (this->frm_val)
+                    {
+                        this->sig_bus.sof = this->sig_bus.sof | (1U << s);
+                    }
+                }
+
+                if (!this->frm_val)
+                {
+                    break;
+                }
+
+                unsigned cnt = ((this->frm_cnt - this->frm_pos) < sb) ? (this->frm_cnt - this->frm_pos) : sb;
+
+                memcpy(tmp + (s * sb), this->frm_dat + this->frm_pos, cnt);
+
+                this->frm_pos     = this->frm_pos + cnt;
+                this->sig_bus.val = this->sig_bus.val | (1U << s);
+
+                if (this->frm_pos == this->frm_cnt)
+                {
+                    this->sig_bus.eof = this->sig_bus.eof | (1U << s);
+                    this->sig_bus.mod = this->sig_bus.mod | (uint64_t((cnt < sb) ? cnt : 0) << (s * mb));
+                    this->frm_val     = false;
+                    this->sent_frm    = this->sent_frm + 1;
+                }
+            }
+
+            this->sig_bus.dat = dat_from_bytes<T_be>(tmp, 1 << T_be);
+            this->sent_beat   = this->sent_beat + ((this->sig_bus.val != 0) ? 1 : 0);
+
+            return this->sig_bus;
+        }
+
+        template <unsigned T_be, unsigned T_se>
+        const Bus_seg<T_be, T_se> & Seg_eng<T_be, T_se>::get_bus(void)
+        {
+            return this->sig_bus;
+        }
+
+        template <unsigned T_be, unsigned T_se>
+        uint64_t Seg_eng<T_be, T_se>::get_frm_cnt(void)
+        {
+            return this->sent_frm;
+        }
+
+        template <unsigned T_be, unsigned T_se>
+        uint64_t Seg_eng<T_be, T_se>::get_beat_cnt(void)
+        {
+            return this->sent_beat;
+        }
+
+        template <unsigned T_be, unsigned T_se>
+        bool Seg_eng<T_be, T_se>::get_done(void)
+        {
+            return this->done;
+        }
+
+        /** \class  Bus_seg_src
+         *  \brief  Segmented bus source for datapath, stepping a Seg_eng on the
+         *  rising clock edge
+         */
+
+        template <unsigned T_be, unsigned T_se>
+        class Bus_seg_src : public sc_module
+        {
+            private:
+                Seg_eng<T_be, T_se>                  eng;
+
+            public:
+                SC_HAS_PROCESS(Bus_seg_src);
+                Bus_seg_src(sc_module_name, Frm_src*);
+                ~Bus_seg_src(void);
+
+                sc_core::sc_out <Bus_seg<T_be, T_se>> bus_o;
+                sc_core::sc_in  <bool>                dav_i;
+                sc_core::sc_in  <bool>                clk_i;
+
+                void                 drive(void);
+                Seg_eng<T_be, T_se>& get_eng(void);
+        };
+
+        template <unsigned T_be, unsigned T_se>
+        Bus_seg_src<T_be, T_se>::Bus_seg_src(sc_module_name arg_nm, Frm_src * arg_src)
+            : eng(string(arg_nm) + ".eng", arg_src)
+        {
+            SC_METHOD(drive);
+            sensitive << this->clk_i.pos();
+            dont_initialize();
+        }
+
+        template <unsigned T_be, unsigned T_se>
+        Bus_seg_src<T_be, T_se>::~Bus_seg_src(void) { }
+
+        template <unsigned T_be, unsigned T_se>
+        void Bus_seg_src<T_be, T_se>::drive(void)
+        {
+            if (this->dav_i.read())
+            {
+                this->bus_o = this->eng.step(true);
+            }
+        }
+
+        template <unsigned T_be, unsigned T_se>
+        Seg_eng<T_be, T_se> & Bus_seg_src<T_be, T_se>::get_eng(void)
+        {
+            return this->eng;
+        }
+
+        /** \class  Seg_chk
+         *  \brief  Reassembles and checks the frames of a segmented bus
+         *
+         *  put() takes each beat accepted from the bus.  Frames are checked
+         *  for framing, a segment before the last of a frame must be full,
+         *  and, when a reference Frm_src is given, against the frames of the
+         *  reference in order.
+         */
+
+        template <unsigned T_be, unsigned T_se>
+        class Seg_chk
+        {
+            private:
+                unique_ptr<SyscMsg::Msg>   msg;
+                Frm_src                  * ref;
+                vector<uint8_t>            frm;
+                bool                       in_frm;
+                uint64_t                   frm_cnt;
+                uint64_t                   err_cnt;
+
+                void fail(const string &);
+
+            public:
+                Seg_chk(const string &, Frm_src*);
+                ~Seg_chk(void);
+
+                void     put(const Bus_seg<T_be, T_se> &);
+                uint64_t get_frm_cnt(void);
+                uint64_t get_err_cnt(void);
+        };
+
+        template <unsigned T_be, unsigned T_se>
+        Seg_chk<T_be, T_se>::Seg_chk(const string & arg_nm, Frm_src * arg_ref)
+        {
+            this->msg     = unique_ptr<SyscMsg::Msg>(new SyscMsg::Msg(arg_nm));
+            this->ref     = arg_ref;
+            this->in_frm  = false;
+            this->frm_cnt = 0;
+            this->err_cnt = 0;
+        }
+
+        template <unsigned T_be, unsigned T_se>
+        Seg_chk<T_be, T_se>::~Seg_chk(void) { }
+
+        template <unsigned T_be, unsigned T_se>
+        void Seg_chk<T_be, T_se>::fail(const string & arg_why)
+        {
+            string SP = SyscMsg::Chars::SP;
+
+            this->msg->cerr_err("frame" + SP + to_string(this->frm_cnt) + "," + SP + arg_why);
+            this->err_cnt = this->err_cnt + 1;
+        }
+
+        template <unsigned T_be, unsigned T_se>
+        void Seg_chk<T_be, T_se>::put(const Bus_seg<T_be, T_se> & arg_bus)
+        {
+            constexpr unsigned sb = Bus_seg<T_be, T_se>::seg_bytes;
+            uint8_t            tmp[1 << T_be];
+
+            if (arg_bus.val == 0)
+            {
+                return;
+            }
+
+            dat_to_bytes<T_be>(arg_bus.dat, tmp);
+
+            for (unsigned s = 0 ; s < Bus_seg<T_be, T_se>::segs ; s++)
+            {
+                uint32_t bit = (1U << s);
+                unsigned cnt = seg_get_byte_cnt(arg_bus, s);
+
+                if ((arg_bus.val & bit) == 0)
+                {
+                    continue;
+                }
+
+                if ((arg_bus.sof & bit) != 0)
+                {
+                    if (this->in_frm)
+                    {
+                        this->fail("sof within a frame");
+                    }
+
+                    this->frm.clear();
+                    this->in_frm = true;
+                }
+                else if (!this->in_frm)
+                {
+                    this->fail("segment outside a frame");
+                    continue;
+                }
+
+                if (((arg_bus.eof & bit) == 0) && (cnt != sb))
+                {
+                    this->fail("short segment before eof");
+                }
+
+                this->frm.insert(this->frm.end(), tmp + (s * sb), tmp + (s * sb) + cnt);
+
+                if ((arg_bus.eof & bit) == 0)
+                {
+                    continue;
+                }
+
+                if (this->ref != nullptr)
+                {
+                    const uint8_t * exp_dat = nullptr;
+                    unsigned        exp_cnt = 0;
+
+                    if (!this->ref->get_frame(exp_dat, exp_cnt))
+                    {
+                        this->fail("reference exhausted");
+                    }
+                    else if ((exp_cnt != this->frm.size()) || (memcmp(exp_dat, this->frm.data(), exp_cnt) != 0))
+                    {
+                        this->fail("miscompare");
+                    }
+                }
+
+                this->frm_cnt = this->frm_cnt + 1;
+                this->in_frm  = false;
+            }
+        }
+
+        template <unsigned T_be, unsigned T_se>
+        uint64_t Seg_chk<T_be, T_se>::get_frm_cnt(void)
+        {
+            return this->frm_cnt;
+        }
+
+        template <unsigned T_be, unsigned T_se>
+        uint64_t Seg_chk<T_be, T_se>::get_err_cnt(void)
+        {
+            return this->err_cnt;
+        }
+
+        /** \class  Bus_seg_chk
+         *  \brief  Segmented bus checker for datapath, passing the beats
+         *  accepted on each rising clock edge to a Seg_chk
+         */
+
+        template <unsigned T_be, unsigned T_se>
+        class Bus_seg_chk : public sc_module
+        {
+            private:
+                Seg_chk<T_be, T_se>                  chk;
+
+            public:
+                SC_HAS_PROCESS(Bus_seg_chk);
+                Bus_seg_chk(sc_module_name, Frm_src*);
+                ~Bus_seg_chk(void);
+
+                sc_core::sc_in  <Bus_seg<T_be, T_se>> bus_i;
+                sc_core::sc_in  <bool>                dav_i;
+                sc_core::sc_in  <bool>                clk_i;
+
+                void                 check(void);
+                Seg_chk<T_be, T_se>& get_chk(void);
+        };
+
+        template <unsigned T_be, unsigned T_se>
+        Bus_seg_chk<T_be, T_se>::Bus_seg_chk(sc_module_name arg_nm, Frm_src * arg_ref)
+            : chk(string(arg_nm), arg_ref)
+        {
+            SC_METHOD(check);
+            sensitive << this->clk_i.pos();
+            dont_initialize();
+        }
+
+        template <unsigned T_be, unsigned T_se>
+        Bus_seg_chk<T_be, T_se>::~Bus_seg_chk(void) { }
+
+        template <unsigned T_be, unsigned T_se>
+        void Bus_seg_chk<T_be, T_se>::check(void)
+        {
+            if (this->dav_i.read())
+            {
+                this->chk.put(this->bus_i.read());
+            }
+        }
+
+        template <unsigned T_be, unsigned T_se>
+        Seg_chk<T_be, T_se> & Bus_seg_chk<T_be, T_se>::get_chk(void)
+        {
+            return this->chk;
+        }
+
+        /** \class  Bus_seg_split
+         *  \brief  Breaks out individual signals from a Bus_seg
+         */
+
+        template <unsigned T_be, unsigned T_se>
+        class Bus_seg_split : public sc_module
+        {
+            public:
+                SC_HAS_PROCESS(Bus_seg_split);
+                Bus_seg_split(sc_module_name);
+                ~Bus_seg_split(void);
+
+                sc_core::sc_out <uint32_t>            val_o;
+                sc_core::sc_out <uint32_t>            sof_o;
+                sc_core::sc_out <uint32_t>            eof_o;
+                sc_core::sc_out <uint32_t>            err_o;
+                sc_core::sc_out <uint64_t>            mod_o;
+                sc_core::sc_out <Dat<T_be>>           dat_o;
+                sc_core::sc_in  <Bus_seg<T_be, T_se>> bus_i;
+
+                void run(void);
+        };
+
+        template <unsigned T_be, unsigned T_se>
+        Bus_seg_split<T_be, T_se>::Bus_seg_split(sc_module_name arg_nm)
+        {
+            SC_METHOD(run);
+            sensitive << this->bus_i;
+        }
+
+        template <unsigned T_be, unsigned T_se>
+        Bus_seg_split<T_be, T_se>::~Bus_seg_split(void) { }
+
+        template <unsigned T_be, unsigned T_se>
+        void Bus_seg_split<T_be, T_se>::run(void)
+        {
+            Bus_seg<T_be, T_se> sig_bus = this->bus_i;
+
+            this->val_o = sig_bus.val;
+            this->sof_o = sig_bus.sof;
+            this->eof_o = sig_bus.eof;
+            this->err_o = sig_bus.err;
+            this->mod_o = sig_bus.mod;
+            this->dat_o = sig_bus.dat;
+        }
+    }
+#endif
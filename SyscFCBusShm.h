@@ -0,0 +1,98 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file  SyscFCBusShm.h
+ *  \brief Declares the Frm_shm class.
+ *
+ *  Frm_shm receives frames from a generator process through a ring buffer
+ *  in POSIX shared memory.
+ */
+
+#ifndef _SYSCFCBUSSHM_H_
+    #define _SYSCFCBUSSHM_H_
+
+    #include <SyscFCBusCore.h>
+
+    namespace SyscFCBus
+    {
+        /** \class  Frm_shm
+         *  \brief  Frame source reading a shared-memory ring written by another
+         *  process
+         *
+         *  The ring is created by Frm_shm in /dev/shm and the writer process,
+         *  if one is given, is started with the ring name as it's argument.
+         *  Each frame is a 32-bit byte count followed by the frame bytes,
+         *  padded to 8 bytes, and never wraps; a count of 0xFFFFFFFF marks
+         *  padding to the end of the ring.  get_frame() returns pointers into
+         *  the ring, and the space for a frame is released only when the frame
+         *  two after it is taken, per the Frm_src validity rule, so the ring
+         *  must hold at least three of the largest frames.
+         *
+         *  Empty and full conditions are waited for with futexes on sequence
+         *  words in the ring header.  A waiter sets a flag that asks the other
+         *  side to wake it, and waits with a short timeout, so a wake lost to
+         *  the flag race costs at most the timeout.
+         *
+         *  The header layout, shared with pyshm_writer.py, is
+         *
+         *  | offset | field                                 |
+         *  |--------|---------------------------------------|
+         *  | 0      | magic, u32                            |
+         *  | 4      | version, u32                          |
+         *  | 8      | ring bytes, u64, a power of two       |
+         *  | 16     | closed by reader, u32                 |
+         *  | 20     | end of stream from writer, u32        |
+         *  | 64     | write position, u64                   |
+         *  | 72     | write sequence, u32 futex             |
+         *  | 76     | reader waiting, u32                   |
+         *  | 128    | read position, u64                    |
+         *  | 136    | read sequence, u32 futex              |
+         *  | 140    | writer waiting, u32                   |
+         *  | 256    | ring bytes                            |
+         *
+         *  Positions count bytes since creation and are reduced modulo the
+         *  ring size.  The writer relies on x86-64 store ordering when it
+         *  publishes the write position.
+         */
+
+        class Frm_shm : public Frm_src
+        {
+            private:
+                unique_ptr<SyscMsg::Msg> msg;
+                string                   shm_name;
+                uint8_t                * map;
+                uint64_t                 map_len;
+                uint64_t                 ring_len;
+                uint64_t                 rd_cur;
+                uint64_t                 rel_pos[2];
+                unsigned                 rel_cnt;
+                int                      pid;
+
+                void release(uint64_t);
+
+            public:
+                Frm_shm(const string &, const string &, uint64_t, const string &);
+                ~Frm_shm(void);
+
+                bool          get_frame(const uint8_t *&, unsigned &);
+                void          close(void);
+                const string& get_shm_name(void);
+        };
+    }
+#endif
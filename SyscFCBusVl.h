@@ -0,0 +1,290 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file  SyscFCBusVl.h
+ *  \brief Declares the classes binding a Bus to the ports of a Verilated
+ *  model.
+ *
+ *  A Verilated model's ports are public C++ members: CData, SData, IData
+ *  or QData for up to 64 bits and a VlWide array of 32-bit words, least
+ *  significant word first, for wider ports.  The classes here move Bus
+ *  beats to and from those members directly, without a sc_signal per
+ *  field.  Only the member types are used, so verilated.h need not be
+ *  included here.
+ */
+
+#ifndef _SYSCFCBUSVL_H_
+    #define _SYSCFCBUSVL_H_
+
+    #include <SyscFCBusCore.h>
+
+    namespace SyscFCBus
+    {
+        /** \fn    vl_dat_put()
+         *  \brief Copies a Bus.dat value to a Verilated port member
+         */
+
+        template <unsigned T_be, typename T_port>
+        inline typename std::enable_if<(T_be < 4U), void>::type
+        vl_dat_put(const Dat<T_be> & arg_dat, T_port & arg_port)
+        {
+            arg_port = arg_dat;
+        }
+
+        template <unsigned T_be, typename T_port>
+        inline typename std::enable_if<(T_be >= 4U), void>::type
+        vl_dat_put(const Dat<T_be> & arg_dat, T_port & arg_port)
+        {
+            for (unsigned i = 0 ; i < (Bus<T_be>::bits_dat / 32) ; i++)
+            {
+                arg_port[i] = arg_dat.get_word(i);
+            }
+        }
+
+        /** \fn    vl_dat_get()
+         *  \brief Copies a Verilated port member to a Bus.dat value
+         */
+
+        template <unsigned T_be, typename T_port>
+        inline typename std::enable_if<(T_be < 4U), void>::type
+        vl_dat_get(Dat<T_be> & arg_dat, const T_port & arg_port)
+        {
+            arg_dat = arg_port;
+        }
+
+        template <unsigned T_be, typename T_port>
+        inline typename std::enable_if<(T_be >= 4U), void>::type
+        vl_dat_get(Dat<T_be> & arg_dat, const T_port & arg_port)
+        {
+            for (unsigned i = 0 ; i < (Bus<T_be>::bits_dat / 32) ; i++)
+            {
+                arg_dat.set_word(i, arg_port[i]);
+            }
+        }
+
+        /** \class  Vl_bus_in
+         *  \brief  Writes Bus beats to the input port members of a Verilated
+         *  model
+         *
+         *  Holds pointers to the members for each field.  Any pointer may be
+         *  null when the model has no such port; mod is always null for T_be 0.
+         *  write() is called once per clock before the model is evaluated.
+         */
+
+        template <unsigned T_be, typename T_dat>
+        class Vl_bus_in
+        {
+            private:
+                uint32_t * usr;
+                uint8_t  * err;
+                uint8_t  * val;
+                uint8_t  * sof;
+                uint8_t  * eof;
+                uint8_t  * mod;
+                T_dat    * dat;
+
+            public:
+                Vl_bus_in(uint32_t*, uint8_t*, uint8_t*, uint8_t*, uint8_t*, uint8_t*, T_dat*);
+
+                void write(const Bus<T_be> &);
+        };
+
+        template <unsigned T_be, typename T_dat>
+        Vl_bus_in<T_be, T_dat>::Vl_bus_in(uint32_t * arg_usr, uint8_t * arg_err, uint8_t * arg_val, uint8_t * arg_sof, uint8_t * arg_eof, uint8_t * arg_mod, T_dat * arg_dat)
+        {
+            this->usr = arg_usr;
+            this->err = arg_err;
+            this->val = arg_val;
+            this->sof = arg_sof;
+            this->eof = arg_eof;
+            this->mod = arg_mod;
+            this->dat = arg_dat;
+        }
+
+        template <unsigned T_be, typename T_dat>
+        void Vl_bus_in<T_be, T_dat>::write(const Bus<T_be> & arg_bus)
+        {
+            if (this->usr != nullptr) { *this->usr = arg_bus.usr; }
+            if (this->err != nullptr) { *this->err = arg_bus.err; }
+            if (this->val != nullptr) { *this->val = arg_bus.val; }
+            if (this->sof != nullptr) { *this->sof = arg_bus.sof; }
+            if (this->eof != nullptr) { *this->eof = arg_bus.eof; }
+            if (this->mod != nullptr) { *this->mod = mod_get_uint<T_be>(arg_bus.mod); }
+            if (this->dat != nullptr) { vl_dat_put<T_be>(arg_bus.dat, *this->dat); }
+        }
+
+        /** \class  Vl_bus_out
+         *  \brief  Reads Bus beats from the output port members of a Verilated
+         *  model
+         *
+         *  As Vl_bus_in; fields with a null pointer read as zero.  read() is
+         *  called once per clock after the model is evaluated.
+         */
+
+        template <unsigned T_be, typename T_dat>
+        class Vl_bus_out
+        {
+            private:
+                const uint32_t * usr;
+                const uint8_t  * err;
+                const uint8_t  * val;
+                const uint8_t  * sof;
+                const uint8_t  * eof;
+                const uint8_t  * mod;
+                const T_dat    * dat;
+
+            public:
+                Vl_bus_out(const uint32_t*, const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*, const T_dat*);
+
+                Bus<T_be> read(void) const;
+        };
+
+        template <unsigned T_be, typename T_dat>
+        Vl_bus_out<T_be, T_dat>::Vl_bus_out(const uint32_t * arg_usr, const uint8_t * arg_err, const uint8_t * arg_val, const uint8_t * arg_sof, const uint8_t * arg_eof, const uint8_t * arg_mod, const T_dat * arg_dat)
+        {
+            this->usr = arg_usr;
+            this->err = arg_err;
+            this->val = arg_val;
+            this->sof = arg_sof;
+            this->eof = arg_eof;
+            this->mod = arg_mod;
+            this->dat = arg_dat;
+        }
+
+        template <unsigned T_be, typename T_dat>
+        Bus<T_be> Vl_bus_out<T_be, T_dat>::read(void) const
+        {
+            Bus<T_be> ret = bus_rst<T_be>();
+
+            if (this->usr != nullptr) { ret.usr = *this->usr;                 }
+            if (this->err != nullptr) { ret.err = (*this->err != 0);          }
+            if (this->val != nullptr) { ret.val = (*this->val != 0);          }
+            if (this->sof != nullptr) { ret.sof = (*this->sof != 0);          }
+            if (this->eof != nullptr) { ret.eof = (*this->eof != 0);          }
+            if (this->mod != nullptr) { ret.mod = mod_set<T_be>(*this->mod);  }
+            if (this->dat != nullptr) { vl_dat_get<T_be>(ret.dat, *this->dat); }
+
+            return ret;
+        }
+
+        /** \fn    make_vl_bus_in()
+         *  \brief Builds a Vl_bus_in, deducing the type of the dat member
+         */
+
+        template <unsigned T_be, typename T_dat>
+        Vl_bus_in<T_be, T_dat> make_vl_bus_in(uint32_t * arg_usr, uint8_t * arg_err, uint8_t * arg_val, uint8_t * arg_sof, uint8_t * arg_eof, uint8_t * arg_mod, T_dat * arg_dat)
+        {
+            return Vl_bus_in<T_be, T_dat>(arg_usr, arg_err, arg_val, arg_sof, arg_eof, arg_mod, arg_dat);
+        }
+
+        /** \fn    make_vl_bus_out()
+         *  \brief Builds a Vl_bus_out, deducing the type of the dat member
+         */
+
+        template <unsigned T_be, typename T_dat>
+        Vl_bus_out<T_be, T_dat> make_vl_bus_out(const uint32_t * arg_usr, const uint8_t * arg_err, const uint8_t * arg_val, const uint8_t * arg_sof, const uint8_t * arg_eof, const uint8_t * arg_mod, const T_dat * arg_dat)
+        {
+            return Vl_bus_out<T_be, T_dat>(arg_usr, arg_err, arg_val, arg_sof, arg_eof, arg_mod, arg_dat);
+        }
+
+        /** \class  Bus_vl_wr
+         *  \brief  Writes a SystemC Bus signal to a plain C++ Verilated model
+         *
+         *  Samples bus_i on the falling clock edge and writes it through a
+         *  Vl_bus_in, so the model's inputs are settled for the rising edge
+         *  at which the bench evaluates it.
+         */
+
+        template <unsigned T_be, typename T_dat>
+        class Bus_vl_wr : public sc_module
+        {
+            private:
+                Vl_bus_in<T_be, T_dat> port;
+
+            public:
+                SC_HAS_PROCESS(Bus_vl_wr);
+                Bus_vl_wr(sc_module_name, const Vl_bus_in<T_be, T_dat> &);
+                ~Bus_vl_wr(void);
+
+                sc_core::sc_in  <Bus<T_be>> bus_i;
+                sc_core::sc_in  <bool>      clk_i;
+
+                void run(void);
+        };
+
+        template <unsigned T_be, typename T_dat>
+        Bus_vl_wr<T_be, T_dat>::Bus_vl_wr(sc_module_name arg_nm, const Vl_bus_in<T_be, T_dat> & arg_port) : port(arg_port)
+        {
+            SC_METHOD(run);
+            sensitive << this->clk_i.neg();
+            dont_initialize();
+        }
+
+        template <unsigned T_be, typename T_dat>
+        Bus_vl_wr<T_be, T_dat>::~Bus_vl_wr(void) { }
+
+        template <unsigned T_be, typename T_dat>
+        void Bus_vl_wr<T_be, T_dat>::run(void)
+        {
+            this->port.write(this->bus_i.read());
+        }
+
+        /** \class  Bus_vl_rd
+         *  \brief  Drives a SystemC Bus signal from a plain C++ Verilated model
+         *
+         *  Reads the model's outputs through a Vl_bus_out on the falling clock
+         *  edge, after the model has been evaluated at the rising edge, and
+         *  writes them to bus_o as one Bus.
+         */
+
+        template <unsigned T_be, typename T_dat>
+        class Bus_vl_rd : public sc_module
+        {
+            private:
+                Vl_bus_out<T_be, T_dat> port;
+
+            public:
+                SC_HAS_PROCESS(Bus_vl_rd);
+                Bus_vl_rd(sc_module_name, const Vl_bus_out<T_be, T_dat> &);
+                ~Bus_vl_rd(void);
+
+                sc_core::sc_out <Bus<T_be>> bus_o;
+                sc_core::sc_in  <bool>      clk_i;
+
+                void run(void);
+        };
+
+        template <unsigned T_be, typename T_dat>
+        Bus_vl_rd<T_be, T_dat>::Bus_vl_rd(sc_module_name arg_nm, const Vl_bus_out<T_be, T_dat> & arg_port) : port(arg_port)
+        {
+            SC_METHOD(run);
+            sensitive << this->clk_i.neg();
+            dont_initialize();
+        }
+
+        template <unsigned T_be, typename T_dat>
+        Bus_vl_rd<T_be, T_dat>::~Bus_vl_rd(void) { }
+
+        template <unsigned T_be, typename T_dat>
+        void Bus_vl_rd<T_be, T_dat>::run(void)
+        {
+            this->bus_o = this->port.read();
+        }
+    }
+#endif
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file  SyscFCBus.cxx
+ *  \brief Explicit instantiations of the SyscFCBus templates.
+ *
+ *  Provides the instantiations for T_be 0 through 8 that SyscFCBusCore.h
+ *  and SyscFCBus.h declare extern.
+ */
+
+#include <SyscFCBus.h>
+
+namespace SyscFCBus
+{
+    template ostream& operator<< <0>(ostream&, const Bus<0>&);
+    template void sc_trace<0>(sc_trace_file*, const Bus<0>&, const std::string&);
+    template class Bus_src_eng<0>;
+    template class Bus_split<0>;
+    template class Bus_split_clk<0>;
+    template class Bus_merge<0>;
+    template class Bus_mon<0>;
+    template class Bus_src<0>;
+
+    template ostream& operator<< <1>(ostream&, const Bus<1>&);
+    template void sc_trace<1>(sc_trace_file*, const Bus<1>&, const std::string&);
+    template class Bus_src_eng<1>;
+    template class Bus_split<1>;
+    template class Bus_split_clk<1>;
+    template class Bus_merge<1>;
+    template class Bus_mon<1>;
+    template class Bus_src<1>;
+
+    template ostream& operator<< <2>(ostream&, const Bus<2>&);
+    template void sc_trace<2>(sc_trace_file*, const Bus<2>&, const std::string&);
+    template class Bus_src_eng<2>;
+    template class Bus_split<2>;
+    template class Bus_split_clk<2>;
+    template class Bus_merge<2>;
+    template class Bus_mon<2>;
+    template class Bus_src<2>;
+
+    template ostream& operator<< <3>(ostream&, const Bus<3>&);
+    template void sc_trace<3>(sc_trace_file*, const Bus<3>&, const std::string&);
+    template class Bus_src_eng<3>;
+    template class Bus_split<3>;
+    template class Bus_split_clk<3>;
+    template class Bus_merge<3>;
+    template class Bus_mon<3>;
+    template class Bus_src<3>;
+
+    template ostream& operator<< <4>(ostream&, const Bus<4>&);
+    template void sc_trace<4>(sc_trace_file*, const Bus<4>&, const std::string&);
+    template class Bus_src_eng<4>;
+    template class Bus_split<4>;
+    template class Bus_split_clk<4>;
+    template class Bus_merge<4>;
+    template class Bus_mon<4>;
+    template class Bus_src<4>;
+
+    template ostream& operator<< <5>(ostream&, const Bus<5>&);
+    template void sc_trace<5>(sc_trace_file*, const Bus<5>&, const std::string&);
+    template class Bus_src_eng<5>;
+    template class Bus_split<5>;
+    template class Bus_split_clk<5>;
+    template class Bus_merge<5>;
+    template class Bus_mon<5>;
+    template class Bus_src<5>;
+
+    template ostream& operator<< <6>(ostream&, const Bus<6>&);
+    template void sc_trace<6>(sc_trace_file*, const Bus<6>&, const std::string&);
+    template class Bus_src_eng<6>;
+    template class Bus_split<6>;
+    template class Bus_split_clk<6>;
+    template class Bus_merge<6>;
+    template class Bus_mon<6>;
+    template class Bus_src<6>;
+
+    template ostream& operator<< <7>(ostream&, const Bus<7>&);
+    template void sc_trace<7>(sc_trace_file*, const Bus<7>&, const std::string&);
+    template class Bus_src_eng<7>;
+    template class Bus_split<7>;
+    template class Bus_split_clk<7>;
+    template class Bus_merge<7>;
+    template class Bus_mon<7>;
+    template class Bus_src<7>;
+
+    template ostream& operator<< <8>(ostream&, const Bus<8>&);
+    template void sc_trace<8>(sc_trace_file*, const Bus<8>&, const std::string&);
+    template class Bus_src_eng<8>;
+    template class Bus_split<8>;
+    template class Bus_split_clk<8>;
+    template class Bus_merge<8>;
+    template class Bus_mon<8>;
+    template class Bus_src<8>;
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file  SyscFCBusArray.cxx
+ *  \brief Defines the Frm_store and Frm_cursor classes.
+ */
+
+#include <SyscFCBusArray.h>
+
+namespace SyscFCBus
+{
+    static uint64_t store_hash(const uint8_t * arg_dat, unsigned arg_cnt)
+    {
+        uint64_t ret = 0xcbf29ce484222325ULL;
+
+        for (unsigned i = 0 ; i < arg_cnt ; i++)
+        {
+            ret = (ret ^ arg_dat[i]) * 0x100000001b3ULL;
+        }
+
+        return ret ^ arg_cnt;
+    }
+
+    Frm_store::Frm_store(const string & arg_nm, Frm_src * arg_src)
+    {
+        this->msg       = unique_ptr<SyscMsg::Msg>(new SyscMsg::Msg(arg_nm));
+        this->src       = arg_src;
+        this->base      = 0;
+        this->dup_cnt   = 0;
+        this->exhausted = false;
+    }
+
+    Frm_store::~Frm_store(void) { }
+
+    /** \fn    Frm_store::get()
+     *  \brief Returns frame arg_idx of the source, taking frames from the
+     *  source up to it if needed; returns false past the end of the source
+     */
+
+    bool Frm_store::get(uint64_t arg_idx, const uint8_t *& arg_dat, unsigned & arg_cnt)
+    {
+        string SP = SyscMsg::Chars::SP;
+
+        if (arg_idx < this->base)
+        {
+            this->msg->cerr_err("frame" + SP + to_string(arg_idx) + SP + "already trimmed");
+            throw "Frm_store instance" + SP + this->msg->get_str_c_msgid() + SP + "get() frame already trimmed";
+        }
+
+        while (!this->exhausted && ((arg_idx - this->base) >= this->frames.size()))
+        {
+            const uint8_t * dat = nullptr;
+            unsigned        cnt = 0;
+
+            if (!this->src->get_frame(dat, cnt))
+            {
+                this->exhausted = true;
+                break;
+            }
+
+            entry ent;
+
+            ent.hash = store_hash(dat, cnt);
+
+            auto it = this->live.find(ent.hash);
+
+            if (it != this->live.end())
+            {
+                ent.buf = it->second.lock();
+            }
+
+            if (ent.buf && (ent.buf->size() == cnt) && (memcmp(ent.buf->data(), dat, cnt) == 0))
+            {
+                this->dup_cnt++;
+            }
+            else
+            {
+                ent.buf = make_shared<const vector<uint8_t>>(dat, dat + cnt);
+                this->live[ent.hash] = ent.buf;
+            }
+
+            this->frames.push_back(ent);
+        }
+
+        if ((arg_idx - this->base) >= this->frames.size())
+        {
+            return false;
+        }
+
+        const vector<uint8_t> & buf = *this->frames[arg_idx - this->base].buf;
+
+        arg_dat = buf.data();
+        arg_cnt = buf.size();
+
+        return true;
+    }
+
+    /** \fn    Frm_store::trim()
+     *  \brief Releases the frames before frame arg_idx
+     */
+
+    void Frm_store::trim(uint64_t arg_idx)
+    {
+        while ((this->base < arg_idx) && !this->frames.empty())
+        {
+            entry & ent = this->frames.front();
+
+            if (ent.buf.use_count() == 1)
+            {
+                this->live.erase(ent.hash);
+            }
+
+            this->frames.pop_front();
+            this->base++;
+        }
+    }
+
+    uint64_t Frm_store::get_held(void)
+    {
+        return this->frames.size();
+    }
+
+    uint64_t Frm_store::get_dup_cnt(void)
+    {
+        return this->dup_cnt;
+    }
+
+    Frm_cursor::Frm_cursor(Frm_store * arg_store)
+    {
+        this->store = arg_store;
+        this->pos   = 0;
+    }
+
+    Frm_cursor::~Frm_cursor(void) { }
+
+    bool Frm_cursor::get_frame(const uint8_t *& arg_dat, unsigned & arg_cnt)
+    {
+        if (!this->store->get(this->pos, arg_dat, arg_cnt))
+        {
+            return false;
+        }
+
+        this->pos++;
+
+        return true;
+    }
+
+    uint64_t Frm_cursor::get_pos(void)
+    {
+        return this->pos;
+    }
+}
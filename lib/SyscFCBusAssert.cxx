@@ -0,0 +1,114 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/** \file  SyscFCBusAssert.cxx
+ *  \brief Defines the Bus_rules class.
+ */
+
+#include <SyscFCBusAssert.h>
+
+namespace SyscFCBus
+{
+    static const uint8_t st_out = 0;
+    static const uint8_t st_frm = 1;
+    static const uint8_t st_err = 2;
+
+    /** \fn    bus_rule_str()
+     *  \brief Returns a description of a rule for messages
+     */
+
+    const char * bus_rule_str(enum_bus_rule arg_rule)
+    {
+        switch (arg_rule)
+        {
+            case rule_ok:          { return "no rule broken";           }
+            case rule_sof_in_frm:  { return "sof within a frame";       }
+            case rule_beat_out_frm: { return "beat outside a frame";     }
+            case rule_err_dropped: { return "err dropped before eof";   }
+            case rule_mod_not_eof: { return "mod non-zero before eof";  }
+            case rule_gap_in_frm:  { return "gap within a frame";       }
+            default:               { return "unknown rule";             }
+        }
+    }
+
+    /** \fn    Bus_rules::Bus_rules()
+     *  \brief Builds the table, each entry holding the next state in bits
+     *  1:0 and the rule broken above them
+     */
+
+    Bus_rules::Bus_rules(bool arg_gap, bool arg_part)
+    {
+        for (uint8_t st = st_out ; st <= st_err ; st++)
+        {
+            for (unsigned ctl = 0 ; ctl < ctl_LAST ; ctl++)
+            {
+                bool    val  = (ctl & ctl_val) != 0;
+                bool    sof  = (ctl & ctl_sof) != 0;
+                bool    eof  = (ctl & ctl_eof) != 0;
+                bool    err  = (ctl & ctl_err) != 0;
+                bool    mod  = (ctl & ctl_mod) != 0;
+                bool    in   = (st != st_out);
+                uint8_t rule = rule_ok;
+                uint8_t nxt  = st;
+
+                if (val && sof && in)
+                {
+                    rule = rule_sof_in_frm;
+                }
+                else if (val && !sof && !in)
+                {
+                    rule = rule_beat_out_frm;
+                }
+                else if (val && (st == st_err) && !err)
+                {
+                    rule = rule_err_dropped;
+                }
+                else if (val && mod && !eof && !arg_part)
+                {
+                    rule = rule_mod_not_eof;
+                }
+                else if (!val && in && !arg_gap)
+                {
+                    rule = rule_gap_in_frm;
+                }
+
+                if (val && (eof || (!sof && !in)))
+                {
+                    nxt = st_out;
+                }
+                else if (val)
+                {
+                    nxt = err ? st_err : st_frm;
+                }
+
+                this->tab[st][ctl] = (rule << 2) | nxt;
+            }
+        }
+
+        this->state = st_out;
+    }
+
+    Bus_rules::~Bus_rules(void) { }
+
+    bool Bus_rules::get_in_frm(void)
+    {
+        return (this->state != st_out);
+    }
+}
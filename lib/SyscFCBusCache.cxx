@@ -0,0 +1,272 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file  SyscFCBusCache.cxx
+ *  \brief Defines the Frm_cache class.
+ */
+
+#include <cstddef>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <SyscFCBusCache.h>
+
+namespace SyscFCBus
+{
+    static const char     cache_magic[8] = { 'S', 'y', 's', 'c', 'F', 'C', 'B', 'C' };
+    static const uint32_t cache_version  = 1;
+
+    Frm_cache::Frm_cache(const string & arg_nm, const string & arg_dir, const string & arg_dh, const string & arg_dr)
+    {
+        uint64_t      hash = 0xCBF29CE484222325ULL;
+        ostringstream os;
+
+        this->msg     = unique_ptr<SyscMsg::Msg>(new SyscMsg::Msg(arg_nm));
+        this->key     = arg_dh + '\n' + arg_dr;
+        this->mode    = cache_off;
+        this->src     = nullptr;
+        this->fp      = nullptr;
+        this->map     = nullptr;
+        this->map_len = 0;
+        this->map_pos = 0;
+        this->frm_cnt = 0;
+
+        for (unsigned i = 0 ; i < this->key.size() ; i++)
+        {
+            hash = (hash ^ uint8_t(this->key[i])) * 0x100000001B3ULL;
+        }
+
+        os << arg_dir << "/" << hex << setw(16) << setfill('0') << hash << ".fcbc";
+        this->path = os.str();
+    }
+
+    Frm_cache::~Frm_cache(void)
+    {
+        this->close();
+    }
+
+    /** \fn    Frm_cache::open_replay()
+     *  \brief Maps the cache file for replay
+     *
+     *  Returns false, leaving the cache closed, when there is no complete
+     *  cache file for the handler and request, or when it holds fewer than
+     *  arg_min frames.
+     */
+
+    bool Frm_cache::open_replay(uint64_t arg_min)
+    {
+        string       SP  = SyscMsg::Chars::SP;
+        int          fd  = ::open(this->path.c_str(), O_RDONLY);
+        struct stat  st;
+        void       * ptr = MAP_FAILED;
+        cache_hdr    hdr;
+
+        this->close();
+
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        if ((fstat(fd, &st) == 0) && (size_t(st.st_size) >= sizeof(hdr)))
+        {
+            ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+
+        ::close(fd);
+
+        if (ptr == MAP_FAILED)
+        {
+            return false;
+        }
+
+        this->map     = static_cast<const uint8_t *>(ptr);
+        this->map_len = st.st_size;
+
+        memcpy(&hdr, this->map, sizeof(hdr));
+
+        if
+        (
+            (memcmp(hdr.magic, cache_magic, sizeof(cache_magic)) != 0)
+            || (hdr.version != cache_version)
+            || (hdr.frm_cnt == 0)
+            || (hdr.key_len != this->key.size())
+            || (this->map_len < sizeof(hdr) + hdr.key_len)
+            || (memcmp(this->map + sizeof(hdr), this->key.data(), hdr.key_len) != 0)
+        )
+        {
+            this->msg->report_inf("ignoring stale or incomplete cache file" + SP + this->path);
+            this->close();
+            return false;
+        }
+
+        if (hdr.frm_cnt < arg_min)
+        {
+            this->msg->report_inf
+            (
+                "ignoring cache file" + SP + this->path + SP + "of" + SP + to_string(hdr.frm_cnt)
+                + SP + "frames, fewer than the" + SP + to_string(arg_min) + SP + "needed"
+            );
+            this->close();
+            return false;
+        }
+
+        this->map_pos = sizeof(hdr) + hdr.key_len;
+        this->frm_cnt = hdr.frm_cnt;
+        this->mode    = cache_replay;
+
+        this->msg->report_inf("replaying" + SP + to_string(this->frm_cnt) + SP + "frames from" + SP + this->path);
+
+        return true;
+    }
+
+    /** \fn    Frm_cache::open_record()
+     *  \brief Starts a new cache file recording the frames of arg_src
+     */
+
+    void Frm_cache::open_record(Frm_src * arg_src)
+    {
+        string    SP  = SyscMsg::Chars::SP;
+        cache_hdr hdr;
+
+        this->close();
+
+        this->tmp_path = this->path + "." + to_string(getpid());
+        this->fp       = fopen(this->tmp_path.c_str(), "wb");
+
+        if (this->fp == nullptr)
+        {
+            this->msg->cerr_err("cannot create cache file" + SP + this->tmp_path);
+            throw "Frm_cache instance" + SP + this->msg->get_str_c_msgid() + SP + "open_record() cannot create" + SP + this->tmp_path;
+        }
+
+        memcpy(hdr.magic, cache_magic, sizeof(cache_magic));
+        hdr.version = cache_version;
+        hdr.key_len = this->key.size();
+        hdr.frm_cnt = 0;
+
+        fwrite(&hdr, sizeof(hdr), 1, this->fp);
+        fwrite(this->key.data(), 1, this->key.size(), this->fp);
+
+        this->src     = arg_src;
+        this->frm_cnt = 0;
+        this->mode    = cache_record;
+
+        this->msg->report_inf("recording frames to" + SP + this->path);
+    }
+
+    /** \fn    Frm_cache::close()
+     *  \brief Completes a recording or releases a replay mapping
+     *
+     *  A recording is written under a process-specific name and renamed over
+     *  the cache file only once complete, so concurrent tests recording the
+     *  same frames never leave a mixed file.
+     */
+
+    void Frm_cache::close(void)
+    {
+        if (this->fp != nullptr)
+        {
+            fseek(this->fp, offsetof(cache_hdr, frm_cnt), SEEK_SET);
+            fwrite(&this->frm_cnt, sizeof(this->frm_cnt), 1, this->fp);
+            fclose(this->fp);
+
+            if (this->frm_cnt != 0)
+            {
+                rename(this->tmp_path.c_str(), this->path.c_str());
+            }
+            else
+            {
+                unlink(this->tmp_path.c_str());
+            }
+
+            this->fp = nullptr;
+        }
+
+        if (this->map != nullptr)
+        {
+            munmap(const_cast<uint8_t *>(this->map), this->map_len);
+            this->map     = nullptr;
+            this->map_len = 0;
+            this->map_pos = 0;
+        }
+
+        this->mode = cache_off;
+    }
+
+    bool Frm_cache::get_frame(const uint8_t *& arg_dat, unsigned & arg_cnt)
+    {
+        uint32_t len = 0;
+
+        switch (this->mode)
+        {
+            case cache_replay:
+            {
+                if (this->map_pos + sizeof(len) > this->map_len)
+                {
+                    return false;
+                }
+
+                memcpy(&len, this->map + this->map_pos, sizeof(len));
+
+                if (this->map_pos + sizeof(len) + len > this->map_len)
+                {
+                    return false;
+                }
+
+                arg_dat       = this->map + this->map_pos + sizeof(len);
+                arg_cnt       = len;
+                this->map_pos = this->map_pos + sizeof(len) + len;
+
+                return true;
+            }
+            case cache_record:
+            {
+                if (!this->src->get_frame(arg_dat, arg_cnt))
+                {
+                    return false;
+                }
+
+                len = arg_cnt;
+
+                fwrite(&len, sizeof(len), 1, this->fp);
+                fwrite(arg_dat, 1, arg_cnt, this->fp);
+
+                this->frm_cnt++;
+
+                return true;
+            }
+            default:
+            {
+                return false;
+            }
+        }
+    }
+
+    uint64_t Frm_cache::get_frm_cnt(void)
+    {
+        return this->frm_cnt;
+    }
+
+    const string & Frm_cache::get_path(void)
+    {
+        return this->path;
+    }
+}
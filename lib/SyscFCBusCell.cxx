@@ -0,0 +1,275 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file  SyscFCBusCell.cxx
+ *  \brief Defines the cell helpers and the Cell_sched class.
+ */
+
+#include <SyscFCBusCell.h>
+
+namespace SyscFCBus
+{
+    /** \fn    cell_hec()
+     *  \brief Returns the HEC of the first four header bytes, the CRC-8 of
+     *  x^8 + x^2 + x + 1 xored with 0x55 as in I.432
+     */
+
+    uint8_t cell_hec(const uint8_t * arg_hdr)
+    {
+        static uint8_t tab[256];
+        static bool    tab_val = false;
+        uint8_t        crc     = 0;
+
+        if (!tab_val)
+        {
+            for (unsigned i = 0 ; i < 256 ; i++)
+            {
+                uint8_t c = i;
+
+                for (unsigned b = 0 ; b < 8 ; b++)
+                {
+                    c = (c & 0x80) ? ((c << 1) ^ 0x07) : (c << 1);
+                }
+
+                tab[i] = c;
+            }
+
+            tab_val = true;
+        }
+
+        for (unsigned i = 0 ; i < 4 ; i++)
+        {
+            crc = tab[crc ^ arg_hdr[i]];
+        }
+
+        return crc ^ 0x55;
+    }
+
+    /** \fn    cell_hdr()
+     *  \brief Writes the five byte NNI header for Bus.usr value arg_usr
+     */
+
+    void cell_hdr(uint32_t arg_usr, uint8_t * arg_hdr)
+    {
+        uint32_t vpi = (arg_usr >> 16) & 0xFFF;
+        uint32_t vci = arg_usr & 0xFFFF;
+        uint32_t ptc = (arg_usr >> 28) & 0xF;
+
+        arg_hdr[0] = vpi >> 4;
+        arg_hdr[1] = ((vpi & 0xF) << 4) | (vci >> 12);
+        arg_hdr[2] = (vci >> 4) & 0xFF;
+        arg_hdr[3] = ((vci & 0xF) << 4) | ptc;
+        arg_hdr[4] = cell_hec(arg_hdr);
+    }
+
+    /** \fn    cell_usr()
+     *  \brief Returns the Bus.usr value of a five byte NNI header
+     */
+
+    uint32_t cell_usr(const uint8_t * arg_hdr)
+    {
+        uint32_t vpi = (uint32_t(arg_hdr[0]) << 4) | (arg_hdr[1] >> 4);
+        uint32_t vci = (uint32_t(arg_hdr[1] & 0xF) << 12) | (uint32_t(arg_hdr[2]) << 4) | (arg_hdr[3] >> 4);
+        uint32_t ptc = arg_hdr[3] & 0xF;
+
+        return (ptc << 28) | (vpi << 16) | vci;
+    }
+
+    /** \fn    cell_pay()
+     *  \brief Writes the 48 byte payload of cell arg_seq of a circuit, the
+     *  sequence number followed by a pattern of the circuit and sequence
+     */
+
+    void cell_pay(uint32_t arg_usr, uint32_t arg_seq, uint8_t * arg_pay)
+    {
+        uint8_t base = (arg_seq * 7) + (arg_usr >> 16) + arg_usr;
+
+        arg_pay[0] = arg_seq >> 24;
+        arg_pay[1] = arg_seq >> 16;
+        arg_pay[2] = arg_seq >> 8;
+        arg_pay[3] = arg_seq;
+
+        for (unsigned i = 4 ; i < 48 ; i++)
+        {
+            arg_pay[i] = base + i;
+        }
+    }
+
+    /** \fn    Cell_sched::Cell_sched()
+     *  \brief Builds a wheel of arg_slots cell times, rounded up to a power
+     *  of two, which must exceed the longest period
+     */
+
+    Cell_sched::Cell_sched(const string & arg_nm, unsigned arg_slots)
+    {
+        uint64_t slots = 2;
+
+        while (slots < arg_slots)
+        {
+            slots = slots << 1;
+        }
+
+        this->msg      = unique_ptr<SyscMsg::Msg>(new SyscMsg::Msg(arg_nm));
+        this->mask     = slots - 1;
+        this->now      = 0;
+        this->rdy_head = -1;
+        this->rdy_tail = -1;
+
+        this->slot_head.assign(slots, -1);
+        this->slot_tail.assign(slots, -1);
+    }
+
+    Cell_sched::~Cell_sched(void) { }
+
+    void Cell_sched::slot_put(unsigned arg_vc, uint64_t arg_due)
+    {
+        uint64_t s = arg_due & this->mask;
+
+        this->vcs[arg_vc].due = arg_due;
+        this->vcs[arg_vc].nxt = -1;
+
+        if (this->slot_tail[s] < 0)
+        {
+            this->slot_head[s] = arg_vc;
+        }
+        else
+        {
+            this->vcs[this->slot_tail[s]].nxt = arg_vc;
+        }
+
+        this->slot_tail[s] = arg_vc;
+    }
+
+    /** \fn    Cell_sched::add_vc()
+     *  \brief Adds a circuit sending a cell every arg_period cell times with
+     *  Bus.usr value arg_usr, the first arg_phase cell times from now;
+     *  returns the circuit number
+     *
+     *  Spreading the phases of circuits of one period avoids sending their
+     *  cells in bursts.
+     */
+
+    unsigned Cell_sched::add_vc(uint32_t arg_usr, unsigned arg_period, unsigned arg_phase)
+    {
+        string   SP  = SyscMsg::Chars::SP;
+        unsigned idx = this->vcs.size();
+        vc       v;
+
+        if (idx >= vc_max)
+        {
+            this->msg->cerr_err("more than" + SP + to_string(vc_max) + SP + "circuits");
+            throw "Cell_sched instance" + SP + this->msg->get_str_c_msgid() + SP + "add_vc() too many circuits";
+        }
+
+        if ((arg_period == 0) || (arg_period > this->mask))
+        {
+            this->msg->cerr_err("period" + SP + to_string(arg_period) + SP + "outside the wheel");
+            throw "Cell_sched instance" + SP + this->msg->get_str_c_msgid() + SP + "add_vc() period outside the wheel";
+        }
+
+        v.usr    = arg_usr;
+        v.period = arg_period;
+        v.seq    = 0;
+
+        cell_hdr(arg_usr, v.hdr);
+
+        this->vcs.push_back(v);
+        this->slot_put(idx, this->now + (arg_phase % arg_period));
+
+        return idx;
+    }
+
+    /** \fn    Cell_sched::next()
+     *  \brief Advances one cell time; returns false for an idle cell time,
+     *  otherwise true with the circuit of the cell in arg_vc
+     */
+
+    bool Cell_sched::next(unsigned & arg_vc)
+    {
+        uint64_t s = this->now & this->mask;
+
+        if (this->slot_head[s] >= 0)
+        {
+            if (this->rdy_tail < 0)
+            {
+                this->rdy_head = this->slot_head[s];
+            }
+            else
+            {
+                this->vcs[this->rdy_tail].nxt = this->slot_head[s];
+            }
+
+            this->rdy_tail     = this->slot_tail[s];
+            this->slot_head[s] = -1;
+            this->slot_tail[s] = -1;
+        }
+
+        this->now = this->now + 1;
+
+        if (this->rdy_head < 0)
+        {
+            return false;
+        }
+
+        vc     & v   = this->vcs[this->rdy_head];
+        uint64_t due = v.due + v.period;
+
+        arg_vc         = this->rdy_head;
+        this->rdy_head = v.nxt;
+
+        if (this->rdy_head < 0)
+        {
+            this->rdy_tail = -1;
+        }
+
+        this->slot_put(arg_vc, (due < this->now) ? this->now : due);
+
+        return true;
+    }
+
+    uint32_t Cell_sched::get_usr(unsigned arg_vc)
+    {
+        return this->vcs[arg_vc].usr;
+    }
+
+    const uint8_t * Cell_sched::get_hdr(unsigned arg_vc)
+    {
+        return this->vcs[arg_vc].hdr;
+    }
+
+    /** \fn    Cell_sched::take_seq()
+     *  \brief Returns the sequence number for the next cell of a circuit and
+     *  advances it
+     */
+
+    uint32_t Cell_sched::take_seq(unsigned arg_vc)
+    {
+        return this->vcs[arg_vc].seq++;
+    }
+
+    uint32_t Cell_sched::get_seq(unsigned arg_vc)
+    {
+        return this->vcs[arg_vc].seq;
+    }
+
+    unsigned Cell_sched::get_vc_cnt(void)
+    {
+        return this->vcs.size();
+    }
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/** \file  SyscFCBusCrc.cxx
+ *  \brief Defines the CRC32 helpers and the Frm_fcs and Frm_fcs_stream
+ *  classes.
+ */
+
+#include <SyscFCBusCrc.h>
+
+namespace SyscFCBus
+{
+    /** \class  Crc32_tab
+     *  \brief  Slicing-by-8 tables for the reflected polynomial 0xEDB88320
+     *
+     *  Table k gives the CRC of a byte followed by k zero bytes.
+     */
+
+    class Crc32_tab
+    {
+        public:
+            uint32_t t[8][256];
+
+            Crc32_tab(void)
+            {
+                for (unsigned i = 0 ; i < 256 ; i++)
+                {
+                    uint32_t c = i;
+
+                    for (unsigned j = 0 ; j < 8 ; j++)
+                    {
+                        c = (c & 1) ? ((c >> 1) ^ 0xEDB88320) : (c >> 1);
+                    }
+
+                    this->t[0][i] = c;
+                }
+
+                for (unsigned k = 1 ; k < 8 ; k++)
+                {
+                    for (unsigned i = 0 ; i < 256 ; i++)
+                    {
+                        uint32_t c = this->t[k - 1][i];
+
+                        this->t[k][i] = (c >> 8) ^ this->t[0][c & 0xFF];
+                    }
+                }
+            }
+    };
+
+    static inline uint32_t crc32_le32(const uint8_t * arg_ptr)
+    {
+        return
+            (static_cast<uint32_t>(arg_ptr[0])      ) |
+            (static_cast<uint32_t>(arg_ptr[1]) <<  8) |
+            (static_cast<uint32_t>(arg_ptr[2]) << 16) |
+            (static_cast<uint32_t>(arg_ptr[3]) << 24);
+    }
+
+    /** \fn    crc32_upd()
+     *  \brief Updates the CRC register with arg_cnt bytes
+     *
+     *  No initial value or final complement is applied, so a frame may be
+     *  given in pieces of any size.
+     */
+
+    uint32_t crc32_upd(uint32_t arg_crc, const uint8_t * arg_ptr, unsigned arg_cnt)
+    {
+        static const Crc32_tab tab;
+
+        const uint32_t (&t)[8][256] = tab.t;
+        uint32_t          crc       = arg_crc;
+
+        for ( ; arg_cnt >= 8 ; arg_cnt -= 8, arg_ptr += 8)
+        {
+            uint32_t a = crc ^ crc32_le32(arg_ptr);
+            uint32_t b = crc32_le32(arg_ptr + 4);
+
+            crc = t[7][a & 0xFF] ^ t[6][(a >> 8) & 0xFF] ^ t[5][(a >> 16) & 0xFF] ^ t[4][a >> 24]
+                ^ t[3][b & 0xFF] ^ t[2][(b >> 8) & 0xFF] ^ t[1][(b >> 16) & 0xFF] ^ t[0][b >> 24];
+        }
+
+        for ( ; arg_cnt > 0 ; arg_cnt--, arg_ptr++)
+        {
+            crc = t[0][(crc ^ *arg_ptr) & 0xFF] ^ (crc >> 8);
+        }
+
+        return crc;
+    }
+
+    /** \fn    crc32()
+     *  \brief Returns the CRC32 of arg_cnt bytes, which is the FCS value
+     */
+
+    uint32_t crc32(const uint8_t * arg_ptr, unsigned arg_cnt)
+    {
+        return ~crc32_upd(crc32_init, arg_ptr, arg_cnt);
+    }
+
+    Frm_fcs::Frm_fcs(Frm_src * arg_src)
+    {
+        this->src     = arg_src;
+        this->buf_idx = 0;
+    }
+
+    Frm_fcs::~Frm_fcs(void) { }
+
+    bool Frm_fcs::get_frame(const uint8_t *& arg_dat, unsigned & arg_cnt)
+    {
+        const uint8_t   * dat = nullptr;
+        unsigned          cnt = 0;
+        vector<uint8_t> & frm = this->buf[this->buf_idx];
+
+        if (!this->src->get_frame(dat, cnt))
+        {
+            return false;
+        }
+
+        frm.resize(cnt + fcs_len);
+        memcpy(frm.data(), dat, cnt);
+
+        uint32_t fcs = crc32(frm.data(), cnt);
+
+        for (unsigned i = 0 ; i < fcs_len ; i++)
+        {
+            frm[cnt + i] = (fcs >> (8 * i)) & 0xFF;
+        }
+
+        arg_dat       = frm.data();
+        arg_cnt       = frm.size();
+        this->buf_idx = this->buf_idx ^ 1;
+
+        return true;
+    }
+
+    uint32_t Frm_fcs::get_usr(void)
+    {
+        return this->src->get_usr();
+    }
+
+    Frm_fcs_stream::Frm_fcs_stream(Frm_stream * arg_src)
+    {
+        this->src = arg_src;
+        this->len = 0;
+        this->pos = 0;
+        this->crc = crc32_init;
+    }
+
+    Frm_fcs_stream::~Frm_fcs_stream(void) { }
+
+    bool Frm_fcs_stream::get_frame_len(unsigned & arg_len)
+    {
+        if (!this->src->get_frame_len(this->len))
+        {
+            return false;
+        }
+
+        this->pos = 0;
+        this->crc = crc32_init;
+        arg_len   = this->len + fcs_len;
+
+        return true;
+    }
+
+    unsigned Frm_fcs_stream::get_chunk(uint8_t * arg_buf, unsigned arg_max)
+    {
+        unsigned cnt = 0;
+
+        if (this->pos < this->len)
+        {
+            cnt       = this->src->get_chunk(arg_buf, min(arg_max, this->len - this->pos));
+            this->crc = crc32_upd(this->crc, arg_buf, cnt);
+            this->pos = this->pos + cnt;
+
+            if (this->pos < this->len)
+            {
+                return cnt;
+            }
+        }
+
+        for ( ; (cnt < arg_max) && (this->pos < (this->len + fcs_len)) ; cnt++, this->pos++)
+        {
+            arg_buf[cnt] = (~this->crc >> (8 * (this->pos - this->len))) & 0xFF;
+        }
+
+        return cnt;
+    }
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file  SyscFCBusGen.cxx
+ *  \brief Defines the Frm_gen_dot3 class.
+ */
+
+#include <SyscFCBusGen.h>
+
+namespace SyscFCBus
+{
+    static const unsigned dot3_hdr_len = 14;
+
+    Frm_gen_dot3::Frm_gen_dot3(unsigned arg_first, unsigned arg_max, unsigned arg_step, unsigned arg_wrap)
+    {
+        this->pay_max   = arg_max;
+        this->pay_step  = arg_step;
+        this->pay_wrap  = arg_wrap;
+        this->pay_len   = arg_first;
+        this->pos       = 0;
+        this->started   = false;
+    }
+
+    Frm_gen_dot3::~Frm_gen_dot3(void) { }
+
+    bool Frm_gen_dot3::get_frame_len(unsigned & arg_len)
+    {
+        if (!this->started)
+        {
+            this->started = true;
+        }
+        else if (this->pay_len >= this->pay_max)
+        {
+            this->pay_len = this->pay_wrap;
+        }
+        else
+        {
+            this->pay_len = this->pay_len + this->pay_step;
+        }
+
+        this->pos = 0;
+        arg_len   = dot3_hdr_len + this->pay_len;
+
+        return true;
+    }
+
+    unsigned Frm_gen_dot3::get_chunk(uint8_t * arg_buf, unsigned arg_max)
+    {
+        unsigned frm_len = dot3_hdr_len + this->pay_len;
+        unsigned cnt     = frm_len - this->pos;
+
+        if (cnt > arg_max)
+        {
+            cnt = arg_max;
+        }
+
+        for (unsigned i = 0 ; i < cnt ; i++, this->pos++)
+        {
+            uint8_t byte = 0;
+
+            if (this->pos >= dot3_hdr_len)
+            {
+                byte = (this->pos - dot3_hdr_len) & 0xFF;
+            }
+            else if (this->pos == 12)
+            {
+                byte = (this->pay_len >> 8) & 0xFF;
+            }
+            else if (this->pos == 13)
+            {
+                byte = this->pay_len & 0xFF;
+            }
+            else if (this->pos >= 6)
+            {
+                byte = (this->pos == 6) ? 0x5A : 0xAA;
+            }
+            else
+            {
+                byte = (this->pos == 0) ? 0xCA : 0xBB;
+            }
+
+            arg_buf[i] = byte;
+        }
+
+        return cnt;
+    }
+}
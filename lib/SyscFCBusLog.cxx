@@ -0,0 +1,248 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/** \file  SyscFCBusLog.cxx
+ *  \brief Defines the Log and Log_src classes.
+ */
+
+#include <chrono>
+#include <SyscFCBusLog.h>
+
+namespace SyscFCBus
+{
+    static const size_t log_buf_len = 65536;
+
+    Log::Log(void) : ring(log_ring_len)
+    {
+        this->head     = 0;
+        this->tail     = 0;
+        this->done     = 0;
+        this->stop     = false;
+        this->kick     = false;
+        this->sink     = stderr;
+        this->sink_own = false;
+
+        for (unsigned i = 0 ; i <= lvl_dbg ; i++)
+        {
+            this->put_cnt[i] = 0;
+        }
+
+        this->thr = std::thread(&Log::drain, this);
+    }
+
+    Log::~Log(void)
+    {
+        {
+            std::lock_guard<std::mutex> lk(this->mtx);
+
+            this->stop = true;
+        }
+
+        this->cv.notify_one();
+        this->thr.join();
+
+        if (this->sink_own)
+        {
+            fclose(this->sink);
+        }
+    }
+
+    /** \fn    Log::get()
+     *  \brief Returns the Log, starting the drain thread on first use
+     */
+
+    Log & Log::get(void)
+    {
+        static Log lg;
+
+        return lg;
+    }
+
+    /** \fn    Log::add_src()
+     *  \brief Registers the name of a source and returns it's id
+     */
+
+    unsigned Log::add_src(const std::string & arg_nm)
+    {
+        std::lock_guard<std::mutex> lk(this->mtx);
+
+        this->src_nm.push_back(arg_nm);
+
+        return this->src_nm.size() - 1;
+    }
+
+    /** \fn    Log::set_path()
+     *  \brief Sends the messages not yet written to the file at arg_path,
+     *  or to stderr if arg_path is empty
+     */
+
+    void Log::set_path(const std::string & arg_path)
+    {
+        FILE * fp = stderr;
+
+        this->flush();
+
+        if (arg_path != "")
+        {
+            fp = fopen(arg_path.c_str(), "w");
+        }
+
+        if (fp == nullptr)
+        {
+            throw "Log cannot open " + arg_path;
+        }
+
+        std::lock_guard<std::mutex> lk(this->mtx);
+
+        if (this->sink_own)
+        {
+            fclose(this->sink);
+        }
+
+        this->sink     = fp;
+        this->sink_own = (fp != stderr);
+    }
+
+    /** \fn    Log::flush()
+     *  \brief Waits until every message put so far is written to the sink
+     */
+
+    void Log::flush(void)
+    {
+        uint64_t h = this->head.load(std::memory_order_relaxed);
+
+        while (this->done.load(std::memory_order_acquire) < h)
+        {
+            this->kick.store(true, std::memory_order_relaxed);
+            this->cv.notify_one();
+            std::this_thread::yield();
+        }
+    }
+
+    /** \fn    Log::get_put_cnt()
+     *  \brief Returns the number of messages put at a level
+     */
+
+    uint64_t Log::get_put_cnt(enum_log_lvl arg_lvl)
+    {
+        return this->put_cnt[arg_lvl];
+    }
+
+    /** \fn    Log::write()
+     *  \brief Formats a record as one line appended to arg_out
+     */
+
+    void Log::write(const Log_rec & arg_rec, std::string & arg_out)
+    {
+        static const char * lvl_str[] = { "[OFF]", "[ERR]", "[INF]", "[DBG]" };
+
+        std::ostringstream os;
+        unsigned           idx = 0;
+
+        os << arg_rec.t << " " << lvl_str[arg_rec.lvl] << " " << this->src_nm[arg_rec.src] << " ";
+
+        for (const char * p = arg_rec.fmt ; *p != '\0' ; p++)
+        {
+            if ((p[0] != '{') || (p[1] != '}') || (idx >= arg_rec.argc))
+            {
+                os << *p;
+                continue;
+            }
+
+            const Log_arg & arg = arg_rec.arg[idx];
+
+            switch (arg.kind)
+            {
+                case Log_arg::kind_u: { os << arg.u;                          break; }
+                case Log_arg::kind_i: { os << arg.i;                          break; }
+                case Log_arg::kind_d: { os << arg.d;                          break; }
+                case Log_arg::kind_s: { os << (arg_rec.txt.data() + arg.off); break; }
+            }
+
+            idx = idx + 1;
+            p   = p + 1;
+        }
+
+        os << '\n';
+        arg_out.append(os.str());
+    }
+
+    /** \fn    Log::drain()
+     *  \brief Body of the drain thread
+     */
+
+    void Log::drain(void)
+    {
+        std::string out;
+        bool        fin = false;
+
+        out.reserve(log_buf_len);
+
+        while (true)
+        {
+            uint64_t t = this->tail.load(std::memory_order_relaxed);
+            uint64_t h = this->head.load(std::memory_order_acquire);
+
+            {
+                std::lock_guard<std::mutex> lk(this->mtx);
+
+                fin = this->stop;
+
+                for ( ; t != h ; t++)
+                {
+                    this->write(this->ring[t % log_ring_len], out);
+                    this->tail.store(t + 1, std::memory_order_release);
+
+                    if (out.size() >= log_buf_len)
+                    {
+                        fwrite(out.data(), 1, out.size(), this->sink);
+                        out.clear();
+                    }
+                }
+
+                if (out.size() != 0)
+                {
+                    fwrite(out.data(), 1, out.size(), this->sink);
+                    fflush(this->sink);
+                    out.clear();
+                }
+            }
+
+            this->done.store(t, std::memory_order_release);
+
+            if (fin && (this->head.load(std::memory_order_acquire) == t))
+            {
+                break;
+            }
+
+            std::unique_lock<std::mutex> lk(this->mtx);
+
+            this->cv.wait_for(lk, std::chrono::milliseconds(10), [this] { return this->kick.load() || this->stop.load(); });
+            this->kick = false;
+        }
+    }
+
+    Log_src::Log_src(const std::string & arg_nm)
+    {
+        this->id = Log::get().add_src(arg_nm);
+    }
+
+    Log_src::~Log_src(void) { }
+}
@@ -0,0 +1,314 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file  SyscFCBusSched.cxx
+ *  \brief Defines the Sched_bitmap and Frm_sched classes.
+ */
+
+#include <SyscFCBusSched.h>
+
+namespace SyscFCBus
+{
+    Sched_bitmap::Sched_bitmap(void)
+    {
+        this->resize(0);
+    }
+
+    /** \fn    Sched_bitmap::resize()
+     *  \brief Sizes the bitmap for arg_bits bits, all clear
+     */
+
+    void Sched_bitmap::resize(uint64_t arg_bits)
+    {
+        uint64_t words = (arg_bits + 63) / 64;
+
+        this->bits = arg_bits;
+        this->lvl.clear();
+
+        do
+        {
+            words = (words == 0) ? 1 : words;
+            this->lvl.push_back(vector<uint64_t>(words, 0));
+            words = (words + 63) / 64;
+        }
+        while (this->lvl.back().size() > 1);
+    }
+
+    void Sched_bitmap::set(uint64_t arg_idx)
+    {
+        for (unsigned i = 0 ; i < this->lvl.size() ; i++)
+        {
+            uint64_t & word = this->lvl[i][arg_idx >> 6];
+            bool       was  = (word != 0);
+
+            word    = word | (1ULL << (arg_idx & 63));
+            arg_idx = arg_idx >> 6;
+
+            if (was)
+            {
+                break;
+            }
+        }
+    }
+
+    void Sched_bitmap::clr(uint64_t arg_idx)
+    {
+        for (unsigned i = 0 ; i < this->lvl.size() ; i++)
+        {
+            uint64_t & word = this->lvl[i][arg_idx >> 6];
+
+            word    = word & ~(1ULL << (arg_idx & 63));
+            arg_idx = arg_idx >> 6;
+
+            if (word != 0)
+            {
+                break;
+            }
+        }
+    }
+
+    bool Sched_bitmap::get(uint64_t arg_idx)
+    {
+        return ((this->lvl[0][arg_idx >> 6] >> (arg_idx & 63)) & 1) != 0;
+    }
+
+    bool Sched_bitmap::empty(void)
+    {
+        return this->lvl.back()[0] == 0;
+    }
+
+    int64_t Sched_bitmap::find_lvl(unsigned arg_lvl, uint64_t arg_idx)
+    {
+        vector<uint64_t> & words = this->lvl[arg_lvl];
+        uint64_t           w     = arg_idx >> 6;
+
+        if (w >= words.size())
+        {
+            return -1;
+        }
+
+        uint64_t m = words[w] & (~0ULL << (arg_idx & 63));
+
+        if (m != 0)
+        {
+            return (w << 6) | __builtin_ctzll(m);
+        }
+
+        if ((arg_lvl + 1) == this->lvl.size())
+        {
+            return -1;
+        }
+
+        int64_t up = this->find_lvl(arg_lvl + 1, w + 1);
+
+        if (up < 0)
+        {
+            return -1;
+        }
+
+        return (uint64_t(up) << 6) | __builtin_ctzll(words[up]);
+    }
+
+    /** \fn    Sched_bitmap::find_next()
+     *  \brief Returns the first set bit at or after arg_idx, or -1
+     */
+
+    int64_t Sched_bitmap::find_next(uint64_t arg_idx)
+    {
+        if (arg_idx >= this->bits)
+        {
+            return -1;
+        }
+
+        return this->find_lvl(0, arg_idx);
+    }
+
+    Frm_sched::Frm_sched(const string & arg_nm, enum_sched_mode arg_mode)
+    {
+        this->msg     = unique_ptr<SyscMsg::Msg>(new SyscMsg::Msg(arg_nm));
+        this->mode    = arg_mode;
+        this->started = false;
+        this->cur     = 0;
+        this->cur_new = true;
+        this->usr     = 0;
+    }
+
+    Frm_sched::~Frm_sched(void) { }
+
+    /** \fn    Frm_sched::add_queue()
+     *  \brief Adds a queue with a weight, frames per turn for WRR or bytes
+     *  per turn for DRR, and the Bus.usr tag of it's frames; returns the
+     *  queue number
+     */
+
+    unsigned Frm_sched::add_queue(Frm_src * arg_src, unsigned arg_weight, uint32_t arg_usr)
+    {
+        string SP = SyscMsg::Chars::SP;
+        queue  q  = {arg_src, (arg_weight == 0) ? 1 : arg_weight, arg_usr, nullptr, 0, false, 0, 0, 0};
+
+        if (this->started)
+        {
+            this->msg->cerr_err("queue added after the first frame");
+            throw "Frm_sched instance" + SP + this->msg->get_str_c_msgid() + SP + "add_queue() after the first frame";
+        }
+
+        this->queues.push_back(q);
+
+        return this->queues.size() - 1;
+    }
+
+    /** \fn    Frm_sched::peek()
+     *  \brief Makes sure queue arg_q holds it's next frame; returns false, and
+     *  drops the queue from the active set, when it is exhausted
+     */
+
+    bool Frm_sched::peek(uint64_t arg_q)
+    {
+        queue & q = this->queues[arg_q];
+
+        if (!q.head_val)
+        {
+            q.head_val = q.src->get_frame(q.head_dat, q.head_cnt);
+
+            if (!q.head_val)
+            {
+                this->active.clr(arg_q);
+            }
+        }
+
+        return q.head_val;
+    }
+
+    void Frm_sched::take(uint64_t arg_q, const uint8_t *& arg_dat, unsigned & arg_cnt)
+    {
+        queue & q = this->queues[arg_q];
+
+        arg_dat    = q.head_dat;
+        arg_cnt    = q.head_cnt;
+        q.head_val = false;
+        q.frm_cnt  = q.frm_cnt + 1;
+        q.byte_cnt = q.byte_cnt + q.head_cnt;
+        this->usr  = q.usr;
+    }
+
+    void Frm_sched::advance(void)
+    {
+        int64_t nxt = this->active.find_next(this->cur + 1);
+
+        if (nxt < 0)
+        {
+            nxt = this->active.find_next(0);
+        }
+
+        this->cur     = (nxt < 0) ? 0 : nxt;
+        this->cur_new = true;
+    }
+
+    bool Frm_sched::get_frame(const uint8_t *& arg_dat, unsigned & arg_cnt)
+    {
+        if (!this->started)
+        {
+            this->started = true;
+            this->active.resize(this->queues.size());
+
+            for (unsigned i = 0 ; i < this->queues.size() ; i++)
+            {
+                this->active.set(i);
+            }
+
+            this->cur = 0;
+        }
+
+        while (!this->active.empty())
+        {
+            if (this->mode == sched_prio)
+            {
+                int64_t q = this->active.find_next(0);
+
+                if (this->peek(q))
+                {
+                    this->take(q, arg_dat, arg_cnt);
+                    return true;
+                }
+
+                continue;
+            }
+
+            if (!this->active.get(this->cur))
+            {
+                this->advance();
+                continue;
+            }
+
+            queue & q = this->queues[this->cur];
+
+            if (this->cur_new)
+            {
+                q.credit      = (this->mode == sched_wrr) ? q.weight : (q.credit + q.weight);
+                this->cur_new = false;
+            }
+
+            if (!this->peek(this->cur))
+            {
+                q.credit = 0;
+                this->advance();
+                continue;
+            }
+
+            uint64_t cost = (this->mode == sched_wrr) ? 1 : q.head_cnt;
+
+            if (q.credit >= cost)
+            {
+                q.credit = q.credit - cost;
+                this->take(this->cur, arg_dat, arg_cnt);
+
+                if (q.credit == 0)
+                {
+                    this->advance();
+                }
+
+                return true;
+            }
+
+            this->advance();
+        }
+
+        return false;
+    }
+
+    uint32_t Frm_sched::get_usr(void)
+    {
+        return this->usr;
+    }
+
+    unsigned Frm_sched::get_queue_cnt(void)
+    {
+        return this->queues.size();
+    }
+
+    uint64_t Frm_sched::get_frm_cnt(unsigned arg_q)
+    {
+        return this->queues[arg_q].frm_cnt;
+    }
+
+    uint64_t Frm_sched::get_byte_cnt(unsigned arg_q)
+    {
+        return this->queues[arg_q].byte_cnt;
+    }
+}
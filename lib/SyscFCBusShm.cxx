@@ -0,0 +1,279 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file  SyscFCBusShm.cxx
+ *  \brief Defines the Frm_shm class.
+ */
+
+#include <climits>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <SyscFCBusShm.h>
+
+namespace SyscFCBus
+{
+    static const uint32_t shm_magic       = 0x53464342;
+    static const uint32_t shm_version     = 1;
+    static const uint32_t shm_pad         = 0xFFFFFFFF;
+    static const unsigned shm_off_magic   = 0;
+    static const unsigned shm_off_version = 4;
+    static const unsigned shm_off_size    = 8;
+    static const unsigned shm_off_closed  = 16;
+    static const unsigned shm_off_eos     = 20;
+    static const unsigned shm_off_wr_pos  = 64;
+    static const unsigned shm_off_wr_seq  = 72;
+    static const unsigned shm_off_wr_wait = 76;
+    static const unsigned shm_off_rd_pos  = 128;
+    static const unsigned shm_off_rd_seq  = 136;
+    static const unsigned shm_off_rd_wait = 140;
+    static const unsigned shm_off_data    = 256;
+    static const long     shm_wait_ns     = 1000000;
+
+    static inline uint32_t * shm_u32(uint8_t * arg_map, unsigned arg_off)
+    {
+        return reinterpret_cast<uint32_t *>(arg_map + arg_off);
+    }
+
+    static inline uint64_t * shm_u64(uint8_t * arg_map, unsigned arg_off)
+    {
+        return reinterpret_cast<uint64_t *>(arg_map + arg_off);
+    }
+
+    static void futex_wait(uint32_t * arg_addr, uint32_t arg_val)
+    {
+        struct timespec ts = { 0, shm_wait_ns };
+
+        syscall(SYS_futex, arg_addr, FUTEX_WAIT, arg_val, &ts, nullptr, 0);
+    }
+
+    static void futex_wake(uint32_t * arg_addr)
+    {
+        syscall(SYS_futex, arg_addr, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+    /** \fn    Frm_shm::Frm_shm()
+     *  \brief Creates the ring arg_shm of arg_len bytes and, unless arg_wr is
+     *  empty, starts the writer process arg_wr
+     */
+
+    Frm_shm::Frm_shm(const string & arg_nm, const string & arg_shm, uint64_t arg_len, const string & arg_wr)
+    {
+        string SP  = SyscMsg::Chars::SP;
+        int    fd  = -1;
+        void * ptr = MAP_FAILED;
+
+        this->msg      = unique_ptr<SyscMsg::Msg>(new SyscMsg::Msg(arg_nm));
+        this->shm_name = (arg_shm[0] == '/') ? arg_shm : ("/" + arg_shm);
+        this->map      = nullptr;
+        this->ring_len = 64;
+        this->rd_cur   = 0;
+        this->rel_cnt  = 0;
+        this->pid      = -1;
+
+        while (this->ring_len < arg_len)
+        {
+            this->ring_len = this->ring_len << 1;
+        }
+
+        this->map_len = shm_off_data + this->ring_len;
+
+        shm_unlink(this->shm_name.c_str());
+
+        fd = shm_open(this->shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+
+        if ((fd >= 0) && (ftruncate(fd, this->map_len) == 0))
+        {
+            ptr = mmap(nullptr, this->map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+
+        if (ptr == MAP_FAILED)
+        {
+            shm_unlink(this->shm_name.c_str());
+            this->msg->cerr_err("cannot create shared memory" + SP + this->shm_name);
+            throw "Frm_shm instance" + SP + this->msg->get_str_c_msgid() + SP + "cannot create" + SP + this->shm_name;
+        }
+
+        this->map = static_cast<uint8_t *>(ptr);
+
+        *shm_u32(this->map, shm_off_version) = shm_version;
+        *shm_u64(this->map, shm_off_size)    = this->ring_len;
+
+        __atomic_store_n(shm_u32(this->map, shm_off_magic), shm_magic, __ATOMIC_RELEASE);
+
+        if (arg_wr.empty())
+        {
+            return;
+        }
+
+        string wr_name = this->shm_name.substr(1);
+        char * argv[]  = { const_cast<char *>(arg_wr.c_str()), const_cast<char *>(wr_name.c_str()), nullptr };
+
+        if (posix_spawn(&this->pid, arg_wr.c_str(), nullptr, nullptr, argv, environ) != 0)
+        {
+            this->pid = -1;
+            this->close();
+            this->msg->cerr_err("cannot start frame writer" + SP + arg_wr);
+            throw "Frm_shm instance" + SP + this->msg->get_str_c_msgid() + SP + "cannot start" + SP + arg_wr;
+        }
+
+        this->msg->report_inf("started frame writer" + SP + arg_wr + SP + wr_name);
+    }
+
+    Frm_shm::~Frm_shm(void)
+    {
+        this->close();
+    }
+
+    /** \fn    Frm_shm::close()
+     *  \brief Tells the writer the reader is gone, waits for it to exit and
+     *  removes the ring
+     */
+
+    void Frm_shm::close(void)
+    {
+        if (this->map == nullptr)
+        {
+            return;
+        }
+
+        __atomic_store_n(shm_u32(this->map, shm_off_closed), 1, __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(shm_u32(this->map, shm_off_rd_seq), 1, __ATOMIC_SEQ_CST);
+        futex_wake(shm_u32(this->map, shm_off_rd_seq));
+
+        if (this->pid > 0)
+        {
+            int status = 0;
+
+            if (waitpid(this->pid, &status, WNOHANG) == 0)
+            {
+                usleep(100000);
+
+                if (waitpid(this->pid, &status, WNOHANG) == 0)
+                {
+                    kill(this->pid, SIGTERM);
+                    waitpid(this->pid, &status, 0);
+                }
+            }
+
+            this->pid = -1;
+        }
+
+        munmap(this->map, this->map_len);
+        shm_unlink(this->shm_name.c_str());
+
+        this->map = nullptr;
+    }
+
+    void Frm_shm::release(uint64_t arg_pos)
+    {
+        __atomic_store_n(shm_u64(this->map, shm_off_rd_pos), arg_pos, __ATOMIC_RELEASE);
+        __atomic_add_fetch(shm_u32(this->map, shm_off_rd_seq), 1, __ATOMIC_SEQ_CST);
+
+        if (__atomic_exchange_n(shm_u32(this->map, shm_off_rd_wait), 0, __ATOMIC_SEQ_CST) != 0)
+        {
+            futex_wake(shm_u32(this->map, shm_off_rd_seq));
+        }
+    }
+
+    bool Frm_shm::get_frame(const uint8_t *& arg_dat, unsigned & arg_cnt)
+    {
+        uint64_t * wr_pos  = shm_u64(this->map, shm_off_wr_pos);
+        uint32_t * wr_seq  = shm_u32(this->map, shm_off_wr_seq);
+        uint32_t * wr_wait = shm_u32(this->map, shm_off_wr_wait);
+        uint32_t * eos     = shm_u32(this->map, shm_off_eos);
+        uint8_t  * data    = this->map + shm_off_data;
+
+        if (this->rel_cnt == 2)
+        {
+            this->release(this->rel_pos[0]);
+            this->rel_pos[0] = this->rel_pos[1];
+            this->rel_cnt    = 1;
+        }
+
+        while (true)
+        {
+            if (__atomic_load_n(wr_pos, __ATOMIC_ACQUIRE) != this->rd_cur)
+            {
+                uint64_t off = this->rd_cur & (this->ring_len - 1);
+                uint32_t len = 0;
+
+                memcpy(&len, data + off, sizeof(len));
+
+                if (len == shm_pad)
+                {
+                    this->rd_cur = this->rd_cur + (this->ring_len - off);
+                    continue;
+                }
+
+                arg_dat      = data + off + sizeof(len);
+                arg_cnt      = len;
+                this->rd_cur = this->rd_cur + ((sizeof(len) + len + 7) & ~uint64_t(7));
+
+                this->rel_pos[this->rel_cnt] = this->rd_cur;
+                this->rel_cnt++;
+
+                return true;
+            }
+
+            if (__atomic_load_n(eos, __ATOMIC_ACQUIRE) != 0)
+            {
+                if (__atomic_load_n(wr_pos, __ATOMIC_ACQUIRE) == this->rd_cur)
+                {
+                    return false;
+                }
+
+                continue;
+            }
+
+            uint32_t seq = __atomic_load_n(wr_seq, __ATOMIC_ACQUIRE);
+
+            __atomic_store_n(wr_wait, 1, __ATOMIC_SEQ_CST);
+
+            if (__atomic_load_n(wr_pos, __ATOMIC_ACQUIRE) != this->rd_cur)
+            {
+                continue;
+            }
+
+            futex_wait(wr_seq, seq);
+
+            if ((this->pid > 0) && (waitpid(this->pid, nullptr, WNOHANG) == this->pid))
+            {
+                this->pid = -1;
+                this->msg->report_inf("frame writer exited without end of stream");
+                __atomic_store_n(eos, 1, __ATOMIC_RELEASE);
+            }
+        }
+    }
+
+    const string & Frm_shm::get_shm_name(void)
+    {
+        return this->shm_name;
+    }
+}
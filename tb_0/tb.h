@@ -22,11 +22,18 @@
 #ifndef _TB_H_
     #define _TB_H_
 
+    #include <chrono>
+    #include <fstream>
+    #include <unistd.h>
     #include <systemc>
     #include <SyscClk.h>
     #include <SyscDrv.h>
     #include <SyscFCBus.h>
-    #include "cfg_be.h"
+    #include <SyscFCBusCache.h>
+    #include <SyscFCBusShm.h>
+    #include <SyscFCBusGen.h>
+    #include <SyscFCBusCrc.h>
+    #include <SyscFCBusAssert.h>
 
     using namespace std;
     using namespace sc_core;
@@ -37,27 +44,56 @@
     using namespace SyscMsg;
     using namespace SyscMsg::Chars;
 
+    template <unsigned T_be>
     class Checker : public sc_module
     {
         private:
             unique_ptr<Msg>      msg;
-            Bus_src<be>        * bus;
+            Log_src              lg;
+            Bus_src<T_be>      * bus;
+            Frm_stream         * ref;
             bool                 pass;
             unsigned             count;
+            bool                 part;
+            bool                 fcs;
+            bool                 inj;
+            bool                 soak;
+            uint64_t             soak_cnt;
+            uint64_t             soak_every;
+            string               soak_path;
+            uint64_t             stat_frm;
+            uint64_t             stat_byte;
+            uint64_t             stat_bad;
+            uint64_t             stat_fail;
+            uint64_t             stat_drop;
+            bool                 stat_done;
+            chrono::steady_clock::time_point stat_t0;
+
+            void fail(const string &);
+            void progress(void);
 
         public:
             SC_HAS_PROCESS(Checker);
-            Checker(sc_module_name, SyscFCBus::Bus_src<be>*);
+            Checker(sc_module_name, SyscFCBus::Bus_src<T_be>*);
             ~Checker(void);
 
-            sc_out <bool>     end_o;
-            sc_in  <Bus<be>>  bus_i;
-            sc_in  <bool>     dav_i;
-            sc_in  <bool>     clk_i;
+            sc_out <bool>       end_o;
+            sc_in  <Bus<T_be>>  bus_i;
+            sc_in  <bool>       dav_i;
+            sc_in  <bool>       clk_i;
 
             void check(void);
             void set_count(unsigned);
+            void set_ref_stream(Frm_stream*);
+            void set_part(bool);
+            void set_fcs(bool);
+            void set_err(bool);
+            void set_soak(uint64_t, uint64_t, const string &);
+            bool get_soak(void);
             bool get_pass(void);
+            uint64_t get_count(void);
+            uint64_t get_drop_cnt(void);
+            void write_stats(void);
     };
 
     class ReqMux : public sc_module
@@ -92,37 +128,1116 @@
             void run(void);
     };
 
+    template <unsigned T_be>
     class tb : public sc_module
     {
         private:
             double            clk_freq_hz;
             string            drv_path;
+            string            shm_path;
             string            drv_handler;
             string            drv_request;
+            string            cache_mode;
+            string            shm_env;
             unsigned          req_delay;
             unique_ptr<Msg>   msg;
             DrvClient       * drv;
+            Frm_drv         * frm_drv;
+            Frm_cache       * frm_cache;
+            Frm_shm         * frm_shm;
+            Frm_gen_dot3    * frm_gen;
+            Frm_gen_dot3    * ref_gen;
+            Frm_fcs         * fcs_src;
+            Frm_fcs_stream  * fcs_gen;
+            Frm_fcs_stream  * fcs_ref;
+            chrono::steady_clock::time_point t0;
+
+            void cache_record(void);
 
         public:
             SC_HAS_PROCESS(tb);
             tb(sc_module_name, unsigned);
             ~tb(void);
 
-            Clk<bool>   * i_clk;
-            Bus_src<be> * i_bus;
-            ReqDly      * i_dly;
-            ReqMux      * i_mux;
-            Checker     * i_chk;
-
-            sc_signal <bool    > tb_clk;
-            sc_signal <bool    > tb_dav;
-            sc_signal <bool    > tb_sel;
-            sc_signal <bool    > bus_req;
-            sc_signal <uint32_t> bus_cnt;
-            sc_signal <Bus<be> > bus_bus;
-            sc_signal <bool    > bus_sav;
-            sc_signal <bool    > dly_req;
-            sc_signal <bool    > mux_req;
-            sc_signal <bool    > chk_end;
+            Clk<bool>           * i_clk;
+            Bus_src<T_be>       * i_bus;
+            ReqDly              * i_dly;
+            ReqMux              * i_mux;
+            Checker<T_be>       * i_chk;
+            Bus_mon<T_be>       * i_mon;
+            Bus_assert<T_be>    * i_ast;
+            Bus_split_clk<T_be> * i_spl;
+            Bus_split<T_be>     * i_spc;
+
+            void             start_of_simulation(void);
+            void             report_split(void);
+            vector<uint64_t> get_env_uints(const char *, const char *, const string &, unsigned, unsigned, bool);
+
+            sc_signal <bool     > tb_clk;
+            sc_signal <bool     > tb_dav;
+            sc_signal <bool     > tb_sel;
+            sc_signal <bool     > bus_req;
+            sc_signal <uint32_t > bus_cnt;
+            sc_signal <Bus<T_be>> bus_bus;
+            sc_signal <bool     > bus_sav;
+            sc_signal <bool     > dly_req;
+            sc_signal <bool     > mux_req;
+            sc_signal <bool     > chk_end;
+            sc_signal <uint32_t > spl_usr;
+            sc_signal <bool     > spl_err;
+            sc_signal <bool     > spl_val;
+            sc_signal <bool     > spl_sof;
+            sc_signal <bool     > spl_eof;
+            sc_signal <Mod<T_be>> spl_mod;
+            sc_signal <Dat<T_be>> spl_dat;
     };
+
+    template <unsigned T_be>
+    Checker<T_be>::Checker(sc_module_name arg_nm, SyscFCBus::Bus_src<T_be> * arg_bs) : lg(this->name())
+    {
+        this->msg   = unique_ptr<Msg>(new Msg(this->name()));
+        this->bus   = arg_bs;
+        this->ref   = nullptr;
+        this->pass  = true;
+        this->count = 3;
+        this->part  = false;
+        this->fcs   = false;
+        this->inj   = false;
+        this->soak  = false;
+
+        this->soak_cnt   = 0;
+        this->soak_every = 0;
+        this->stat_frm   = 0;
+        this->stat_byte  = 0;
+        this->stat_bad   = 0;
+        this->stat_fail  = 0;
+        this->stat_drop  = 0;
+        this->stat_done  = false;
+        this->stat_t0    = chrono::steady_clock::now();
+
+        SC_CTHREAD(check, this->clk_i.neg());
+    }
+
+    template <unsigned T_be>
+    Checker<T_be>::~Checker(void) { }
+
+    template <unsigned T_be>
+    void
+    Checker<T_be>::set_count(unsigned arg)
+    {
+        this->count = arg;
+    }
+
+    /** \fn    Checker::set_ref_stream()
+     *  \brief Compares each beat with the next bytes of a reference stream
+     *  instead of with the frame held by the Bus_src, which is not held when
+     *  it streams
+     */
+
+    template <unsigned T_be>
+    void
+    Checker<T_be>::set_ref_stream(Frm_stream * arg_ref)
+    {
+        this->ref = arg_ref;
+    }
+
+    /** \fn    Checker::set_part()
+     *  \brief Allows gaps and short beats within frames, as driven by
+     *  Bus_src::set_part(); otherwise they fail the test
+     */
+
+    template <unsigned T_be>
+    void
+    Checker<T_be>::set_part(bool arg)
+    {
+        this->part = arg;
+    }
+
+    /** \fn    Checker::set_fcs()
+     *  \brief Checks the FCS ending each frame, as appended by Frm_fcs or
+     *  Frm_fcs_stream; the accumulated frame length then includes the FCS
+     */
+
+    template <unsigned T_be>
+    void
+    Checker<T_be>::set_fcs(bool arg)
+    {
+        this->fcs = arg;
+    }
+
+    /** \fn    Checker::set_err()
+     *  \brief Expects the errors injected by Bus_src::set_err(), taking the
+     *  plan of each frame from the Bus_src at it's sof
+     */
+
+    template <unsigned T_be>
+    void
+    Checker<T_be>::set_err(bool arg)
+    {
+        this->inj = arg;
+    }
+
+    /** \fn    Checker::set_soak()
+     *  \brief Selects the soak mode, checking arg_cnt frames, or without end
+     *  when zero, with memory that does not grow
+     *
+     *  Frames are compared beat by beat rather than collected, no line is
+     *  reported per good frame, and only the first ten failures are
+     *  reported in full.  A progress line with the counts of frames, bytes
+     *  and failures is reported every arg_every frames, and write_stats()
+     *  writes the final counts to arg_path as JSON.
+     */
+
+    template <unsigned T_be>
+    void
+    Checker<T_be>::set_soak(uint64_t arg_cnt, uint64_t arg_every, const string & arg_path)
+    {
+        this->soak       = true;
+        this->soak_cnt   = arg_cnt;
+        this->soak_every = arg_every;
+        this->soak_path  = arg_path;
+    }
+
+    template <unsigned T_be>
+    bool
+    Checker<T_be>::get_soak(void)
+    {
+        return this->soak;
+    }
+
+    template <unsigned T_be>
+    bool
+    Checker<T_be>::get_pass(void)
+    {
+        return this->pass;
+    }
+
+    /** \fn    Checker::get_count()
+     *  \brief Returns the number of frames the run checks, 0 for a soak
+     *  without end
+     */
+
+    template <unsigned T_be>
+    uint64_t
+    Checker<T_be>::get_count(void)
+    {
+        return this->soak ? this->soak_cnt : this->count;
+    }
+
+    /** \fn    Checker::get_drop_cnt()
+     *  \brief Returns the number of frames started after a frame whose eof
+     *  was dropped, each of which a Bus_assert counts as rule_sof_in_frm
+     */
+
+    template <unsigned T_be>
+    uint64_t
+    Checker<T_be>::get_drop_cnt(void)
+    {
+        return this->stat_drop;
+    }
+
+    /** \fn    Checker::fail()
+     *  \brief Reports a failure, in soak mode only the first ten
+     *
+     *  Failures are reported synchronously, so the log is flushed first to
+     *  keep the per-frame lines queued before it in order.
+     */
+
+    template <unsigned T_be>
+    void
+    Checker<T_be>::fail(const string & arg)
+    {
+        this->pass      = false;
+        this->stat_fail = this->stat_fail + 1;
+
+        if (!this->soak || (this->stat_fail <= 11))
+        {
+            Log::get().flush();
+        }
+
+        if (!this->soak || (this->stat_fail <= 10))
+        {
+            this->msg->report_inf(arg + ", FAIL");
+        }
+        else if (this->stat_fail == 11)
+        {
+            this->msg->report_inf("further failures are counted only");
+        }
+    }
+
+    template <unsigned T_be>
+    void
+    Checker<T_be>::progress(void)
+    {
+        double        wall = chrono::duration<double>(chrono::steady_clock::now() - this->stat_t0).count();
+        ostringstream os;
+
+        os << fixed << setprecision(1) << ((wall > 0) ? (this->stat_frm / wall) : 0.0);
+
+        this->msg->report_inf
+        (
+            "soak, frames" + SP + to_string(this->stat_frm)
+            + ", bytes" + SP + to_string(this->stat_byte)
+            + ", bad frames" + SP + to_string(this->stat_bad)
+            + ", failures" + SP + to_string(this->stat_fail)
+            + ", sim time" + SP + sc_time_stamp().to_string()
+            + ", rate" + SP + os.str() + SP + "frames/s"
+        );
+    }
+
+    /** \fn    Checker::write_stats()
+     *  \brief Writes the final soak counts as JSON, once; nothing outside
+     *  soak mode
+     */
+
+    template <unsigned T_be>
+    void
+    Checker<T_be>::write_stats(void)
+    {
+        double   wall = chrono::duration<double>(chrono::steady_clock::now() - this->stat_t0).count();
+        ofstream fs;
+
+        if (!this->soak || this->stat_done)
+        {
+            return;
+        }
+
+        this->stat_done = true;
+        this->progress();
+
+        fs.open(this->soak_path);
+
+        if (!fs)
+        {
+            this->msg->report_inf("cannot write soak stats to" + SP + this->soak_path);
+            return;
+        }
+
+        fs << "{" << NL;
+        fs << "    \"bus_bits\": "     << ((1 << T_be) * 8)                                        << "," << NL;
+        fs << "    \"frames\": "       << this->stat_frm                                           << "," << NL;
+        fs << "    \"bytes\": "        << this->stat_byte                                          << "," << NL;
+        fs << "    \"bad_frames\": "   << this->stat_bad                                           << "," << NL;
+        fs << "    \"failures\": "     << this->stat_fail                                          << "," << NL;
+        fs << "    \"sim_time_s\": "   << sc_time_stamp().to_seconds()                             << "," << NL;
+        fs << "    \"wall_time_s\": "  << wall                                                     << "," << NL;
+        fs << "    \"frames_per_s\": " << ((wall > 0) ? (this->stat_frm / wall) : 0.0)             << "," << NL;
+        fs << "    \"pass\": "         << (this->pass ? "true" : "false")                          << NL;
+        fs << "}" << NL;
+
+        this->msg->report_inf("soak stats written to" + SP + this->soak_path);
+    }
+
+    template <unsigned T_be>
+    void
+    Checker<T_be>::check(void)
+    {
+        Bus<T_be> sig_bus       = bus_rst<T_be>();
+        bool      sig_dav       = false;
+        bool      sig_end       = false;
+        uint64_t  pkt_cnt       = 0;
+        unsigned  exp_frame_len = 0;
+        unsigned  obs_frame_len = 0;
+        unsigned  org_frame_len = 0;
+        unsigned  acc_frame_len = 64;
+        bool      ref_bad       = false;
+        unsigned  ref_pos       = 0;
+        uint8_t   ref_exp       = 0;
+        uint8_t   ref_obs       = 0;
+        uint8_t   ref_bytes[1 << T_be];
+        uint8_t   dat_bytes[1 << T_be];
+        bool      drop_prev     = false;
+        str_vec   exp_frame_bytes;
+        str_vec   obs_frame_bytes;
+        Fcs_chk<T_be> fcs_chk;
+        err_plan  exp_err       = { err_none, 0, 0, 0, 0 };
+        bool      obs_err       = false;
+        bool      flat          = (this->ref != nullptr) || this->soak;
+        const uint8_t * exp_ptr = nullptr;
+        Bus_rules rules(this->part, this->part);
+
+        if (this->fcs)
+        {
+            acc_frame_len = acc_frame_len + fcs_len;
+        }
+
+        this->end_o = sig_end;
+
+        while (true)
+        {
+            wait();
+
+            sig_bus = this->bus_i;
+            sig_dav = this->dav_i;
+
+            unsigned       mod_cnt = bus_get_byte_cnt(sig_bus);
+            bool           drop_end = false;
+            bool           frm_end  = false;
+
+            dat_to_bytes<T_be>(sig_bus.dat, dat_bytes);
+
+            if (sig_bus.sof && sig_bus.val && sig_dav && this->inj && !this->bus->get_eng().pop_err_plan(exp_err))
+            {
+                this->fail("no error plan for frame");
+            }
+
+            if (sig_bus.sof && sig_bus.val && sig_dav)
+            {
+                obs_err         = false;
+                this->stat_drop = this->stat_drop + (drop_prev ? 1 : 0);
+                drop_prev       = false;
+            }
+
+            if (sig_bus.val && sig_dav && this->inj)
+            {
+                unsigned len = (sig_bus.sof ? 0 : obs_frame_len) + mod_cnt;
+
+                drop_end = (exp_err.kind == err_eof) && !sig_bus.eof && (len == exp_err.len);
+                obs_err  = obs_err || sig_bus.err;
+            }
+
+            frm_end = sig_bus.val && sig_dav && (sig_bus.eof || drop_end);
+
+            if (frm_end)
+            {
+                pkt_cnt++;
+                drop_prev = drop_end;
+            }
+
+            if (sig_dav)
+            {
+                enum_bus_rule rule = rules.step(bus_ctl<T_be>(sig_bus) | (drop_end ? ctl_eof : 0));
+
+                if (rule != rule_ok)
+                {
+                    this->fail("framing error," + SP + bus_rule_str(rule));
+                }
+            }
+
+            if (frm_end && ((exp_err.kind == err_eof) == sig_bus.eof))
+            {
+                this->fail("eof" + SP + (sig_bus.eof ? "not dropped" : "missing"));
+            }
+
+            if (frm_end && (obs_err != (exp_err.kind == err_err)))
+            {
+                this->fail("err" + SP + (obs_err ? "unexpected" : "not asserted"));
+            }
+
+            if (sig_bus.val && sig_dav && this->fcs && !fcs_chk.put(sig_bus) && ((exp_err.kind == err_none) || (exp_err.kind == err_err)))
+            {
+                this->fail("bad fcs at eof");
+            }
+
+            if (sig_bus.sof && sig_bus.val && sig_dav && (this->ref != nullptr))
+            {
+                obs_frame_len = mod_cnt;
+                ref_bad       = false;
+                this->ref->get_frame_len(org_frame_len);
+                exp_frame_len = this->inj ? exp_err.len : org_frame_len;
+            }
+            else if (sig_bus.sof && sig_bus.val && sig_dav && this->soak)
+            {
+                obs_frame_len = mod_cnt;
+                ref_bad       = false;
+                org_frame_len = this->bus->get_cur_byte_cnt();
+                exp_frame_len = this->inj ? exp_err.len : org_frame_len;
+                exp_ptr       = this->bus->get_eng().get_cur_bytes();
+            }
+            else if (sig_bus.sof && sig_bus.val && sig_dav)
+            {
+                obs_frame_len = mod_cnt;
+                org_frame_len = this->bus->get_cur_byte_cnt();
+                exp_frame_len = this->inj ? exp_err.len : org_frame_len;
+                exp_frame_bytes = this->bus->get_cur_byte_vec();
+                obs_frame_bytes.clear();
+
+                for (unsigned i = org_frame_len ; i < exp_frame_len ; i++)
+                {
+                    stringstream  ss;
+
+                    ss << hex << uppercase << setw(2) << setfill('0') << (i & 0xFF);
+
+                    exp_frame_bytes.push_back(ss.str());
+                }
+
+                if (exp_err.kind == err_flip)
+                {
+                    stringstream  ss;
+                    unsigned      byte = stoul(exp_frame_bytes[exp_err.pos], nullptr, 16) ^ (1 << exp_err.bit);
+
+                    ss << hex << uppercase << setw(2) << setfill('0') << byte;
+
+                    exp_frame_bytes[exp_err.pos] = ss.str();
+                }
+            }
+            else if (sig_bus.val && sig_dav)
+            {
+                obs_frame_len = obs_frame_len + mod_cnt;
+            }
+
+            if (sig_bus.val && sig_dav && flat)
+            {
+                unsigned ref_off = obs_frame_len - mod_cnt;
+                unsigned ref_cnt = (ref_off >= org_frame_len) ? 0 : min(mod_cnt, org_frame_len - ref_off);
+
+                if (this->ref != nullptr)
+                {
+                    ref_cnt = this->ref->get_chunk(ref_bytes, mod_cnt);
+                }
+                else
+                {
+                    memcpy(ref_bytes, exp_ptr + ref_off, ref_cnt);
+                }
+
+                for (unsigned i = 0 ; i < mod_cnt; i++)
+                {
+                    uint8_t  byte       = dat_bytes[i];
+                    unsigned pos        = obs_frame_len - mod_cnt + i;
+                    bool     have       = (i < ref_cnt) || ((pos >= org_frame_len) && (pos < exp_frame_len));
+                    uint8_t  exp        = (i < ref_cnt) ? ref_bytes[i] : (pos & 0xFF);
+
+                    if ((exp_err.kind == err_flip) && (pos == exp_err.pos))
+                    {
+                        exp = exp ^ (1 << exp_err.bit);
+                    }
+
+                    if (!ref_bad && (!have || (byte != exp)))
+                    {
+                        ref_bad = true;
+                        ref_pos = pos;
+                        ref_exp = have ? exp : 0;
+                        ref_obs = byte;
+                    }
+                }
+            }
+            else if (sig_bus.val && sig_dav)
+            {
+                for (unsigned i = 0 ; i < mod_cnt; i++)
+                {
+                    unsigned      byte       = dat_bytes[i];
+                    stringstream  ss;
+
+                    ss << hex << uppercase << setw(2) << setfill('0') << byte;
+
+                    obs_frame_bytes.push_back(ss.str());
+                }
+            }
+
+            if (frm_end && flat)
+            {
+                bool tmp_pass = !ref_bad && (obs_frame_len == exp_frame_len);
+
+                if (obs_frame_len != exp_frame_len)
+                {
+                    this->fail
+                    (
+                        "miscompare, expected frame_len is" + SP + to_string(exp_frame_len)
+                        + ", observed frame_len is" + SP + to_string(obs_frame_len)
+                    );
+                }
+
+                if (ref_bad)
+                {
+                    this->fail
+                    (
+                        "miscompare, expected byte at position" + SP + to_string(ref_pos) + SP + "is" + SP + to_string(ref_exp)
+                        + ", observed byte is" + SP + to_string(ref_obs)
+                    );
+                }
+
+                if (!this->soak && tmp_pass)
+                {
+                    log_inf(this->lg, "frame_len {} OK", exp_frame_len);
+                }
+                else if (!this->soak)
+                {
+                    this->msg->report_inf("frame_len" + SP + to_string(exp_frame_len) + SP + "FAIL");
+                }
+
+                this->pass = this->pass & tmp_pass;
+            }
+            else if (frm_end)
+            {
+                bool tmp_pass = true;
+
+                log_dbg(this->lg, "eof beat {}", sig_bus);
+
+                if (org_frame_len != acc_frame_len)
+                {
+                    tmp_pass = false;
+                    this->fail
+                    (
+                        "miscompare, accumulated frame_len is" + SP + to_string(acc_frame_len)
+                        + ", source frame_len is" + SP + to_string(org_frame_len)
+                    );
+                }
+
+                if (obs_frame_len != exp_frame_len)
+                {
+                    tmp_pass = false;
+                    this->fail
+                    (
+                        "miscompare, expected frame_len is" + SP + to_string(exp_frame_len)
+                        + ", observed frame_len is" + SP + to_string(obs_frame_len)
+                    );
+                }
+
+                for (unsigned i = 0 ; (i < obs_frame_len) && (i < exp_frame_len) ; i++)
+                {
+                    if (obs_frame_bytes[i] != exp_frame_bytes[i])
+                    {
+                        tmp_pass = false;
+                        this->fail
+                        (
+                            "miscompare, expected byte at position" + SP + to_string(i) + SP + "is" + SP + exp_frame_bytes[i]
+                            + ", observed byte at position" + to_string(i) + SP + "is" + SP + obs_frame_bytes[i]
+                        );
+
+                        break;
+                    }
+                }
+
+                if (tmp_pass)
+                {
+                    log_inf(this->lg, "frame_len {} OK", exp_frame_len);
+                }
+                else
+                {
+                    this->msg->report_inf("frame_len" + SP + to_string(exp_frame_len) + SP + "FAIL");
+
+                    string tmp_str = "miscompare, expected bytes are";
+
+                    for (unsigned i = 0 ; i < exp_frame_len ; i++)
+                    {
+                        tmp_str = tmp_str + SP + exp_frame_bytes[i];
+                    }
+
+                    this->msg->report_inf(tmp_str);
+
+                    tmp_str = "miscompare, observed bytes are";
+
+                    for (unsigned i = 0 ; i < obs_frame_len ; i++)
+                    {
+                        tmp_str = tmp_str + SP + obs_frame_bytes[i];
+                    }
+
+                    this->msg->report_inf(tmp_str);
+                }
+
+                this->pass    = this->pass & tmp_pass;
+                acc_frame_len = acc_frame_len + 1;
+            }
+
+            if (frm_end)
+            {
+                this->stat_frm  = this->stat_frm + 1;
+                this->stat_byte = this->stat_byte + obs_frame_len;
+            }
+
+            if (frm_end && (ref_bad || (obs_frame_len != exp_frame_len)))
+            {
+                this->stat_bad  = this->stat_bad + 1;
+            }
+
+            if (frm_end && this->soak && (this->soak_every != 0) && ((this->stat_frm % this->soak_every) == 0))
+            {
+                this->progress();
+            }
+
+            if (this->soak)
+            {
+                sig_end = (this->soak_cnt != 0) && (pkt_cnt >= this->soak_cnt);
+            }
+            else
+            {
+                sig_end = (pkt_cnt >= this->count);
+            }
+
+            if (sig_end && !this->soak)
+            {
+                this->msg->report_inf("packet count met; stopping");
+            }
+
+            this->end_o = sig_end;
+        }
+    }
+
+    template <unsigned T_be>
+    tb<T_be>::tb(sc_module_name arg_nm, unsigned arg_dly)
+    {
+        this->req_delay   = arg_dly;
+        this->clk_freq_hz = 156.250e6;
+        this->drv_path    = "./pydrv_server.py";
+        this->shm_path    = "./pyshm_writer.py";
+        this->drv_handler = "dot3_incr_len";
+        this->drv_request = "{}";
+        this->msg         = unique_ptr<Msg>(new Msg(this->name()));
+        this->drv         = nullptr;
+        this->frm_drv     = nullptr;
+        this->frm_cache   = nullptr;
+        this->frm_shm     = nullptr;
+        this->frm_gen     = nullptr;
+        this->ref_gen     = nullptr;
+        this->fcs_src     = nullptr;
+        this->fcs_gen     = nullptr;
+        this->fcs_ref     = nullptr;
+
+        const char * env_mode   = getenv("TB_FRAME_CACHE");
+        const char * env_dir    = getenv("TB_FRAME_CACHE_DIR");
+        const char * env_shm    = getenv("TB_FRAME_SHM");
+        const char * env_stream = getenv("TB_FRAME_STREAM");
+        const char * env_window = getenv("TB_FRAME_WINDOW");
+        const char * env_pace   = getenv("TB_FRAME_PACE");
+        const char * env_part   = getenv("TB_FRAME_PART");
+        const char * env_fcs    = getenv("TB_FRAME_FCS");
+        const char * env_err    = getenv("TB_FRAME_ERR");
+        const char * env_soak   = getenv("TB_SOAK");
+        const char * env_json   = getenv("TB_SOAK_JSON");
+        const char * env_log    = getenv("TB_LOG");
+        const char * env_split  = getenv("TB_SPLIT");
+        const char * env_max    = getenv("PYDRV_FRAME_MAX");
+        string       cache_dir  = (env_dir  == nullptr) ? "."   : env_dir;
+        unsigned     pay_first  = 50;
+        unsigned     pay_max    = 1500;
+        unsigned     pay_step   = 1;
+        unsigned     win_bytes  = 4096;
+
+        this->cache_mode = (env_mode == nullptr) ? "off" : env_mode;
+        this->shm_env    = (env_shm  == nullptr) ? ""    : env_shm;
+
+        if (env_window != nullptr)
+        {
+            win_bytes = this->get_env_uints("TB_FRAME_WINDOW", env_window, "bytes", 1, 1, false)[0];
+        }
+
+        if (win_bytes == 0)
+        {
+            this->msg->report_inf("TB_FRAME_WINDOW of zero bytes");
+            throw "tb instance" + SP + this->msg->get_str_c_msgid() + SP + "TB_FRAME_WINDOW of zero bytes";
+        }
+
+        if (env_max != nullptr)
+        {
+            uint64_t pay_lim = this->get_env_uints("PYDRV_FRAME_MAX", env_max, "bytes", 1, 1, false)[0];
+
+            this->drv_request = "{\"max\":" + to_string(pay_lim) + "}";
+        }
+
+        if (env_stream != nullptr)
+        {
+            vector<uint64_t> fld = this->get_env_uints("TB_FRAME_STREAM", env_stream, "first:max:step", 3, 3, false);
+
+            pay_first = fld[0];
+            pay_max   = fld[1];
+            pay_step  = fld[2];
+
+            unsigned pay_wrap = (pay_first < 64) ? 64 : pay_first;
+
+            this->frm_gen    = new Frm_gen_dot3(pay_first, pay_max, pay_step, pay_wrap);
+            this->ref_gen    = new Frm_gen_dot3(pay_first, pay_max, pay_step, pay_wrap);
+            this->cache_mode = "off";
+            this->shm_env    = "";
+        }
+
+        if (this->cache_mode != "off")
+        {
+            string cache_nm = string(this->name()) + ".cache";
+
+            this->frm_cache = new Frm_cache(cache_nm, cache_dir, this->drv_handler, this->drv_request);
+        }
+        else if (!this->shm_env.empty())
+        {
+            string shm_nm   = string(this->name()) + ".shm";
+            string shm_ring = this->shm_env + "." + to_string(getpid());
+
+            this->frm_shm = new Frm_shm(shm_nm, shm_ring, 1 << 20, this->shm_path);
+        }
+        else if (this->frm_gen == nullptr)
+        {
+            this->drv = new DrvClient(this->drv_path);
+        }
+
+        this->i_clk       = new Clk<bool>("i_clk", this->clk_freq_hz, 0.5, 1.0, SC_NS, true);
+        this->i_bus       = new Bus_src<T_be>("i_bus", this->drv, this->drv_handler, this->drv_request);
+
+        Frm_src    * src    = nullptr;
+        Frm_stream * stream = this->frm_gen;
+        Frm_stream * ref    = this->ref_gen;
+
+        if (this->frm_cache != nullptr)
+        {
+            src = this->frm_cache;
+        }
+        else if (this->frm_shm != nullptr)
+        {
+            src = this->frm_shm;
+        }
+        else if ((env_fcs != nullptr) && (this->frm_gen == nullptr))
+        {
+            this->frm_drv = new Frm_drv(string(this->name()) + ".drv", this->drv, this->drv_handler, this->drv_request);
+            src = this->frm_drv;
+        }
+
+        if ((env_fcs != nullptr) && (src != nullptr))
+        {
+            this->fcs_src = new Frm_fcs(src);
+            src           = this->fcs_src;
+        }
+        else if ((env_fcs != nullptr) && (stream != nullptr))
+        {
+            this->fcs_gen = new Frm_fcs_stream(this->frm_gen);
+            this->fcs_ref = new Frm_fcs_stream(this->ref_gen);
+            stream        = this->fcs_gen;
+            ref           = this->fcs_ref;
+        }
+
+        if (src != nullptr)
+        {
+            this->i_bus->set_frm_src(src);
+        }
+        else if (stream != nullptr)
+        {
+            this->i_bus->set_frm_stream(stream, win_bytes);
+        }
+
+        if (env_pace != nullptr)
+        {
+            vector<uint64_t> fld        = this->get_env_uints("TB_FRAME_PACE", env_pace, "num:den[:burst[:overhead]]", 2, 4, false);
+            unsigned         pace_num   = fld[0];
+            unsigned         pace_den   = fld[1];
+            unsigned         pace_burst = (fld.size() > 2) ? fld[2] : 16384;
+            unsigned         pace_ovh   = (fld.size() > 3) ? fld[3] : 0;
+
+            this->i_bus->set_pace(pace_num, pace_den, pace_burst, pace_ovh);
+            this->msg->report_inf("pace is" + SP + to_string(pace_num) + "/" + to_string(pace_den) + SP + "bytes per clock");
+        }
+
+        this->i_dly       = new ReqDly("i_dly", this->req_delay);
+        this->i_mux       = new ReqMux("i_mux");
+        this->i_chk       = new Checker<T_be>("i_chk", this->i_bus);
+        this->i_mon       = new Bus_mon<T_be>("i_mon", this->clk_freq_hz);
+        this->i_ast       = new Bus_assert<T_be>("i_ast", env_part != nullptr, env_part != nullptr);
+        this->i_spl       = nullptr;
+        this->i_spc       = nullptr;
+        this->t0          = chrono::steady_clock::now();
+
+        if ((env_split != nullptr) && (string(env_split) == "comb"))
+        {
+            this->i_spc = new Bus_split<T_be>("i_spc");
+            this->msg->report_inf("split on each change of the bus");
+        }
+        else if ((env_split != nullptr) && (string(env_split) == "clk"))
+        {
+            this->i_spl = new Bus_split_clk<T_be>("i_spl");
+            this->msg->report_inf("split once per clock");
+        }
+        else if (env_split != nullptr)
+        {
+            this->msg->report_inf("bad TB_SPLIT" + SP + "\"" + env_split + "\", expecting clk or comb");
+            throw "tb instance" + SP + this->msg->get_str_c_msgid() + SP + "bad TB_SPLIT";
+        }
+
+        if (ref != nullptr)
+        {
+            this->i_chk->set_ref_stream(ref);
+        }
+
+        if (env_fcs != nullptr)
+        {
+            this->i_chk->set_fcs(true);
+            this->msg->report_inf("fcs appended and checked");
+        }
+
+        if (env_part != nullptr)
+        {
+            vector<uint64_t> fld       = this->get_env_uints("TB_FRAME_PART", env_part, "seed:gap_pct:gap_max:part_pct", 4, 4, true);
+            uint64_t         part_seed = fld[0];
+            unsigned         gap_pct   = fld[1];
+            unsigned         gap_max   = fld[2];
+            unsigned         part_pct  = fld[3];
+
+            if ((fld[1] > 100) || (fld[2] > UINT32_MAX) || (fld[3] > 100))
+            {
+                this->msg->report_inf("bad TB_FRAME_PART" + SP + "\"" + env_part + "\", percentages above 100 or gap_max too large");
+                throw "tb instance" + SP + this->msg->get_str_c_msgid() + SP + "bad TB_FRAME_PART";
+            }
+
+            this->i_bus->set_part(part_seed, gap_pct, gap_max, part_pct);
+            this->i_chk->set_part(true);
+            this->msg->report_inf("part-frame mode, seed" + SP + to_string(part_seed));
+        }
+
+        if (env_err != nullptr)
+        {
+            vector<uint64_t> fld           = this->get_env_uints("TB_FRAME_ERR", env_err, "seed:flip:err:trunc:eof:runt:over", 7, 7, true);
+            uint64_t         err_seed      = fld[0];
+            unsigned         ppm[err_LAST] = { 0 };
+            unsigned         kind[]        = { err_flip, err_err, err_trunc, err_eof, err_runt, err_over };
+
+            for (unsigned i = 0 ; i < 6 ; i++)
+            {
+                if (fld[i + 1] > 1000000)
+                {
+                    this->msg->report_inf("bad TB_FRAME_ERR" + SP + "\"" + env_err + "\", rates above 1000000 ppm");
+                    throw "tb instance" + SP + this->msg->get_str_c_msgid() + SP + "bad TB_FRAME_ERR";
+                }
+
+                ppm[kind[i]] = fld[i + 1];
+            }
+
+            this->i_bus->set_err(err_seed, 1518);
+
+            for (unsigned i = err_flip ; i < err_LAST ; i++)
+            {
+                this->i_bus->set_err_rate(static_cast<enum_err_kind>(i), ppm[i]);
+            }
+
+            this->i_chk->set_err(true);
+            this->i_ast->set_expect(rule_sof_in_frm);
+            this->msg->report_inf("error injection, seed" + SP + to_string(err_seed));
+        }
+
+        if (env_soak != nullptr)
+        {
+            vector<uint64_t> fld        = this->get_env_uints("TB_SOAK", env_soak, "frames:every", 2, 2, true);
+            uint64_t         soak_cnt   = fld[0];
+            uint64_t         soak_every = fld[1];
+            string           soak_path  = (env_json == nullptr) ? "soak.json" : env_json;
+
+            if (soak_path.empty())
+            {
+                this->msg->report_inf("TB_SOAK_JSON is empty");
+                throw "tb instance" + SP + this->msg->get_str_c_msgid() + SP + "TB_SOAK_JSON is empty";
+            }
+
+            this->i_chk->set_soak(soak_cnt, soak_every, soak_path);
+            this->msg->report_inf("soak mode," + SP + ((soak_cnt == 0) ? string("unbounded") : to_string(soak_cnt) + SP + "frames"));
+        }
+
+        if (env_log != nullptr)
+        {
+            Log::get().set_path(env_log);
+            this->msg->report_inf("log written to" + SP + env_log);
+        }
+
+        this->msg->report_inf("datapath is" + SP + to_string((1 << T_be) * 8) + SP + "bits");
+        this->msg->report_inf("req_delay is" + SP + to_string(this->req_delay));
+
+        this->tb_clk      = true;
+        this->tb_dav      = true;
+        this->tb_sel      = (this->req_delay > 0);
+
+        this->i_clk->clk_o ( tb_clk  );
+
+        this->i_bus->bus_o ( bus_bus );
+        this->i_bus->sav_o ( bus_sav );
+        this->i_bus->cnt_o ( bus_cnt );
+        this->i_bus->req_o ( bus_req );
+        this->i_bus->dav_i ( tb_dav  );
+        this->i_bus->clk_i ( tb_clk  );
+        this->i_bus->ack_i ( mux_req );
+
+        this->i_dly->req_o ( dly_req );
+        this->i_dly->req_i ( bus_req );
+        this->i_dly->clk_i ( tb_clk  );
+
+        this->i_mux->y_o   ( mux_req );
+        this->i_mux->b_i   ( dly_req );
+        this->i_mux->a_i   ( bus_req );
+        this->i_mux->s_i   ( tb_sel  );
+
+        this->i_chk->end_o ( chk_end );
+        this->i_chk->bus_i ( bus_bus );
+        this->i_chk->dav_i ( tb_dav  );
+        this->i_chk->clk_i ( tb_clk  );
+
+        this->i_mon->bus_i ( bus_bus );
+        this->i_mon->dav_i ( tb_dav  );
+        this->i_mon->clk_i ( tb_clk  );
+
+        this->i_ast->bus_i ( bus_bus );
+        this->i_ast->dav_i ( tb_dav  );
+        this->i_ast->clk_i ( tb_clk  );
+
+        if (this->i_spc != nullptr)
+        {
+            this->i_spc->usr_o ( spl_usr );
+            this->i_spc->err_o ( spl_err );
+            this->i_spc->val_o ( spl_val );
+            this->i_spc->sof_o ( spl_sof );
+            this->i_spc->eof_o ( spl_eof );
+            this->i_spc->mod_o ( spl_mod );
+            this->i_spc->dat_o ( spl_dat );
+            this->i_spc->bus_i ( bus_bus );
+        }
+        else if (this->i_spl != nullptr)
+        {
+            this->i_spl->usr_o ( spl_usr );
+            this->i_spl->err_o ( spl_err );
+            this->i_spl->val_o ( spl_val );
+            this->i_spl->sof_o ( spl_sof );
+            this->i_spl->eof_o ( spl_eof );
+            this->i_spl->mod_o ( spl_mod );
+            this->i_spl->dat_o ( spl_dat );
+            this->i_spl->bus_i ( bus_bus );
+            this->i_spl->clk_i ( tb_clk  );
+        }
+    }
+
+    template <unsigned T_be>
+    tb<T_be>::~tb(void)
+    {
+        delete this->i_spc;
+        delete this->i_spl;
+        delete this->i_ast;
+        delete this->i_mon;
+        delete this->i_mux;
+        delete this->i_dly;
+        delete this->i_bus;
+        delete this->i_clk;
+        delete this->fcs_src;
+        delete this->fcs_gen;
+        delete this->fcs_ref;
+        delete this->frm_cache;
+        delete this->frm_shm;
+        delete this->frm_gen;
+        delete this->ref_gen;
+        delete this->frm_drv;
+        delete this->drv;
+    }
+
+    /** \fn    tb::start_of_simulation()
+     *  \brief Opens the frame cache, once the frame count of the run is set
+     *
+     *  TB_FRAME_CACHE=replay or auto replays a cache file holding at least
+     *  the frames the Checker counts.  Without one, replay fails and auto
+     *  records a new file, as does record.
+     */
+
+    template <unsigned T_be>
+    void
+    tb<T_be>::start_of_simulation(void)
+    {
+        uint64_t need = this->i_chk->get_count();
+        bool     play = false;
+
+        if (this->frm_cache == nullptr)
+        {
+            return;
+        }
+
+        if ((this->cache_mode == "replay") || (this->cache_mode == "auto"))
+        {
+            play = this->frm_cache->open_replay(need);
+        }
+
+        if (!play && (this->cache_mode == "replay"))
+        {
+            this->msg->report_inf("no frame cache of" + SP + to_string(need) + SP + "frames to replay at" + SP + this->frm_cache->get_path());
+            throw "tb instance" + SP + this->msg->get_str_c_msgid() + SP + "no frame cache to replay";
+        }
+
+        if (!play)
+        {
+            this->cache_record();
+        }
+    }
+
+    /** \fn    tb::cache_record()
+     *  \brief Starts the frame source, the ring named by TB_FRAME_SHM or
+     *  the driver, and records it's frames to the frame cache
+     */
+
+    template <unsigned T_be>
+    void
+    tb<T_be>::cache_record(void)
+    {
+        if (!this->shm_env.empty())
+        {
+            string shm_nm   = string(this->name()) + ".shm";
+            string shm_ring = this->shm_env + "." + to_string(getpid());
+
+            this->frm_shm = new Frm_shm(shm_nm, shm_ring, 1 << 20, this->shm_path);
+            this->frm_cache->open_record(this->frm_shm);
+        }
+        else
+        {
+            this->drv     = new DrvClient(this->drv_path);
+            this->frm_drv = new Frm_drv(string(this->name()) + ".drv", this->drv, this->drv_handler, this->drv_request);
+            this->frm_cache->open_record(this->frm_drv);
+        }
+    }
+
+    /** \fn    tb::report_split()
+     *  \brief Reports the output writes of Bus_split_clk, when used, and
+     *  the delta cycles and wall time of the run, for comparing the benches
+     *  without a splitter and with the ones selected by TB_SPLIT
+     */
+
+    template <unsigned T_be>
+    void
+    tb<T_be>::report_split(void)
+    {
+        double        wall = chrono::duration<double>(chrono::steady_clock::now() - this->t0).count();
+        ostringstream os;
+
+        if (this->i_spl != nullptr)
+        {
+            this->i_spl->report();
+        }
+
+        os << fixed << setprecision(3) << wall;
+
+        this->msg->report_inf("delta cycles" + SP + to_string(sc_delta_count()) + ", wall time" + SP + os.str() + SP + "s");
+    }
+
+    /** \fn    tb::get_env_uints()
+     *  \brief Parses the value of an environment variable as unsigned
+     *  fields separated by colons
+     *
+     *  The value must hold from arg_min to arg_max fields of decimal digits,
+     *  each within 32 bits unless arg_wide.  Otherwise the value is reported
+     *  with the expected form and the bench fails, rather than running with
+     *  defaults for the fields it could not read.
+     */
+
+    template <unsigned T_be>
+    vector<uint64_t>
+    tb<T_be>::get_env_uints(const char * arg_nm, const char * arg_val, const string & arg_form, unsigned arg_min, unsigned arg_max, bool arg_wide)
+    {
+        vector<uint64_t> ret;
+        string           val = arg_val;
+        size_t           pos = 0;
+        bool             ok  = true;
+
+        while (ok)
+        {
+            size_t end = val.find(':', pos);
+            string fld = val.substr(pos, (end == string::npos) ? string::npos : (end - pos));
+
+            ok = !fld.empty() && (fld.size() <= 19) && (fld.find_first_not_of("0123456789") == string::npos);
+            ok = ok && (arg_wide || (stoull(fld) <= UINT32_MAX));
+
+            if (ok)
+            {
+                ret.push_back(stoull(fld));
+            }
+
+            if (end == string::npos)
+            {
+                break;
+            }
+
+            pos = end + 1;
+        }
+
+        if (!ok || (ret.size() < arg_min) || (ret.size() > arg_max))
+        {
+            this->msg->report_inf("bad" + SP + arg_nm + SP + "\"" + val + "\", expecting" + SP + arg_form);
+            throw "tb instance" + SP + this->msg->get_str_c_msgid() + SP + "bad" + SP + arg_nm;
+        }
+
+        return ret;
+    }
 #endif
@@ -48,38 +48,53 @@ def get_byte_list(scapy_pkt):
 # ------------------------------------------------------------------------------
 class dot3_incr_len(PydrvCallback):
     """
-    Packet data callback
-        parm: {}
+    Packet data callback, with payloads growing by one byte up to max
+    bytes (default 1500), then restarting at 64
+        parm: {max: %d}, max optional
         data: {frame_len: %d, frame: ["XX", ...]}
     """
     __size = 0
+    __max  = 0
     #
-    def __init__(self):
+    def __init__(self, arg_max = 1500):
         PydrvCallback.__init__(self)
         self.__size = 50
+        self.__max  = arg_max
     #
-    def cb(self, req_str):
+    def gen(self):
+        """
+        Returns the next frame as a string of raw bytes
+        """
         raw = ""
         #
-        if False:
-            print >> sys.stderr, "[INF] dot3_incr_len() callback"
-        #
         for i in range (self.__size):
             j = (i % 256)
             raw = raw + chr(j)
         #
         L2     = Dot3(dst="CA:BB:BB:BB:BB:BB", src="5A:AA:AA:AA:AA:AA")/Payload(load=raw)
         L2.len = self.__size
-        blst   = get_byte_list(L2)
-        bcnt   = len(blst)
         #
-        ret = {"frame_len": bcnt, "frame": blst}
-        #
-        if (int(self.__size) >= 1500):
+        if (int(self.__size) >= self.__max):
             self.__size = 64
         else:
             self.__size = self.__size + 1
         #
+        return str(L2)
+    #
+    def cb(self, req_str):
+        if False:
+            print >> sys.stderr, "[INF] dot3_incr_len() callback"
+        #
+        req = json.loads(req_str)
+        #
+        if ("max" in req):
+            self.__max = int(req["max"])
+        #
+        blst   = get_byte_list(self.gen())
+        bcnt   = len(blst)
+        #
+        ret = {"frame_len": bcnt, "frame": blst}
+        #
         return json.dumps(ret)
     #
 #
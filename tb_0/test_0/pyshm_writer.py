@@ -0,0 +1,185 @@
+#!/usr/bin/python2.7
+#
+# Copyright 2013-2021 Robert Newgard
+#
+# This file is part of SyscFCBus.
+#
+# SyscFCBus is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# SyscFCBus is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+"""
+Writes generated frames to the shared-memory ring read by Frm_shm
+
+    usage: pyshm_writer.py <ring name> [frame count]
+
+The ring layout is described in SyscFCBusShm.h.  PYDRV_FRAME_MAX, when set,
+is the largest payload, as the max of the dot3_incr_len request
+"""
+#
+import ctypes
+import mmap
+import os
+import sys
+#
+from struct         import *
+from pydrv_server   import dot3_incr_len
+#
+# ------------------------------------------------------------------------------
+SHM_MAGIC       = 0x53464342
+SHM_VERSION     = 1
+SHM_PAD         = 0xFFFFFFFF
+SHM_OFF_MAGIC   = 0
+SHM_OFF_VERSION = 4
+SHM_OFF_SIZE    = 8
+SHM_OFF_CLOSED  = 16
+SHM_OFF_EOS     = 20
+SHM_OFF_WR_POS  = 64
+SHM_OFF_WR_SEQ  = 72
+SHM_OFF_WR_WAIT = 76
+SHM_OFF_RD_POS  = 128
+SHM_OFF_RD_SEQ  = 136
+SHM_OFF_RD_WAIT = 140
+SHM_OFF_DATA    = 256
+#
+SYS_FUTEX       = 202
+FUTEX_WAIT      = 0
+FUTEX_WAKE      = 1
+#
+# ------------------------------------------------------------------------------
+class timespec(ctypes.Structure):
+    _fields_ = [("tv_sec", ctypes.c_long), ("tv_nsec", ctypes.c_long)]
+#
+# ------------------------------------------------------------------------------
+class ShmClosed(Exception):
+    pass
+#
+# ------------------------------------------------------------------------------
+class ShmRing:
+    """
+    Writer side of the Frm_shm ring
+    """
+    def __init__(self, name):
+        fd = os.open("/dev/shm/" + name, os.O_RDWR)
+        #
+        self.mm   = mmap.mmap(fd, 0)
+        os.close(fd)
+        #
+        if (self.get32(SHM_OFF_MAGIC) != SHM_MAGIC):
+            raise ValueError("ring %s has bad magic" % (name))
+        #
+        if (self.get32(SHM_OFF_VERSION) != SHM_VERSION):
+            raise ValueError("ring %s has unsupported version" % (name))
+        #
+        self.size = self.get64(SHM_OFF_SIZE)
+        self.wr   = self.get64(SHM_OFF_WR_POS)
+        self.base = ctypes.addressof(ctypes.c_char.from_buffer(self.mm))
+        self.libc = ctypes.CDLL(None, use_errno=True)
+        self.ts   = timespec(0, 1000000)
+    #
+    def get32(self, off):
+        return unpack_from("<I", self.mm, off)[0]
+    #
+    def get64(self, off):
+        return unpack_from("<Q", self.mm, off)[0]
+    #
+    def put32(self, off, val):
+        pack_into("<I", self.mm, off, val)
+    #
+    def put64(self, off, val):
+        pack_into("<Q", self.mm, off, val)
+    #
+    def wait(self, off, val):
+        self.libc.syscall(SYS_FUTEX, ctypes.c_void_p(self.base + off), FUTEX_WAIT, val, ctypes.byref(self.ts), None, 0)
+    #
+    def wake(self, off):
+        self.libc.syscall(SYS_FUTEX, ctypes.c_void_p(self.base + off), FUTEX_WAKE, 0x7FFFFFFF, None, None, 0)
+    #
+    def space(self):
+        return self.size - (self.wr - self.get64(SHM_OFF_RD_POS))
+    #
+    def write(self, data):
+        cnt = len(data)
+        rec = (4 + cnt + 7) & ~7
+        #
+        if (self.get32(SHM_OFF_CLOSED) != 0):
+            raise ShmClosed()
+        #
+        if (3 * rec > self.size):
+            raise ValueError("frame of %d bytes is too large for the ring" % (cnt))
+        #
+        off  = self.wr & (self.size - 1)
+        tail = self.size - off
+        need = rec if (tail >= rec) else (tail + rec)
+        #
+        while (self.space() < need):
+            if (self.get32(SHM_OFF_CLOSED) != 0):
+                raise ShmClosed()
+            #
+            seq = self.get32(SHM_OFF_RD_SEQ)
+            self.put32(SHM_OFF_RD_WAIT, 1)
+            #
+            if (self.space() >= need):
+                break
+            #
+            self.wait(SHM_OFF_RD_SEQ, seq)
+        #
+        if (tail < rec):
+            self.put32(SHM_OFF_DATA + off, SHM_PAD)
+            self.wr = self.wr + tail
+            off     = 0
+        #
+        pos = SHM_OFF_DATA + off
+        self.put32(pos, cnt)
+        self.mm[pos + 4 : pos + 4 + cnt] = data
+        self.wr = self.wr + rec
+        self.publish()
+    #
+    def publish(self):
+        self.put64(SHM_OFF_WR_POS, self.wr)
+        self.put32(SHM_OFF_WR_SEQ, (self.get32(SHM_OFF_WR_SEQ) + 1) & 0xFFFFFFFF)
+        #
+        if (self.get32(SHM_OFF_WR_WAIT) != 0):
+            self.put32(SHM_OFF_WR_WAIT, 0)
+            self.wake(SHM_OFF_WR_SEQ)
+    #
+    def finish(self):
+        self.put32(SHM_OFF_EOS, 1)
+        self.put32(SHM_OFF_WR_WAIT, 0)
+        self.wake(SHM_OFF_WR_SEQ)
+    #
+#
+# ------------------------------------------------------------------------------
+if (__name__ == "__main__"):
+    if (len(sys.argv) < 2 or len(sys.argv) > 3):
+        print >> sys.stderr, "usage: pyshm_writer.py <ring name> [frame count]"
+        exit(1)
+    #
+    ring = ShmRing(sys.argv[1])
+    gen  = dot3_incr_len(int(os.environ.get("PYDRV_FRAME_MAX", "1500")))
+    cnt  = -1
+    #
+    if (len(sys.argv) == 3):
+        cnt = int(sys.argv[2])
+    #
+    try:
+        while (cnt != 0):
+            ring.write(gen.gen())
+            cnt = cnt - 1
+        #
+        ring.finish()
+    except ShmClosed:
+        pass
+    #
+    exit(0)
+#
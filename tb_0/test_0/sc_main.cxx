@@ -18,11 +18,16 @@
  */
 
 #include "test.h"
+#include "cfg_be.h"
 #include "cfg_test.h"
 
+extern template class Checker<be>;
+extern template class tb<be>;
+extern template class test<be>;
+
 int sc_main(int argc, char **argv)
 {
-    test test_0(test_frm_nam, test_req_dly);
+    test<be> test_0(test_frm_nam, test_req_dly);
     test_0.i_chk->set_count(test_frm_cnt);
     sc_start();
     return 0;
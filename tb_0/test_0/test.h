@@ -20,20 +20,230 @@
 #ifndef _TEST_H_
     #define _TEST_H_
 
+    #include <csignal>
     #include <tb.h>
 
-    class test : public tb
+    /** \fn    test_sig()
+     *  \brief The last SIGINT or SIGTERM received in soak mode, 0 if none
+     */
+
+    inline volatile sig_atomic_t & test_sig(void)
+    {
+        static volatile sig_atomic_t sig = 0;
+
+        return sig;
+    }
+
+    extern "C" inline void test_sig_handler(int arg_sig)
+    {
+        test_sig() = arg_sig;
+    }
+
+    /** \class test_if
+     *  \brief Width-independent control of a test, used when the bus width
+     *  is selected at run time
+     */
+
+    class test_if
+    {
+        public:
+            virtual ~test_if(void) { }
+
+            virtual void set_count(unsigned) = 0;
+            virtual bool get_pass(void)      = 0;
+    };
+
+    template <unsigned T_be>
+    class test : public tb<T_be>, public test_if
     {
         private:
             sc_trace_file * tf;
+            unsigned        timeout_ms;
 
         public:
             SC_HAS_PROCESS(test);
             test(sc_module_name, unsigned);
             ~test(void);
 
+            void finish(void);
             void test_execute(void);
             void test_timeout(void);
+            void set_count(unsigned);
+            bool get_pass(void);
+    };
+
+    /** \struct test_make
+     *  \brief Operation for SyscFCBus::be_dispatch() that builds a test
+     */
+
+    template <unsigned T_be>
+    struct test_make
+    {
+        static unique_ptr<test_if> run(const string & arg_nm, unsigned arg_dly)
+        {
+            return unique_ptr<test_if>(new test<T_be>(arg_nm.c_str(), arg_dly));
+        }
     };
 
+    template <unsigned T_be>
+    test<T_be>::test(sc_module_name nm, unsigned dl) : tb<T_be>(nm, dl)
+    {
+        const char * env_ms = getenv("TB_TIMEOUT_MS");
+
+        this->tf         = nullptr;
+        this->timeout_ms = this->i_chk->get_soak() ? 0 : 20;
+
+        if (env_ms != nullptr)
+        {
+            this->timeout_ms = this->get_env_uints("TB_TIMEOUT_MS", env_ms, "ms", 1, 1, false)[0];
+        }
+
+        if (!this->i_chk->get_soak())
+        {
+            this->tf = sc_create_vcd_trace_file("test");
+
+            sc_trace(this->tf, this->tb_clk,               "tb_clk"              );
+            sc_trace(this->tf, this->tb_dav,               "tb_dav"              );
+            sc_trace(this->tf, this->tb_sel,               "tb_sel"              );
+            sc_trace(this->tf, this->bus_cnt,              "bus_cnt"             );
+            sc_trace(this->tf, this->bus_req,              "bus_req"             );
+            sc_trace(this->tf, this->bus_bus,              "bus_bus"             );
+            sc_trace(this->tf, this->i_bus->drv_s,         "i_bus.drv_s"         );
+            sc_trace(this->tf, this->i_bus->drv_c,         "i_bus.drv_c"         );
+            sc_trace(this->tf, this->i_bus->drv_lc,        "i_bus.drv_lc"        );
+            sc_trace(this->tf, this->i_bus->drv_ln,        "i_bus.drv_ln"        );
+            sc_trace(this->tf, this->dly_req,              "dly_req"             );
+            sc_trace(this->tf, this->mux_req,              "mux_req"             );
+            sc_trace(this->tf, this->chk_end,              "chk_end"             );
+            sc_trace(this->tf, this->i_chk->bus_i,         "i_chk.bus_i"         );
+        }
+
+        if (this->i_chk->get_soak())
+        {
+            signal(SIGINT,  test_sig_handler);
+            signal(SIGTERM, test_sig_handler);
+        }
+
+        SC_THREAD(test_timeout);
+        SC_THREAD(test_execute);
+            this->sensitive << this->chk_end;
+        // set_stack_size(100000);
+        // OSCI 5.2.16, sc_core::sc_module::set_stack_size(size_t);
+    }
+
+    template <unsigned T_be>
+    test<T_be>::~test(void)
+    {
+        if (this->tf != nullptr)
+        {
+            sc_close_vcd_trace_file(this->tf);
+        }
+    }
+
+    template <unsigned T_be>
+    void
+    test<T_be>::set_count(unsigned arg)
+    {
+        this->i_chk->set_count(arg);
+    }
+
+    /** \fn    test::get_pass()
+     *  \brief Passes when the checker and the bus rules pass, and each
+     *  sof within a frame follows an eof dropped by error injection
+     */
+
+    template <unsigned T_be>
+    bool
+    test<T_be>::get_pass(void)
+    {
+        bool drop_ok = (this->i_ast->get_rule_cnt(rule_sof_in_frm) == this->i_chk->get_drop_cnt());
+
+        return this->i_chk->get_pass() && this->i_ast->get_pass() && drop_ok;
+    }
+
+    /** \fn    test::finish()
+     *  \brief Reports the monitors, writes the soak stats, flushes the log
+     *  and gives the verdict, then stops the simulation
+     */
+
+    template <unsigned T_be>
+    void
+    test<T_be>::finish(void)
+    {
+        this->i_mon->report();
+        this->report_split();
+        this->i_ast->report();
+        this->i_chk->write_stats();
+
+        Log::get().flush();
+
+        if (this->get_pass())
+        {
+            SC_REPORT_INFO(this->name(), "PASS");
+        }
+        else
+        {
+            SC_REPORT_ERROR(this->name(), "FAIL");
+        }
+
+        sc_stop();
+    }
+
+    template <unsigned T_be>
+    void
+    test<T_be>::test_execute(void)
+    {
+        wait();
+
+        this->finish();
+    }
+
+    /** \fn    test::test_timeout()
+     *  \brief Ends the test after TB_TIMEOUT_MS of simulation time, default
+     *  20, or never when zero
+     *
+     *  In soak mode the default is never, and reaching the limit ends the
+     *  soak normally, with it's stats written, rather than failing.  A soak
+     *  also ends normally on SIGINT or SIGTERM; the handler only records the
+     *  signal, which is polled every 100 us of simulation time.
+     */
+
+    template <unsigned T_be>
+    void
+    test<T_be>::test_timeout(void)
+    {
+        unsigned ms = this->timeout_ms;
+        string   SP = SyscMsg::Chars::SP;
+
+        if (!this->i_chk->get_soak())
+        {
+            if (ms == 0)
+            {
+                return;
+            }
+
+            wait(ms, SC_MS);
+
+            Log::get().flush();
+            SC_REPORT_FATAL(this->name(), ("timeout, simulation ran for" + SP + to_string(ms) + SP + "ms").c_str());
+            return;
+        }
+
+        for (uint64_t i = 0 ; (ms == 0) || (i < (uint64_t(ms) * 10)) ; i++)
+        {
+            wait(100, SC_US);
+
+            if (test_sig() != 0)
+            {
+                SC_REPORT_INFO(this->name(), ("soak stopped by signal" + SP + to_string(test_sig())).c_str());
+                this->finish();
+                return;
+            }
+        }
+
+        SC_REPORT_INFO(this->name(), ("soak time limit of" + SP + to_string(ms) + SP + "ms reached").c_str());
+
+        this->finish();
+    }
+
 #endif
@@ -0,0 +1 @@
+../tb_0/test_0/pydrv_server.py
\ No newline at end of file
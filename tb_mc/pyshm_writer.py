@@ -0,0 +1 @@
+../tb_0/test_0/pyshm_writer.py
\ No newline at end of file
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <unistd.h>
+#include <fstream>
+#include "test.h"
+
+extern template class test<0>;
+extern template class test<1>;
+extern template class test<2>;
+extern template class test<3>;
+extern template class test<4>;
+extern template class test<5>;
+extern template class test<6>;
+extern template class test<7>;
+extern template class test<8>;
+
+void usage(const char * arg_prog)
+{
+    cerr << "usage:" << NL;
+    cerr << "  " << arg_prog << " [-f cfg] [-b be] [-d dly] [-n cnt]" << NL;
+    cerr << NL;
+    cerr << "      -f cfg    configuration file of \"key value\" lines," << NL;
+    cerr << "                keys are be, dly and cnt" << NL;
+    cerr << "      -b be     bus byte exponent [0-8]" << NL;
+    cerr << "      -d dly    frame request delay [0-3]" << NL;
+    cerr << "      -n cnt    number of frames checked, default is 5" << NL;
+    cerr << NL;
+    cerr << "  options on the command line override the configuration file" << NL;
+}
+
+bool read_cfg(const char * arg_fn, int & arg_be, int & arg_dly, int & arg_cnt)
+{
+    ifstream fs(arg_fn);
+    string   line;
+
+    if (!fs)
+    {
+        cerr << "[ERR] cannot open configuration file" << SP << arg_fn << NL;
+        return false;
+    }
+
+    while (getline(fs, line))
+    {
+        istringstream ss(line);
+        string        key;
+        int           val;
+
+        if (!(ss >> key) || (key[0] == '#'))
+        {
+            continue;
+        }
+
+        if (!(ss >> val))
+        {
+            cerr << "[ERR] no value for key" << SP << key << SP << "in" << SP << arg_fn << NL;
+            return false;
+        }
+
+        if      (key == "be")  { arg_be  = val; }
+        else if (key == "dly") { arg_dly = val; }
+        else if (key == "cnt") { arg_cnt = val; }
+        else
+        {
+            cerr << "[ERR] unknown key" << SP << key << SP << "in" << SP << arg_fn << NL;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int sc_main(int argc, char **argv)
+{
+    int      opt = 0;
+    int      be  = -1;
+    int      dly = -1;
+    int      cnt = 5;
+    int      obe = -1;
+    int      odl = -1;
+    int      ocn = -1;
+    string   nam = "";
+    char   * cfg = nullptr;
+
+    while ((opt = getopt(argc, argv, "f:b:d:n:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'f': { cfg = optarg;       break; }
+            case 'b': { obe = atoi(optarg); break; }
+            case 'd': { odl = atoi(optarg); break; }
+            case 'n': { ocn = atoi(optarg); break; }
+            default:
+            {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+    }
+
+    if ((cfg != nullptr) && !read_cfg(cfg, be, dly, cnt))
+    {
+        return 1;
+    }
+
+    if (obe >= 0) { be  = obe; }
+    if (odl >= 0) { dly = odl; }
+    if (ocn >= 0) { cnt = ocn; }
+
+    if ((be < 0) || (be > int(be_max)) || (dly < 0) || (dly > 3) || (cnt < 0))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    nam = "test_" + to_string(be) + "_" + to_string(dly);
+
+    unique_ptr<test_if> test_0 = be_dispatch<test_make>(be, nam, unsigned(dly));
+
+    test_0->set_count(cnt);
+    sc_start();
+
+    return (test_0->get_pass()) ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2013-2021 Robert Newgard
+ *
+ * This file is part of SyscFCBus.
+ *
+ * SyscFCBus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SyscFCBus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test.h"
+
+template class Checker<0>;
+template class Checker<1>;
+template class Checker<2>;
+template class Checker<3>;
+template class Checker<4>;
+template class Checker<5>;
+template class Checker<6>;
+template class Checker<7>;
+template class Checker<8>;
+
+template class tb<0>;
+template class tb<1>;
+template class tb<2>;
+template class tb<3>;
+template class tb<4>;
+template class tb<5>;
+template class tb<6>;
+template class tb<7>;
+template class tb<8>;
+
+template class test<0>;
+template class test<1>;
+template class test<2>;
+template class test<3>;
+template class test<4>;
+template class test<5>;
+template class test<6>;
+template class test<7>;
+template class test<8>;
@@ -17,7 +17,23 @@
  * along with SyscFCBus.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <fstream>
+#include <cmath>
 #include <SyscFCBus.h>
+#include <SyscFCBusVl.h>
+#include <SyscFCBusCo.h>
+#include <SyscFCBusArray.h>
+#include <SyscFCBusSched.h>
+#include <SyscFCBusCell.h>
+#include <SyscFCBusSeg.h>
+#include <SyscFCBusCrc.h>
+#include <SyscFCBusGen.h>
+#include <SyscFCBusAssert.h>
+#include <SyscFCBusShm.h>
+#include <SyscFCBusCache.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 using namespace std;
 using namespace SyscFCBus;
@@ -33,6 +49,26 @@ bool enable_test_05 = true;
 bool enable_test_06 = true;
 bool enable_test_07 = true;
 bool enable_test_08 = true;
+bool enable_test_09 = true;
+bool enable_test_10 = true;
+bool enable_test_11 = true;
+bool enable_test_12 = true;
+bool enable_test_13 = true;
+bool enable_test_14 = true;
+bool enable_test_15 = true;
+bool enable_test_16 = true;
+bool enable_test_17 = true;
+bool enable_test_18 = true;
+bool enable_test_19 = true;
+bool enable_test_20 = true;
+bool enable_test_21 = true;
+bool enable_test_22 = true;
+bool enable_test_23 = true;
+bool enable_test_24 = true;
+bool enable_test_25 = true;
+bool enable_test_26 = true;
+bool enable_test_27 = true;
+bool enable_test_28 = true;
 
 template <unsigned T_be>
 bool test_operator_ostream(Msg& msg, Bus<T_be>& arg_bus)
@@ -63,6 +99,1906 @@ bool test_operator_copy(Msg& msg, Bus<T_be>& arg_bus, Dat<T_be>& arg_dat)
     }
 }
 
+template <unsigned T_be>
+struct bus_bits
+{
+    static unsigned run(void)
+    {
+        return Bus<T_be>::bits_dat;
+    }
+};
+
+/** \fn    test_gearbox()
+ *  \brief Passes frames through Bus_gearbox<T_a, T_b> and back through
+ *  Bus_gearbox<T_b, T_a>, with the sink stalling every third clock, and
+ *  compares the frames received with the frames sent
+ */
+
+template <unsigned T_a, unsigned T_b>
+bool test_gearbox(Msg& msg)
+{
+    Bus_gearbox<T_a, T_b> up("i_up");
+    Bus_gearbox<T_b, T_a> dn("i_dn");
+    unsigned              max      = (1 << T_a);
+    unsigned              frm_cnt  = 200;
+    unsigned              src_frm  = 0;
+    unsigned              src_pos  = 0;
+    unsigned              snk_frm  = 0;
+    vector<uint8_t>       snk_buf;
+    Bus<T_a>              s_bus    = bus_rst<T_a>();
+    Bus<T_b>              m_bus    = bus_rst<T_b>();
+    Bus<T_a>              o_bus    = bus_rst<T_a>();
+    bool                  up_rdy   = false;
+    bool                  dn_rdy   = false;
+    string                test     = "testing Bus_gearbox<" + to_string(T_a) + "," + to_string(T_b) + "> round trip:";
+
+    for (unsigned cyc = 0 ; (cyc < 200000) && (snk_frm < frm_cnt) ; cyc++)
+    {
+        bool     snk_dav = ((cyc % 3) != 0);
+        Bus<T_a> n_s_bus = s_bus;
+        Bus<T_b> n_m_bus = bus_rst<T_b>();
+        Bus<T_a> n_o_bus = bus_rst<T_a>();
+        bool     n_up    = false;
+        bool     n_dn    = false;
+
+        if (o_bus.val && snk_dav)
+        {
+            uint8_t  tmp[1 << T_a];
+            unsigned cnt = bus_get_byte_cnt<T_a>(o_bus);
+
+            if (o_bus.sof)
+            {
+                snk_buf.clear();
+            }
+
+            dat_to_bytes<T_a>(o_bus.dat, tmp);
+            snk_buf.insert(snk_buf.end(), tmp, tmp + cnt);
+
+            if (o_bus.eof)
+            {
+                bool ok = (snk_buf.size() == (snk_frm + 1)) && (o_bus.usr == snk_frm) && (o_bus.err == ((snk_frm % 5) == 0));
+
+                for (unsigned i = 0 ; ok && (i < snk_buf.size()) ; i++)
+                {
+                    ok = (snk_buf[i] == ((snk_frm * 7 + i) & 0xFF));
+                }
+
+                if (!ok)
+                {
+                    msg.cerr_err(test + SP + "frame" + SP + to_string(snk_frm) + SP + "FAIL");
+                    return false;
+                }
+
+                snk_frm++;
+            }
+        }
+
+        if (!s_bus.val || up_rdy)
+        {
+            n_s_bus = bus_rst<T_a>();
+
+            if (src_frm < frm_cnt)
+            {
+                uint8_t  tmp[1 << T_a];
+                unsigned len = src_frm + 1;
+                unsigned cnt = ((len - src_pos) < max) ? (len - src_pos) : max;
+
+                for (unsigned i = 0 ; i < cnt ; i++)
+                {
+                    tmp[i] = (src_frm * 7 + src_pos + i) & 0xFF;
+                }
+
+                n_s_bus.usr = src_frm;
+                n_s_bus.val = true;
+                n_s_bus.sof = (src_pos == 0);
+                n_s_bus.eof = ((src_pos + cnt) == len);
+                n_s_bus.err = n_s_bus.eof && ((src_frm % 5) == 0);
+                n_s_bus.mod = (cnt == max) ? mod_rst<T_a>() : mod_set<T_a>(cnt);
+                n_s_bus.dat = dat_from_bytes<T_a>(tmp, cnt);
+                src_pos     = src_pos + cnt;
+
+                if (src_pos == len)
+                {
+                    src_frm++;
+                    src_pos = 0;
+                }
+            }
+        }
+
+        up.step(s_bus, dn_rdy,  n_m_bus, n_up);
+        dn.step(m_bus, snk_dav, n_o_bus, n_dn);
+
+        s_bus  = n_s_bus;
+        m_bus  = n_m_bus;
+        o_bus  = n_o_bus;
+        up_rdy = n_up;
+        dn_rdy = n_dn;
+    }
+
+    if (snk_frm != frm_cnt)
+    {
+        msg.cerr_err(test + SP + "received" + SP + to_string(snk_frm) + SP + "frames, FAIL");
+        return false;
+    }
+
+    msg.cerr_inf(test + SP + "OK");
+    return true;
+}
+
+/** \struct vl_model
+ *  \brief Stands in for the port members of a Verilated model
+ */
+
+template <typename T_dat>
+struct vl_model
+{
+    uint32_t usr;
+    uint8_t  err;
+    uint8_t  val;
+    uint8_t  sof;
+    uint8_t  eof;
+    uint8_t  mod;
+    T_dat    dat;
+};
+
+template <unsigned T_be, typename T_dat>
+bool test_vl_bind(Msg& msg)
+{
+    vl_model<T_dat> mdl;
+    uint8_t         tmp[1 << T_be];
+    Bus<T_be>       bus  = bus_rst<T_be>();
+    string          test = "testing Vl_bus_in and Vl_bus_out for be" + SP + to_string(T_be) + ":";
+    uint8_t       * mod  = (T_be == 0) ? nullptr : &mdl.mod;
+
+    auto vin  = make_vl_bus_in<T_be>(&mdl.usr, &mdl.err, &mdl.val, &mdl.sof, &mdl.eof, mod, &mdl.dat);
+    auto vout = make_vl_bus_out<T_be>(&mdl.usr, &mdl.err, &mdl.val, &mdl.sof, &mdl.eof, mod, &mdl.dat);
+
+    for (unsigned i = 0 ; i < (1U << T_be) ; i++)
+    {
+        tmp[i] = 0xA0 + i;
+    }
+
+    bus.usr = 0x12345678;
+    bus.val = true;
+    bus.eof = true;
+    bus.mod = mod_set<T_be>((1 << T_be) - 1);
+    bus.dat = dat_from_bytes<T_be>(tmp, 1 << T_be);
+
+    vin.write(bus);
+
+    if (vout.read() != bus)
+    {
+        msg.cerr_err(test + SP + "FAIL");
+        return false;
+    }
+
+    msg.cerr_inf(test + SP + "OK");
+    return true;
+}
+
+#if defined(__cpp_impl_coroutine) && (__cpp_impl_coroutine >= 201902L)
+/** \fn    test_co_script()
+ *  \brief Traffic script for test 13, frames of 1 to 20 bytes with an idle
+ *  beat after each odd length
+ */
+
+Bus_co<2> test_co_script(void)
+{
+    vector<uint8_t> buf;
+
+    for (unsigned i = 1 ; i <= 20 ; i++)
+    {
+        buf.assign(i, uint8_t(i));
+
+        co_yield frame(buf, i);
+        co_yield idle(i % 2);
+    }
+}
+
+bool test_co_drv(Msg& msg)
+{
+    Co_drv<2>       drv(test_co_script());
+    vector<uint8_t> got;
+    unsigned        frm_cnt = 0;
+    unsigned        idl_cnt = 0;
+    bool            ok      = true;
+    string          test    = "testing Co_drv<2> with a traffic script:";
+
+    for (unsigned clk = 0 ; (clk < 1000) && !drv.get_done() ; clk++)
+    {
+        const Bus<2> & bus = drv.step(true);
+        uint8_t        tmp[4];
+
+        if (!bus.val)
+        {
+            idl_cnt++;
+            continue;
+        }
+
+        if (bus.sof)
+        {
+            got.clear();
+        }
+
+        dat_to_bytes<2>(bus.dat, tmp);
+        got.insert(got.end(), tmp, tmp + bus_get_byte_cnt<2>(bus));
+
+        if (bus.eof)
+        {
+            frm_cnt++;
+            ok = ok && (got == vector<uint8_t>(frm_cnt, uint8_t(frm_cnt))) && (bus.usr == frm_cnt);
+        }
+    }
+
+    if (!ok || (frm_cnt != 20) || (idl_cnt != 11))
+    {
+        msg.cerr_err(test + SP + "FAIL");
+        return false;
+    }
+
+    msg.cerr_inf(test + SP + "OK");
+    return true;
+}
+#endif
+
+/** \class test_frm_src
+ *  \brief Frame source repeating five frames of 1 + (n % 5) * arg_step
+ *  bytes, for test 14, ending after arg_max frames if non-zero
+ */
+
+class test_frm_src : public Frm_src
+{
+    private:
+        vector<uint8_t> buf;
+        unsigned        cnt;
+        unsigned        max;
+        unsigned        step;
+
+    public:
+        test_frm_src(unsigned arg_max = 0, unsigned arg_step = 7) : cnt(0), max(arg_max), step(arg_step) { }
+
+        unsigned len(unsigned arg) const { return 1 + ((arg % 5) * this->step); }
+
+        bool get_frame(const uint8_t *& arg_dat, unsigned & arg_cnt)
+        {
+            if ((this->max != 0) && (this->cnt == this->max))
+            {
+                return false;
+            }
+
+            if (this->buf.empty())
+            {
+                this->buf.assign(this->len(4), 0);
+            }
+
+            for (unsigned i = 0 ; i < len(this->cnt) ; i++)
+            {
+                this->buf[i] = (this->cnt % 5) + i;
+            }
+
+            arg_dat = this->buf.data();
+            arg_cnt = len(this->cnt);
+            this->cnt++;
+
+            return true;
+        }
+};
+
+/** \class test_eng
+ *  \brief Bus_src_eng reading a test_frm_src through a Frm_store, for
+ *  tests 18 to 23
+ *
+ *  step() acks with the req of the previous step and trims the store two
+ *  frames behind the cursor, per the Frm_src validity rule.
+ */
+
+template <unsigned T_be>
+class test_eng
+{
+    public:
+        test_frm_src      src;
+        Frm_store         store;
+        Frm_cursor        cursor;
+        Bus_src_eng<T_be> eng;
+        bool              ack;
+
+        test_eng(unsigned arg_step = 7) : src(0, arg_step), store("store", &src), cursor(&store), eng("eng"), ack(false)
+        {
+            this->eng.set_frm_src(&this->cursor);
+        }
+
+        const Bus<T_be> & step(bool arg_dav)
+        {
+            const Bus<T_be> & bus = this->eng.step(arg_dav, this->ack);
+
+            this->ack = this->eng.get_req();
+
+            if (this->cursor.get_pos() >= 2)
+            {
+                this->store.trim(this->cursor.get_pos() - 2);
+            }
+
+            return bus;
+        }
+};
+
+/** \class test_array_tb
+ *  \brief Harness for test 14, a Bus_src_array<2, 32> reading one
+ *  test_frm_src, each port stalling on it's own pattern
+ *
+ *  check() runs on the falling clock edge.  It takes the beat each port
+ *  drove on the rising edge, if that port had dav, and sets dav and ack
+ *  for the next rising edge, ack following req.
+ */
+
+class test_array_tb : public sc_module
+{
+    public:
+        static const unsigned ports = 32;
+
+        test_frm_src                src;
+        Bus_src_array<2, ports>     i_arr;
+        sc_clock                    clk;
+        sc_signal<Bus<2>>           bus[ports];
+        sc_signal<bool>             dav[ports];
+        sc_signal<uint32_t>         cnt[ports];
+        sc_signal<bool>             req[ports];
+        sc_signal<bool>             ack[ports];
+        vector<vector<uint8_t>>     got;
+        vector<unsigned>            frm_cnt;
+        unsigned                    clk_cnt;
+        uint64_t                    held_max;
+        bool                        ok;
+
+        SC_HAS_PROCESS(test_array_tb);
+
+        test_array_tb(sc_module_name arg_nm)
+            : i_arr("i_arr", &src), clk("clk", 10, SC_NS), got(ports), frm_cnt(ports, 0)
+        {
+            this->clk_cnt  = 0;
+            this->held_max = 0;
+            this->ok       = true;
+
+            for (unsigned i = 0 ; i < ports ; i++)
+            {
+                this->i_arr.bus_o[i](this->bus[i]);
+                this->i_arr.dav_i[i](this->dav[i]);
+                this->i_arr.cnt_o[i](this->cnt[i]);
+                this->i_arr.req_o[i](this->req[i]);
+                this->i_arr.ack_i[i](this->ack[i]);
+            }
+
+            this->i_arr.clk_i(this->clk);
+
+            SC_METHOD(check);
+            sensitive << this->clk.negedge_event();
+            dont_initialize();
+        }
+
+        void check(void)
+        {
+            for (unsigned i = 0 ; i < ports ; i++)
+            {
+                const Bus<2> & b = this->bus[i].read();
+                uint8_t        tmp[4];
+
+                if (this->clk_cnt == 0)
+                {
+                    this->ok = this->ok && (b == this->i_arr.get_eng(i).get_bus()) && !b.val;
+                    this->ok = this->ok && (this->req[i].read() == this->i_arr.get_eng(i).get_req());
+                    this->ok = this->ok && (this->cnt[i].read() == this->i_arr.get_eng(i).get_cnt());
+                }
+
+                if (this->dav[i].read() && b.val)
+                {
+                    if (b.sof)
+                    {
+                        this->got[i].clear();
+                    }
+
+                    dat_to_bytes<2>(b.dat, tmp);
+                    this->got[i].insert(this->got[i].end(), tmp, tmp + bus_get_byte_cnt<2>(b));
+
+                    if (b.eof)
+                    {
+                        unsigned n = this->frm_cnt[i]++;
+
+                        this->ok = this->ok && (this->got[i].size() == this->src.len(n));
+
+                        for (unsigned k = 0 ; this->ok && (k < this->got[i].size()) ; k++)
+                        {
+                            this->ok = (this->got[i][k] == uint8_t((n % 5) + k));
+                        }
+                    }
+                }
+
+                this->dav[i].write(((this->clk_cnt + 1) % (i + 2)) != 0);
+                this->ack[i].write(this->req[i].read());
+            }
+
+            if (this->i_arr.get_store().get_held() > this->held_max)
+            {
+                this->held_max = this->i_arr.get_store().get_held();
+            }
+
+            this->clk_cnt = this->clk_cnt + 1;
+        }
+};
+
+/** \fn    test_src_array()
+ *  \brief Checks test_array_tb after the simulation has run: every port's
+ *  frames, the outputs before the first step, and that the shared store
+ *  stays small
+ *
+ *  No module can be created once the simulation kernel starts, so
+ *  sc_main() creates the harnesses of tests 09, 14, 25 and 26 together
+ *  and runs the kernel once, after the other tests.
+ */
+
+bool test_src_array(Msg& msg, test_array_tb& arg_tb)
+{
+    const unsigned  ports = test_array_tb::ports;
+    test_array_tb & tb    = arg_tb;
+    string          test  = "testing Bus_src_array<2, 32> on a shared Frm_store:";
+
+    if (!tb.ok || (tb.clk_cnt < 1000) || (tb.frm_cnt[ports - 1] == 0) || (tb.i_arr.get_store().get_dup_cnt() == 0) || (tb.held_max > tb.frm_cnt[0]))
+    {
+        msg.cerr_err(test + SP + "FAIL");
+        return false;
+    }
+
+    msg.cerr_inf(test + SP + "OK, at most" + SP + to_string(tb.held_max) + SP + "frames held");
+    return true;
+}
+
+/** \class test_mon_tb
+ *  \brief Harness for test 09, a Bus_mon<6> on a known pattern
+ *
+ *  drive() writes a beat on each rising edge: 200 frames, alternately
+ *  130 bytes over three beats and 64 bytes in one, each followed by a gap
+ *  of 0, 3 or 9 clocks in turn, then idle.  The middle clock of each gap
+ *  of 3 or more has dav low and val and sof set, which the monitor must
+ *  ignore.  count() counts the falling edges the monitor samples on.
+ */
+
+class test_mon_tb : public sc_module
+{
+    public:
+        static const unsigned frames = 200;
+
+        Bus_mon<6>              i_mon;
+        sc_clock                clk;
+        sc_signal<Bus<6>>       bus;
+        sc_signal<bool>         dav;
+        unsigned                tx_frm;
+        unsigned                tx_pos;
+        unsigned                gap_left;
+        uint64_t                clk_cnt;
+
+        SC_HAS_PROCESS(test_mon_tb);
+
+        test_mon_tb(sc_module_name arg_nm)
+            : i_mon("i_mon", 156.250e6), clk("clk", 10, SC_NS)
+        {
+            this->tx_frm   = 0;
+            this->tx_pos   = 0;
+            this->gap_left = 0;
+            this->clk_cnt  = 0;
+
+            this->i_mon.set_frm_hist(64, 4);
+            this->i_mon.set_ifg_hist(8);
+
+            this->i_mon.bus_i(this->bus);
+            this->i_mon.dav_i(this->dav);
+            this->i_mon.clk_i(this->clk);
+
+            SC_METHOD(drive);
+            sensitive << this->clk.posedge_event();
+            dont_initialize();
+
+            SC_METHOD(count);
+            sensitive << this->clk.negedge_event();
+            dont_initialize();
+        }
+
+        static unsigned len(unsigned arg_frm)
+        {
+            return ((arg_frm % 2) == 0) ? 130 : 64;
+        }
+
+        static unsigned gap(unsigned arg_frm)
+        {
+            return ((arg_frm % 3) == 0) ? 0 : (((arg_frm % 3) == 1) ? 3 : 9);
+        }
+
+        void drive(void)
+        {
+            Bus<6> b   = bus_rst<6>();
+            bool   dav = true;
+
+            if (this->gap_left > 0)
+            {
+                dav   = (this->gap_left != 2);
+                b.val = !dav;
+                b.sof = !dav;
+
+                this->gap_left--;
+            }
+            else if (this->tx_frm < frames)
+            {
+                unsigned f   = this->tx_frm;
+                unsigned cnt = min(64U, len(f) - this->tx_pos);
+
+                b.val = true;
+                b.sof = (this->tx_pos == 0);
+                b.eof = ((this->tx_pos + cnt) == len(f));
+                b.mod = mod_set<6>(cnt % 64);
+
+                this->tx_pos = b.eof ? 0 : (this->tx_pos + cnt);
+
+                if (b.eof)
+                {
+                    this->gap_left = gap(f);
+                    this->tx_frm   = f + 1;
+                }
+            }
+
+            this->bus.write(b);
+            this->dav.write(dav);
+        }
+
+        void count(void)
+        {
+            this->clk_cnt++;
+        }
+};
+
+/** \fn    test_mon()
+ *  \brief Checks the utilisation, frame rate, counts and histogram bins
+ *  of test_mon_tb's Bus_mon against those of the pattern
+ */
+
+bool test_mon(Msg& msg, test_mon_tb& arg_tb)
+{
+    const unsigned           frames = test_mon_tb::frames;
+    string                   test   = "testing Bus_mon<6>:";
+    const vector<uint64_t> & frm    = arg_tb.i_mon.get_frm_hist();
+    const vector<uint64_t> & ifg    = arg_tb.i_mon.get_ifg_hist();
+    double                   clk    = double(arg_tb.clk_cnt);
+    uint64_t                 bytes  = 0;
+    vector<uint64_t>         exp_frm(4, 0);
+    vector<uint64_t>         exp_ifg(8, 0);
+
+    for (unsigned f = 0 ; f < frames ; f++)
+    {
+        bytes = bytes + test_mon_tb::len(f);
+        exp_frm[test_mon_tb::len(f) / 64]++;
+
+        if ((f + 1) < frames)
+        {
+            exp_ifg[min(7U, test_mon_tb::gap(f))]++;
+        }
+    }
+
+    bool ok = (arg_tb.tx_frm == frames) && (arg_tb.i_mon.get_frm_cnt() == frames);
+
+    ok = ok && (arg_tb.i_mon.get_byte_cnt() == bytes) && (frm == exp_frm) && (ifg == exp_ifg);
+    ok = ok && (fabs(arg_tb.i_mon.get_util() - (bytes / (clk * 64))) < 1e-12);
+    ok = ok && (fabs(arg_tb.i_mon.get_fps() - (frames * 156.250e6 / clk)) < 1e-3);
+
+    if (!ok)
+    {
+        msg.cerr_err(test + SP + "FAIL");
+        return false;
+    }
+
+    msg.cerr_inf(test + SP + "OK," + SP + to_string(frames) + SP + "frames," + SP + to_string(bytes) + SP + "bytes");
+    return true;
+}
+
+/** \class test_split_tb
+ *  \brief Harness for test 25, a Bus_split<6> and a Bus_split_clk<6> on
+ *  one bus
+ *
+ *  drive() writes a beat on each rising edge: three beat frames with a
+ *  one clock gap, usr held, mod set only on the eof beat and dat held over
+ *  the gap.  check() runs on the falling clock edge.  The Bus_split
+ *  outputs must match the bus, those of Bus_split_clk the beat before,
+ *  and the Bus_split_clk writes must come to 7 for the first sample plus
+ *  one per changed field, so that unchanged fields are never rewritten.
+ */
+
+class test_split_tb : public sc_module
+{
+    public:
+        Bus_split<6>            i_spc;
+        Bus_split_clk<6>        i_spl;
+        sc_clock                clk;
+        sc_signal<Bus<6>>       bus;
+        sc_signal<uint32_t>     spc_usr;
+        sc_signal<bool>         spc_err;
+        sc_signal<bool>         spc_val;
+        sc_signal<bool>         spc_sof;
+        sc_signal<bool>         spc_eof;
+        sc_signal<Mod<6>>       spc_mod;
+        sc_signal<Dat<6>>       spc_dat;
+        sc_signal<uint32_t>     spl_usr;
+        sc_signal<bool>         spl_err;
+        sc_signal<bool>         spl_val;
+        sc_signal<bool>         spl_sof;
+        sc_signal<bool>         spl_eof;
+        sc_signal<Mod<6>>       spl_mod;
+        sc_signal<Dat<6>>       spl_dat;
+        Bus<6>                  prv_bus;
+        Bus<6>                  smp_bus;
+        bool                    first;
+        unsigned                clk_cnt;
+        uint64_t                chg_cnt;
+        uint64_t                exp_wr;
+        bool                    ok;
+
+        SC_HAS_PROCESS(test_split_tb);
+
+        test_split_tb(sc_module_name arg_nm)
+            : i_spc("i_spc"), i_spl("i_spl"), clk("clk", 10, SC_NS)
+        {
+            this->prv_bus = bus_rst<6>();
+            this->smp_bus = bus_rst<6>();
+            this->first   = true;
+            this->clk_cnt = 0;
+            this->chg_cnt = 0;
+            this->exp_wr  = 0;
+            this->ok      = true;
+
+            this->i_spc.usr_o(this->spc_usr);
+            this->i_spc.err_o(this->spc_err);
+            this->i_spc.val_o(this->spc_val);
+            this->i_spc.sof_o(this->spc_sof);
+            this->i_spc.eof_o(this->spc_eof);
+            this->i_spc.mod_o(this->spc_mod);
+            this->i_spc.dat_o(this->spc_dat);
+            this->i_spc.bus_i(this->bus);
+
+            this->i_spl.usr_o(this->spl_usr);
+            this->i_spl.err_o(this->spl_err);
+            this->i_spl.val_o(this->spl_val);
+            this->i_spl.sof_o(this->spl_sof);
+            this->i_spl.eof_o(this->spl_eof);
+            this->i_spl.mod_o(this->spl_mod);
+            this->i_spl.dat_o(this->spl_dat);
+            this->i_spl.bus_i(this->bus);
+            this->i_spl.clk_i(this->clk);
+
+            SC_METHOD(drive);
+            sensitive << this->clk.posedge_event();
+            dont_initialize();
+
+            SC_METHOD(count);
+            sensitive << this->bus;
+
+            SC_METHOD(check);
+            sensitive << this->clk.negedge_event();
+            dont_initialize();
+        }
+
+        void drive(void)
+        {
+            Bus<6>   b   = this->bus.read();
+            unsigned pos = this->clk_cnt % 4;
+
+            b.usr = 0x5a5a0001;
+            b.val = (pos != 3);
+            b.sof = (pos == 0);
+            b.eof = (pos == 2);
+            b.mod = mod_set<6>((pos == 2) ? 8 : 0);
+
+            if (b.val)
+            {
+                b.dat.set_word(0, this->clk_cnt);
+            }
+
+            this->bus.write(b);
+        }
+
+        void count(void)
+        {
+            this->chg_cnt++;
+        }
+
+        void check(void)
+        {
+            const Bus<6> & b = this->bus.read();
+            const Bus<6> & s = this->prv_bus;
+            const Bus<6> & p = this->smp_bus;
+
+            this->ok = this->ok && (this->spc_usr.read() == b.usr) && (this->spc_err.read() == b.err);
+            this->ok = this->ok && (this->spc_val.read() == b.val) && (this->spc_sof.read() == b.sof);
+            this->ok = this->ok && (this->spc_eof.read() == b.eof) && (this->spc_mod.read() == b.mod);
+            this->ok = this->ok && (this->spc_dat.read() == b.dat);
+
+            this->ok = this->ok && (this->spl_usr.read() == s.usr) && (this->spl_err.read() == s.err);
+            this->ok = this->ok && (this->spl_val.read() == s.val) && (this->spl_sof.read() == s.sof);
+            this->ok = this->ok && (this->spl_eof.read() == s.eof) && (this->spl_mod.read() == s.mod);
+            this->ok = this->ok && (this->spl_dat.read() == s.dat);
+
+            if (this->first)
+            {
+                this->exp_wr  = 7;
+            }
+            else
+            {
+                this->exp_wr  = this->exp_wr  + ((s.usr != p.usr) ? 1 : 0) + ((s.err != p.err) ? 1 : 0);
+                this->exp_wr  = this->exp_wr  + ((s.val != p.val) ? 1 : 0) + ((s.sof != p.sof) ? 1 : 0);
+                this->exp_wr  = this->exp_wr  + ((s.eof != p.eof) ? 1 : 0) + ((s.mod != p.mod) ? 1 : 0);
+                this->exp_wr  = this->exp_wr  + ((s.dat != p.dat) ? 1 : 0);
+            }
+
+            this->smp_bus = s;
+            this->prv_bus = b;
+            this->first   = false;
+            this->clk_cnt = this->clk_cnt + 1;
+        }
+};
+
+/** \fn    test_split()
+ *  \brief Checks test_split_tb after the simulation has run, and reports
+ *  the output writes per beat of Bus_split and Bus_split_clk
+ *
+ *  Bus_split writes all seven outputs each time the bus changes.
+ */
+
+bool test_split(Msg& msg, test_split_tb& arg_tb)
+{
+    string   test    = "testing Bus_split<6> and Bus_split_clk<6>:";
+    uint64_t spc_wr  = 7 * arg_tb.chg_cnt;
+    uint64_t spl_wr  = arg_tb.i_spl.get_wr_cnt();
+    double   beats   = arg_tb.i_spl.get_clk_cnt();
+    bool     ok      = arg_tb.ok && (arg_tb.clk_cnt > 100);
+
+    ok = ok && (arg_tb.i_spl.get_clk_cnt() == arg_tb.clk_cnt);
+    ok = ok && (spl_wr == arg_tb.exp_wr);
+
+    if (!ok)
+    {
+        msg.cerr_err(test + SP + "FAIL");
+        return false;
+    }
+
+    stringstream ss;
+
+    ss << fixed << setprecision(2) << (spc_wr / beats) << SP << "and" << SP << (spl_wr / beats);
+
+    msg.cerr_inf(test + SP + "OK, output writes per beat" + SP + ss.str());
+    return true;
+}
+
+/** \class test_merge_tb
+ *  \brief Harness for test 26, a Bus_merge<3> sampling on the falling
+ *  edge and one sampling on the rising edge, on the same signals
+ *
+ *  step() runs on the rising clock edge.  It first checks the merged
+ *  buses, that of the falling edge Bus_merge against the beat driven on
+ *  the previous rising edge and that of the rising edge one against the
+ *  beat before it, then drives the next beat.  The frames run from 9 to
+ *  28 bytes, with usr set to the frame number, err on the last beat of
+ *  every fifth frame and val low on every seventh clock.  The frames are
+ *  rebuilt from the falling edge bus, so that sof, eof and the byte count
+ *  given by mod on the last beat are checked.
+ */
+
+class test_merge_tb : public sc_module
+{
+    public:
+        Bus_merge<3>            i_mrg;
+        Bus_merge<3>            i_mrg_pos;
+        sc_clock                clk;
+        sc_signal<uint32_t>     usr;
+        sc_signal<bool>         err;
+        sc_signal<bool>         val;
+        sc_signal<bool>         sof;
+        sc_signal<bool>         eof;
+        sc_signal<Mod<3>>       mod;
+        sc_signal<Dat<3>>       dat;
+        sc_signal<Bus<3>>       bus;
+        sc_signal<Bus<3>>       bus_pos;
+        Bus<3>                  exp_bus;
+        Bus<3>                  prv_bus;
+        vector<uint8_t>         got;
+        unsigned                frm_cnt;
+        unsigned                tx_frm;
+        unsigned                tx_pos;
+        unsigned                clk_cnt;
+        bool                    ok;
+
+        SC_HAS_PROCESS(test_merge_tb);
+
+        test_merge_tb(sc_module_name arg_nm)
+            : i_mrg("i_mrg"), i_mrg_pos("i_mrg_pos", false), clk("clk", 10, SC_NS)
+        {
+            this->exp_bus = bus_rst<3>();
+            this->prv_bus = bus_rst<3>();
+            this->frm_cnt = 0;
+            this->tx_frm  = 0;
+            this->tx_pos  = 0;
+            this->clk_cnt = 0;
+            this->ok      = true;
+
+            this->i_mrg.usr_i(this->usr);
+            this->i_mrg.err_i(this->err);
+            this->i_mrg.val_i(this->val);
+            this->i_mrg.sof_i(this->sof);
+            this->i_mrg.eof_i(this->eof);
+            this->i_mrg.mod_i(this->mod);
+            this->i_mrg.dat_i(this->dat);
+            this->i_mrg.clk_i(this->clk);
+            this->i_mrg.bus_o(this->bus);
+
+            this->i_mrg_pos.usr_i(this->usr);
+            this->i_mrg_pos.err_i(this->err);
+            this->i_mrg_pos.val_i(this->val);
+            this->i_mrg_pos.sof_i(this->sof);
+            this->i_mrg_pos.eof_i(this->eof);
+            this->i_mrg_pos.mod_i(this->mod);
+            this->i_mrg_pos.dat_i(this->dat);
+            this->i_mrg_pos.clk_i(this->clk);
+            this->i_mrg_pos.bus_o(this->bus_pos);
+
+            SC_METHOD(step);
+            sensitive << this->clk.posedge_event();
+            dont_initialize();
+        }
+
+        unsigned len(unsigned arg_frm)
+        {
+            return 9 + (arg_frm % 20);
+        }
+
+        void step(void)
+        {
+            const Bus<3> & b = this->bus.read();
+            Bus<3>         n = this->exp_bus;
+            uint8_t        tmp[8];
+
+            if (this->clk_cnt > 0)
+            {
+                this->ok = this->ok && (b == this->exp_bus);
+            }
+
+            if (this->clk_cnt > 1)
+            {
+                this->ok = this->ok && (this->bus_pos.read() == this->prv_bus);
+            }
+
+            if ((this->clk_cnt > 0) && b.val)
+            {
+                if (b.sof)
+                {
+                    this->got.clear();
+                }
+
+                dat_to_bytes<3>(b.dat, tmp);
+                this->got.insert(this->got.end(), tmp, tmp + bus_get_byte_cnt<3>(b));
+
+                if (b.eof)
+                {
+                    unsigned f = this->frm_cnt++;
+
+                    this->ok = this->ok && (b.usr == f) && (b.err == ((f % 5) == 4));
+                    this->ok = this->ok && (this->got.size() == this->len(f));
+
+                    for (unsigned k = 0 ; this->ok && (k < this->got.size()) ; k++)
+                    {
+                        this->ok = (this->got[k] == uint8_t(f + k));
+                    }
+                }
+            }
+
+            n.val = ((this->clk_cnt % 7) != 6);
+
+            if (n.val)
+            {
+                unsigned f   = this->tx_frm;
+                unsigned cnt = min(8U, this->len(f) - this->tx_pos);
+
+                for (unsigned k = 0 ; k < 8 ; k++)
+                {
+                    tmp[k] = (k < cnt) ? uint8_t(f + this->tx_pos + k) : 0;
+                }
+
+                n.usr = f;
+                n.sof = (this->tx_pos == 0);
+                n.eof = ((this->tx_pos + cnt) == this->len(f));
+                n.err = n.eof && ((f % 5) == 4);
+                n.mod = mod_set<3>(n.eof ? (cnt % 8) : 0);
+                n.dat = dat_from_bytes<3>(tmp, 8);
+
+                this->tx_pos = n.eof ? 0 : (this->tx_pos + cnt);
+                this->tx_frm = n.eof ? (f + 1) : f;
+            }
+
+            this->usr.write(n.usr);
+            this->err.write(n.err);
+            this->val.write(n.val);
+            this->sof.write(n.sof);
+            this->eof.write(n.eof);
+            this->mod.write(n.mod);
+            this->dat.write(n.dat);
+
+            this->prv_bus = this->exp_bus;
+            this->exp_bus = n;
+            this->clk_cnt = this->clk_cnt + 1;
+        }
+};
+
+/** \fn    test_merge()
+ *  \brief Checks test_merge_tb after the simulation has run
+ */
+
+bool test_merge(Msg& msg, test_merge_tb& arg_tb)
+{
+    string test = "testing Bus_merge<3>:";
+
+    if (!arg_tb.ok || (arg_tb.clk_cnt < 1000) || (arg_tb.frm_cnt < 100))
+    {
+        msg.cerr_err(test + SP + "FAIL");
+        return false;
+    }
+
+    msg.cerr_inf(test + SP + "OK," + SP + to_string(arg_tb.frm_cnt) + SP + "frames");
+    return true;
+}
+
+/** \class test_shm_writer
+ *  \brief Writer side of a Frm_shm ring, as pyshm_writer.py, for test 27
+ *
+ *  put() writes a frame and returns true, or returns false, writing
+ *  nothing, if the ring has no room for it.  The offsets are those of the
+ *  header layout in SyscFCBusShm.h.
+ */
+
+class test_shm_writer
+{
+    private:
+        uint8_t  * map;
+        size_t     map_len;
+        uint64_t   ring_len;
+        uint64_t   wr;
+
+    public:
+        uint64_t   pad_cnt;
+
+        test_shm_writer(const string & arg_shm)
+        {
+            int fd = shm_open(arg_shm.c_str(), O_RDWR, 0600);
+
+            this->map      = nullptr;
+            this->ring_len = 0;
+            this->wr       = 0;
+            this->pad_cnt  = 0;
+
+            if (fd < 0)
+            {
+                return;
+            }
+
+            struct stat st;
+
+            fstat(fd, &st);
+
+            this->map_len  = st.st_size;
+            this->map      = static_cast<uint8_t *>(mmap(nullptr, this->map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+            this->ring_len = *reinterpret_cast<uint64_t *>(this->map + 8);
+
+            ::close(fd);
+        }
+
+        ~test_shm_writer(void)
+        {
+            if (this->map != nullptr)
+            {
+                munmap(this->map, this->map_len);
+            }
+        }
+
+        uint64_t get_ring_len(void)
+        {
+            return this->ring_len;
+        }
+
+        uint64_t get_wr_pos(void)
+        {
+            return this->wr;
+        }
+
+        bool put(const vector<uint8_t> & arg_frm)
+        {
+            uint32_t   cnt  = arg_frm.size();
+            uint64_t   rec  = (4 + cnt + 7) & ~uint64_t(7);
+            uint64_t   off  = this->wr & (this->ring_len - 1);
+            uint64_t   tail = this->ring_len - off;
+            uint64_t   need = (tail >= rec) ? rec : (tail + rec);
+            uint64_t   rd   = __atomic_load_n(reinterpret_cast<uint64_t *>(this->map + 128), __ATOMIC_ACQUIRE);
+            uint32_t   pad  = 0xFFFFFFFF;
+            uint8_t  * data = this->map + 256;
+
+            if ((this->ring_len - (this->wr - rd)) < need)
+            {
+                return false;
+            }
+
+            if (tail < rec)
+            {
+                memcpy(data + off, &pad, 4);
+                this->wr      = this->wr + tail;
+                this->pad_cnt = this->pad_cnt + 1;
+                off           = 0;
+            }
+
+            memcpy(data + off, &cnt, 4);
+            memcpy(data + off + 4, arg_frm.data(), cnt);
+
+            this->wr = this->wr + rec;
+
+            __atomic_store_n(reinterpret_cast<uint64_t *>(this->map + 64), this->wr, __ATOMIC_RELEASE);
+
+            return true;
+        }
+
+        void finish(void)
+        {
+            __atomic_store_n(reinterpret_cast<uint32_t *>(this->map + 20), 1, __ATOMIC_RELEASE);
+        }
+};
+
+/** \fn    test_shm()
+ *  \brief Writes frames of 1 to 200 bytes into a 1024 byte Frm_shm ring
+ *  from this process and reads them back with get_frame()
+ *
+ *  Frames are written until the ring is full and then read until it is
+ *  empty, so the ring wraps and is padded many times.  Each frame read
+ *  is compared with the one written, and the two frames before it, which
+ *  the Frm_src validity rule keeps valid, are compared again.  After
+ *  end of stream get_frame() must return false.
+ */
+
+bool test_shm(Msg& msg)
+{
+    const unsigned   frames = 2000;
+    string           test   = "testing Frm_shm on a 1024 byte ring:";
+    string           shm    = "/syscfcbus_test1_" + to_string(getpid());
+    Frm_shm          src("test_shm", shm, 1024, "");
+    test_shm_writer  wr(shm);
+    vector<uint8_t>  frm;
+    const uint8_t  * got[3] = { nullptr, nullptr, nullptr };
+    unsigned         got_n[3];
+    unsigned         tx     = 0;
+    unsigned         rx     = 0;
+    bool             ok     = (wr.get_ring_len() == 1024);
+
+    auto frm_len  = [](unsigned arg_n) { return 1 + ((arg_n * 37) % 200); };
+    auto frm_byte = [](unsigned arg_n, unsigned arg_k) { return uint8_t((arg_n * 7) + arg_k); };
+    auto frm_chk  = [&](const uint8_t * arg_dat, unsigned arg_n)
+    {
+        for (unsigned k = 0 ; k < frm_len(arg_n) ; k++)
+        {
+            if (arg_dat[k] != frm_byte(arg_n, k))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    };
+
+    while (ok && (rx < frames))
+    {
+        while (tx < frames)
+        {
+            frm.resize(frm_len(tx));
+
+            for (unsigned k = 0 ; k < frm.size() ; k++)
+            {
+                frm[k] = frm_byte(tx, k);
+            }
+
+            if (!wr.put(frm))
+            {
+                break;
+            }
+
+            tx++;
+        }
+
+        if (tx == frames)
+        {
+            wr.finish();
+        }
+
+        while (ok && (rx < tx))
+        {
+            const uint8_t * dat = nullptr;
+            unsigned        cnt = 0;
+
+            ok = src.get_frame(dat, cnt) && (cnt == frm_len(rx)) && frm_chk(dat, rx);
+
+            got[rx % 3]   = dat;
+            got_n[rx % 3] = rx;
+
+            for (unsigned i = 0 ; ok && (i < 3) && (i <= rx) ; i++)
+            {
+                ok = frm_chk(got[(rx - i) % 3], got_n[(rx - i) % 3]);
+            }
+
+            rx++;
+        }
+    }
+
+    const uint8_t * dat = nullptr;
+    unsigned        cnt = 0;
+
+    ok = ok && !src.get_frame(dat, cnt) && (wr.get_wr_pos() > (8 * wr.get_ring_len())) && (wr.pad_cnt > 0);
+
+    if (!ok)
+    {
+        msg.cerr_err(test + SP + "FAIL");
+        return false;
+    }
+
+    msg.cerr_inf(test + SP + "OK," + SP + to_string(frames) + SP + "frames," + SP + to_string(wr.get_wr_pos() / wr.get_ring_len()) + SP + "wraps");
+    return true;
+}
+
+/** \fn    test_cache()
+ *  \brief Records 100 frames of a test_frm_src with a Frm_cache and
+ *  replays them from the file
+ *
+ *  The replay must return the recorded frames and then end, and the file
+ *  must be refused for 101 frames and for another request string.
+ */
+
+bool test_cache(Msg& msg)
+{
+    const unsigned  frames  = 100;
+    string          test    = "testing Frm_cache record and replay:";
+    char            dir[]   = "/tmp/syscfcbus_test1_XXXXXX";
+    bool            ok      = (mkdtemp(dir) != nullptr);
+    test_frm_src    src(0, 11);
+    test_frm_src    exp(0, 11);
+    Frm_cache       rec("test_cache", dir, "dot3_incr_len", "{}");
+    Frm_cache       play("test_cache", dir, "dot3_incr_len", "{}");
+    Frm_cache       other("test_cache", dir, "dot3_incr_len", "{\"max\":9000}");
+    const uint8_t * dat     = nullptr;
+    const uint8_t * exp_dat = nullptr;
+    unsigned        cnt     = 0;
+    unsigned        exp_cnt = 0;
+
+    rec.open_record(&src);
+
+    for (unsigned n = 0 ; ok && (n < frames) ; n++)
+    {
+        ok = rec.get_frame(dat, cnt) && (cnt == src.len(n));
+    }
+
+    rec.close();
+
+    ok = ok && (rec.get_frm_cnt() == frames) && play.open_replay(frames);
+
+    for (unsigned n = 0 ; ok && (n < frames) ; n++)
+    {
+        ok = play.get_frame(dat, cnt) && exp.get_frame(exp_dat, exp_cnt);
+        ok = ok && (cnt == exp_cnt) && (memcmp(dat, exp_dat, cnt) == 0);
+    }
+
+    ok = ok && !play.get_frame(dat, cnt) && !play.open_replay(frames + 1) && !other.open_replay();
+
+    unlink(play.get_path().c_str());
+    rmdir(dir);
+
+    if (!ok)
+    {
+        msg.cerr_err(test + SP + "FAIL");
+        return false;
+    }
+
+    msg.cerr_inf(test + SP + "OK," + SP + to_string(frames) + SP + "frames");
+    return true;
+}
+
+/** \class test_len_src
+ *  \brief Frame source of frames of one length, for test 15
+ */
+
+class test_len_src : public Frm_src
+{
+    private:
+        vector<uint8_t> buf;
+        unsigned        cnt;
+
+    public:
+        test_len_src(unsigned arg_len, unsigned arg_cnt) : buf(arg_len, arg_len & 0xff), cnt(arg_cnt) { }
+
+        bool get_frame(const uint8_t *& arg_dat, unsigned & arg_cnt)
+        {
+            if (this->cnt == 0)
+            {
+                return false;
+            }
+
+            arg_dat = this->buf.data();
+            arg_cnt = this->buf.size();
+            this->cnt--;
+
+            return true;
+        }
+};
+
+/** \fn    test_sched()
+ *  \brief Checks the Sched_bitmap search, the frame shares of the three
+ *  Frm_sched modes and the usr tags driven by a Bus_src_eng
+ */
+
+bool test_sched(Msg& msg)
+{
+    Sched_bitmap bm;
+    bool         ok   = true;
+    string       test = "testing Frm_sched:";
+
+    bm.resize(100000);
+    bm.set(3);
+    bm.set(70000);
+    bm.set(99999);
+
+    ok = ok && (bm.find_next(0) == 3) && (bm.find_next(4) == 70000) && (bm.find_next(70001) == 99999);
+    bm.clr(70000);
+    ok = ok && (bm.find_next(4) == 99999);
+    bm.clr(3);
+    bm.clr(99999);
+    ok = ok && bm.empty() && (bm.find_next(0) == -1);
+
+    {
+        test_len_src    s0(64, 5);
+        test_len_src    s1(64, 100);
+        Frm_sched       sc("prio", Frm_sched::sched_prio);
+        const uint8_t * dat;
+        unsigned        cnt;
+
+        sc.add_queue(&s0, 1, 10);
+        sc.add_queue(&s1, 1, 11);
+
+        for (unsigned i = 0 ; i < 8 ; i++)
+        {
+            sc.get_frame(dat, cnt);
+            ok = ok && (sc.get_usr() == ((i < 5) ? 10u : 11u));
+        }
+    }
+
+    {
+        test_len_src    s0(64, 1000);
+        test_len_src    s1(64, 1000);
+        Frm_sched       sc("wrr", Frm_sched::sched_wrr);
+        const uint8_t * dat;
+        unsigned        cnt;
+
+        sc.add_queue(&s0, 1, 0);
+        sc.add_queue(&s1, 3, 1);
+
+        for (unsigned i = 0 ; i < 400 ; i++)
+        {
+            sc.get_frame(dat, cnt);
+        }
+
+        ok = ok && (sc.get_frm_cnt(0) == 100) && (sc.get_frm_cnt(1) == 300);
+    }
+
+    {
+        test_len_src    s0(100, 100000);
+        test_len_src    s1(1000, 100000);
+        test_len_src    s2(60, 3);
+        Frm_sched       sc("drr", Frm_sched::sched_drr);
+        Bus_src_eng<2>  eng("eng");
+        bool            ack = false;
+        uint64_t        b0;
+        uint64_t        b1;
+
+        sc.add_queue(&s0, 1500, 100);
+        sc.add_queue(&s1, 1500, 1000);
+        sc.add_queue(&s2, 1500, 60);
+        eng.set_frm_src(&sc);
+
+        for (unsigned clk = 0 ; clk < 100000 ; clk++)
+        {
+            const Bus<2> & bus = eng.step(true, ack);
+
+            ack = eng.get_req();
+
+            if (bus.val && bus.sof)
+            {
+                uint8_t tmp[4];
+
+                dat_to_bytes<2>(bus.dat, tmp);
+                ok = ok && ((bus.usr & 0xff) == tmp[0]);
+            }
+        }
+
+        b0 = sc.get_byte_cnt(0);
+        b1 = sc.get_byte_cnt(1);
+        ok = ok && (sc.get_frm_cnt(2) == 3) && (b0 > 0) && ((b0 > b1) ? (b0 - b1) : (b1 - b0)) <= 3000;
+    }
+
+    if (!ok)
+    {
+        msg.cerr_err(test + SP + "FAIL");
+        return false;
+    }
+
+    msg.cerr_inf(test + SP + "OK");
+    return true;
+}
+
+/** \fn    test_pace()
+ *  \brief Steps a paced Bus_src_eng<3>, with dav low one clock in arg_stall
+ *  if non-zero, and checks the bytes driven per clock against the rate
+ *  allowing for the initial burst
+ */
+
+bool test_pace(Msg& msg, uint32_t arg_num, uint32_t arg_den, unsigned arg_ovh, unsigned arg_stall)
+{
+    test_len_src    src(64, 100000);
+    Bus_src_eng<3>  eng("eng");
+    bool            ack   = false;
+    uint64_t        bytes = 0;
+    uint64_t        frms  = 0;
+    const unsigned  clks  = 200000;
+    double          want  = double(arg_num) / arg_den;
+    double          got;
+    string          test  = "testing Bus_src_eng pace" + SP + to_string(arg_num) + "/" + to_string(arg_den) + ":";
+
+    eng.set_frm_src(&src);
+    eng.set_pace(arg_num, arg_den, 256, arg_ovh);
+
+    for (unsigned clk = 0 ; clk < clks ; clk++)
+    {
+        bool           dav = (arg_stall == 0) || ((clk % arg_stall) != 0);
+        const Bus<3> & bus = eng.step(dav, ack);
+
+        ack = eng.get_req();
+
+        if (dav && bus.val)
+        {
+            bytes = bytes + bus_get_byte_cnt<3>(bus);
+            frms  = frms + (bus.eof ? 1 : 0);
+        }
+    }
+
+    got = double(bytes + (frms * arg_ovh)) / clks;
+
+    if ((got > (want + (256.0 / clks))) || (got < (want * 0.999)))
+    {
+        msg.cerr_err(test + SP + "FAIL, got" + SP + to_string(got));
+        return false;
+    }
+
+    msg.cerr_inf(test + SP + "OK, got" + SP + to_string(got));
+    return true;
+}
+
+/** \fn    test_cell()
+ *  \brief Drives cells of 65536 circuits through a Cell_chk, checks that
+ *  one circuit gets every fourth cell time and that a corrupted beat is
+ *  caught
+ */
+
+template <unsigned T_be>
+bool test_cell(Msg& msg, bool arg_hdr)
+{
+    Cell_sched      sched("sched", 1 << 19);
+    Cell_eng<T_be>  eng("eng", &sched, arg_hdr);
+    Cell_chk<T_be>  chk("chk", arg_hdr);
+    const uint8_t   idle[4] = { 0, 0, 0, 1 };
+    unsigned        fast    = 0;
+    bool            bad     = false;
+    uint64_t        cells   = 300000;
+    bool            ok      = (cell_hec(idle) == 0x52);
+    string          test    = "testing Cell_eng<" + to_string(T_be) + ">" + SP + (arg_hdr ? "53" : "48") + SP + "byte cells:";
+
+    fast = sched.add_vc((0x2 << 28) | (0x123 << 16) | 0x4567, 4, 0);
+
+    for (unsigned i = 1 ; i < Cell_sched::vc_max ; i++)
+    {
+        sched.add_vc(((i >> 4) << 16) | (i * 3), 262144, (i * 4) + 2);
+    }
+
+    for (uint64_t clk = 0 ; clk < (cells * eng.beats()) ; clk++)
+    {
+        bool dav = ((clk % 11) != 0);
+
+        if (dav)
+        {
+            Bus<T_be> bus = eng.step(true);
+
+            if ((clk >= 1000) && bus.sof && !bad)
+            {
+                uint8_t tmp[1 << T_be];
+
+                dat_to_bytes<T_be>(bus.dat, tmp);
+                tmp[0]  = tmp[0] ^ 1;
+                bus.dat = dat_from_bytes<T_be>(tmp, 1 << T_be);
+                bad     = true;
+            }
+
+            chk.put(bus);
+        }
+    }
+
+    ok = ok && (chk.get_err_cnt() == 1) && (chk.get_cell_cnt() == eng.get_cell_cnt());
+    ok = ok && (chk.get_vc_cnt() == Cell_sched::vc_max);
+    ok = ok && (sched.get_seq(fast) == ((eng.get_cell_cnt() + eng.get_idle_cnt() + 3) / 4));
+
+    if (!ok)
+    {
+        msg.cerr_err(test + SP + "FAIL");
+        return false;
+    }
+
+    msg.cerr_inf(test + SP + "OK," + SP + to_string(eng.get_cell_cnt()) + SP + "cells");
+    return true;
+}
+
+/** \fn    test_part()
+ *  \brief Steps a Bus_src_eng in part-frame mode with dav stalls, checks
+ *  the frames reassembled from it's beats and that gaps and short beats
+ *  occur within frames
+ */
+
+template <unsigned T_be>
+bool test_part(Msg& msg, uint64_t arg_seed)
+{
+    test_eng<T_be>    fix;
+    vector<uint8_t>   got;
+    unsigned          frm_cnt  = 0;
+    uint64_t          gap_cnt  = 0;
+    uint64_t          part_cnt = 0;
+    bool              in_frm   = false;
+    bool              ok       = true;
+    string            test     = "testing Bus_src_eng<" + to_string(T_be) + "> part-frame mode:";
+
+    fix.eng.set_part(arg_seed, 20, 3, 30);
+
+    for (unsigned clk = 0 ; clk < 20000 ; clk++)
+    {
+        bool              dav = ((clk % 13) != 0);
+        const Bus<T_be> & bus = fix.step(dav);
+        uint8_t           tmp[1 << T_be];
+        unsigned          cnt = bus_get_byte_cnt<T_be>(bus);
+
+        if (!dav)
+        {
+            continue;
+        }
+
+        if (!bus.val)
+        {
+            gap_cnt = gap_cnt + (in_frm ? 1 : 0);
+            continue;
+        }
+
+        ok = ok && (bus.sof != in_frm);
+
+        if (bus.sof)
+        {
+            got.clear();
+        }
+
+        part_cnt = part_cnt + ((!bus.eof && (cnt < (1U << T_be))) ? 1 : 0);
+
+        dat_to_bytes<T_be>(bus.dat, tmp);
+        got.insert(got.end(), tmp, tmp + cnt);
+
+        if (bus.eof)
+        {
+            unsigned n = frm_cnt++;
+
+            ok = ok && (got.size() == fix.src.len(n));
+
+            for (unsigned i = 0 ; ok && (i < got.size()) ; i++)
+            {
+                ok = (got[i] == uint8_t((n % 5) + i));
+            }
+        }
+
+        in_frm = !bus.eof;
+    }
+
+    ok = ok && (frm_cnt > 100) && (gap_cnt > 0) && ((T_be == 0) || (part_cnt > 0));
+
+    if (!ok)
+    {
+        msg.cerr_err(test + SP + "FAIL");
+        return false;
+    }
+
+    msg.cerr_inf(test + SP + "OK," + SP + to_string(frm_cnt) + SP + "frames," + SP + to_string(gap_cnt) + SP + "gaps," + SP + to_string(part_cnt) + SP + "short beats");
+    return true;
+}
+
+/** \fn    test_seg()
+ *  \brief Drives frames of arg_len bytes, or of test_frm_src lengths when
+ *  zero, through a Seg_eng and Seg_chk with dav stalls, and checks the
+ *  beats used against the segments the frames fill
+ */
+
+template <unsigned T_be, unsigned T_se>
+bool test_seg(Msg& msg, unsigned arg_len)
+{
+    const unsigned        frms = 1000;
+    test_len_src          len_src(arg_len, frms);
+    test_len_src          len_ref(arg_len, frms);
+    test_frm_src          var_src(frms);
+    test_frm_src          var_ref(frms);
+    Frm_src             * src  = (arg_len == 0) ? static_cast<Frm_src*>(&var_src) : &len_src;
+    Frm_src             * ref  = (arg_len == 0) ? static_cast<Frm_src*>(&var_ref) : &len_ref;
+    Seg_eng<T_be, T_se>   eng("eng", src);
+    Seg_chk<T_be, T_se>   chk("chk", ref);
+    unsigned              sb   = Bus_seg<T_be, T_se>::seg_bytes;
+    uint64_t              segs = 0;
+    bool                  ok   = true;
+    string                test = "testing Seg_eng<" + to_string(T_be) + "," + to_string(T_se) + ">"
+                                 + SP + ((arg_len == 0) ? string("mixed") : to_string(arg_len)) + SP + "byte frames:";
+
+    for (unsigned clk = 0 ; !eng.get_done() ; clk++)
+    {
+        bool dav = ((clk % 7) != 0);
+
+        if (dav)
+        {
+            chk.put(eng.step(true));
+        }
+    }
+
+    for (unsigned i = 0 ; i < frms ; i++)
+    {
+        unsigned len = (arg_len == 0) ? var_src.len(i) : arg_len;
+
+        segs = segs + ((len + sb - 1) / sb);
+    }
+
+    ok = ok && (chk.get_frm_cnt() == frms) && (chk.get_err_cnt() == 0);
+    ok = ok && (eng.get_beat_cnt() == ((segs + Bus_seg<T_be, T_se>::segs - 1) / Bus_seg<T_be, T_se>::segs));
+
+    if (!ok)
+    {
+        msg.cerr_err(test + SP + "FAIL");
+        return false;
+    }
+
+    msg.cerr_inf(test + SP + "OK," + SP + to_string(frms) + SP + "frames in" + SP + to_string(eng.get_beat_cnt()) + SP + "beats");
+    return true;
+}
+
+/** \fn    test_fcs()
+ *  \brief Checks crc32() against the standard check value, then drives
+ *  frames with an FCS appended by Frm_fcs and by Frm_fcs_stream through
+ *  Bus_src_eng, checking them with Fcs_chk; one beat is corrupted and must
+ *  give one bad FCS
+ */
+
+template <unsigned T_be>
+bool test_fcs(Msg& msg)
+{
+    const uint8_t      chk_str[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    test_frm_src       src;
+    Frm_fcs            fcs_src(&src);
+    Frm_gen_dot3       gen(50, 1500, 1, 64);
+    Frm_fcs_stream     fcs_gen(&gen);
+    Bus_src_eng<T_be>  eng_src("eng_src");
+    Bus_src_eng<T_be>  eng_gen("eng_gen");
+    Fcs_chk<T_be>      chk_src;
+    Fcs_chk<T_be>      chk_gen;
+    bool               ack_src   = false;
+    bool               ack_gen   = false;
+    bool               bad       = false;
+    bool               ok        = true;
+    string             test      = "testing Fcs_chk<" + to_string(T_be) + ">:";
+
+    ok = ok && (crc32(chk_str, sizeof(chk_str)) == 0xCBF43926);
+
+    eng_src.set_frm_src(&fcs_src);
+    eng_gen.set_frm_stream(&fcs_gen, 256);
+
+    for (unsigned clk = 0 ; clk < 20000 ; clk++)
+    {
+        Bus<T_be> b = eng_src.step(true, ack_src);
+
+        ack_src = eng_src.get_req();
+
+        if (!bad && b.val && b.sof && (clk >= 1000))
+        {
+            uint8_t tmp[1 << T_be];
+
+            dat_to_bytes<T_be>(b.dat, tmp);
+            tmp[0] = tmp[0] ^ 0x10;
+            b.dat  = dat_from_bytes<T_be>(tmp, 1 << T_be);
+            bad    = true;
+        }
+
+        chk_src.put(b);
+        chk_gen.put(eng_gen.step(true, ack_gen));
+
+        ack_gen = eng_gen.get_req();
+    }
+
+    ok = ok && (chk_src.get_frm_cnt() > 100) && (chk_src.get_bad_cnt() == 1);
+    ok = ok && (chk_gen.get_frm_cnt() > 10)  && (chk_gen.get_bad_cnt() == 0);
+
+    if (!ok)
+    {
+        msg.cerr_err(test + SP + "FAIL");
+        return false;
+    }
+
+    msg.cerr_inf
+    (
+        test + SP + "OK," + SP + to_string(chk_src.get_frm_cnt() + chk_gen.get_frm_cnt()) + SP + "frames,"
+        + SP + to_string(chk_src.get_bad_cnt()) + SP + "corrupted"
+    );
+
+    return true;
+}
+
+/** \fn    test_err()
+ *  \brief Steps a Bus_src_eng injecting every kind of error into frames
+ *  of 1 to 301 bytes, with dav stalls and optionally in part-frame mode,
+ *  and checks each frame against the plan taken at it's sof, and that
+ *  runts of long frames are cut below 64 bytes while truncations are not
+ */
+
+template <unsigned T_be>
+bool test_err(Msg& msg, bool arg_part)
+{
+    test_eng<T_be>    fix(75);
+    vector<uint8_t>   got;
+    vector<uint8_t>   exp;
+    err_plan          plan     = { err_none, 0, 0, 0, 0 };
+    uint64_t          seen[err_LAST] = { 0 };
+    unsigned          frm_cnt  = 0;
+    unsigned          trunc_long = 0;
+    unsigned          runt_long  = 0;
+    bool              obs_err  = false;
+    bool              in_frm   = false;
+    bool              ok       = true;
+    string            test     = "testing Bus_src_eng<" + to_string(T_be) + "> error injection"
+                                 + (arg_part ? ", part-frame mode:" : ":");
+
+    fix.eng.set_err(7, 40);
+
+    for (unsigned i = err_flip ; i < err_LAST ; i++)
+    {
+        fix.eng.set_err_rate(static_cast<enum_err_kind>(i), 125000);
+    }
+
+    if (arg_part)
+    {
+        fix.eng.set_part(5, 20, 3, 30);
+    }
+
+    for (unsigned clk = 0 ; clk < 60000 ; clk++)
+    {
+        bool              dav = ((clk % 13) != 0);
+        const Bus<T_be> & bus = fix.step(dav);
+        uint8_t           tmp[1 << T_be];
+
+        if (!dav || !bus.val)
+        {
+            continue;
+        }
+
+        ok = ok && (bus.sof != in_frm);
+
+        if (bus.sof)
+        {
+            unsigned n = frm_cnt++;
+
+            ok = ok && fix.eng.pop_err_plan(plan) && (plan.orig == fix.src.len(n));
+
+            exp.clear();
+            got.clear();
+            obs_err = false;
+
+            for (unsigned i = 0 ; i < plan.len ; i++)
+            {
+                exp.push_back((i < plan.orig) ? uint8_t((n % 5) + i) : uint8_t(i));
+            }
+
+            if (plan.kind == err_flip)
+            {
+                exp[plan.pos] = exp[plan.pos] ^ (1 << plan.bit);
+            }
+        }
+
+        dat_to_bytes<T_be>(bus.dat, tmp);
+        got.insert(got.end(), tmp, tmp + bus_get_byte_cnt<T_be>(bus));
+        obs_err = obs_err || bus.err;
+
+        if (bus.eof || ((plan.kind == err_eof) && (got.size() == plan.len)))
+        {
+            ok = ok && (got == exp) && (bus.eof == (plan.kind != err_eof)) && (obs_err == (plan.kind == err_err));
+            ok = ok && ((plan.kind != err_runt) || (plan.len < 64)) && ((plan.kind != err_over) || (plan.len > 40));
+
+            trunc_long = trunc_long + (((plan.kind == err_trunc) && (plan.len > 64)) ? 1 : 0);
+            runt_long  = runt_long + (((plan.kind == err_runt) && (plan.orig > 64)) ? 1 : 0);
+
+            seen[plan.kind] = seen[plan.kind] + 1;
+            in_frm          = false;
+        }
+        else
+        {
+            in_frm          = true;
+        }
+    }
+
+    for (unsigned i = err_none ; i < err_LAST ; i++)
+    {
+        ok = ok && (seen[i] > 0) && (fix.eng.get_err_cnt(static_cast<enum_err_kind>(i)) >= seen[i]);
+    }
+
+    ok = ok && (trunc_long > 0) && (runt_long > 0);
+
+    if (!ok)
+    {
+        msg.cerr_err(test + SP + "FAIL");
+        return false;
+    }
+
+    msg.cerr_inf(test + SP + "OK," + SP + to_string(frm_cnt) + SP + "frames," + SP + to_string(frm_cnt - seen[err_none]) + SP + "with errors");
+    return true;
+}
+
+/** \fn    test_rules()
+ *  \brief Checks Bus_rules on a sequence breaking each rule once, then on
+ *  the beats of a Bus_src_eng in part-frame mode with dropped eofs
+ *  injected, which must break only the sof rule, once per dropped eof
+ */
+
+template <unsigned T_be>
+bool test_rules(Msg& msg)
+{
+    const unsigned    V = ctl_val, S = ctl_sof, E = ctl_eof, R = ctl_err, M = ctl_mod;
+    const unsigned    seq[] = { V|S, V, 0, V|M, V|S, V|R, V, V|E, V, V|S|E, V|S|R, V|R|M|E };
+    const unsigned    exp[] = { rule_ok, rule_ok, rule_gap_in_frm, rule_mod_not_eof, rule_sof_in_frm, rule_ok,
+                                rule_err_dropped, rule_ok, rule_beat_out_frm, rule_ok, rule_ok, rule_ok };
+    Bus_rules         strict(false, false);
+    Bus_rules         drop(true, true);
+    test_eng<T_be>    fix;
+    uint64_t          sof_cnt  = 0;
+    uint64_t          drop_cnt = 0;
+    bool              ok       = true;
+    string            test     = "testing Bus_rules<" + to_string(T_be) + ">:";
+
+    for (unsigned i = 0 ; i < (sizeof(seq) / sizeof(seq[0])) ; i++)
+    {
+        ok = ok && (strict.step(seq[i]) == exp[i]);
+    }
+
+    fix.eng.set_part(3, 20, 3, 30);
+    fix.eng.set_err(3, 64);
+    fix.eng.set_err_rate(err_eof, 100000);
+
+    for (unsigned clk = 0 ; clk < 20000 ; clk++)
+    {
+        bool              dav = ((clk % 11) != 0);
+        const Bus<T_be> & bus = fix.step(dav);
+        err_plan          plan;
+
+        if (!dav)
+        {
+            continue;
+        }
+
+        if (bus.val && bus.sof)
+        {
+            fix.eng.pop_err_plan(plan);
+            drop_cnt = drop_cnt + ((plan.kind == err_eof) ? 1 : 0);
+        }
+
+        enum_bus_rule rule = drop.step(bus_ctl<T_be>(bus));
+
+        ok      = ok && ((rule == rule_ok) || (rule == rule_sof_in_frm));
+        sof_cnt = sof_cnt + ((rule == rule_sof_in_frm) ? 1 : 0);
+    }
+
+    ok = ok && (drop_cnt > 0) && (sof_cnt <= drop_cnt) && ((sof_cnt + 1) >= drop_cnt);
+
+    if (!ok)
+    {
+        msg.cerr_err(test + SP + "FAIL");
+        return false;
+    }
+
+    msg.cerr_inf(test + SP + "OK," + SP + to_string(sof_cnt) + SP + "sof rule violations for" + SP + to_string(drop_cnt) + SP + "dropped eofs");
+    return true;
+}
+
+/** \fn    test_log()
+ *  \brief Puts more messages than the Log ring holds into a file sink,
+ *  checks that each is written once and in order with it's arguments as
+ *  they were when put, and that messages above SYSCFCBUS_LOG_LEVEL
+ *  are compiled out
+ */
+
+bool test_log(Msg& msg)
+{
+    const unsigned cnt  = 3 * log_ring_len + 7;
+    const string   path = "test_log.txt";
+    Log          & lg   = Log::get();
+    Log_src        src("test.log");
+    uint64_t       dbg  = lg.get_put_cnt(lvl_dbg);
+    string         str  = "a";
+    unsigned       inf_cnt  = (SYSCFCBUS_LOG_LEVEL >= lvl_inf) ? cnt : 0;
+    unsigned       err_cnt  = (SYSCFCBUS_LOG_LEVEL >= lvl_err) ? 1 : 0;
+    string         line;
+    unsigned       line_cnt = 0;
+    bool           ok       = true;
+    string         test     = "testing Log:";
+
+    lg.set_path(path);
+
+    for (unsigned i = 0 ; i < cnt ; i++)
+    {
+        str[0] = 'a' + (i % 26);
+        log_inf(src, "frame {} len {} dlt {} sc {} s {}", i, 64 + i, -static_cast<int>(i), 0.5, str);
+        log_dbg(src, "frame {} not compiled in", i);
+    }
+
+    log_err(src, "{} and {} with {}", "two", 2U);
+    lg.flush();
+
+    ifstream ifs(path);
+
+    while (getline(ifs, line))
+    {
+        string exp;
+
+        if (line.find("[DBG]") != string::npos)
+        {
+            continue;
+        }
+
+        if (line_cnt < inf_cnt)
+        {
+            exp = "[INF] test.log frame" + SP + to_string(line_cnt) + SP + "len" + SP + to_string(64 + line_cnt) + SP
+                + "dlt" + SP + to_string(-static_cast<int>(line_cnt)) + SP + "sc 0.5 s" + SP + string(1, 'a' + (line_cnt % 26));
+        }
+        else
+        {
+            exp = "[ERR] test.log two and 2 with {}";
+        }
+
+        if ((line.size() < exp.size()) || (line.compare(line.size() - exp.size(), exp.size(), exp) != 0))
+        {
+            msg.cerr_err(test + SP + "line" + SP + to_string(line_cnt) + SP + "is" + SP + line);
+            ok = false;
+            break;
+        }
+
+        line_cnt = line_cnt + 1;
+    }
+
+    lg.set_path("");
+    remove(path.c_str());
+
+    ok = ok && (line_cnt == (inf_cnt + err_cnt));
+    ok = ok && ((SYSCFCBUS_LOG_LEVEL >= lvl_dbg) == (lg.get_put_cnt(lvl_dbg) == (dbg + cnt)));
+
+    if (!ok)
+    {
+        msg.cerr_err(test + SP + "FAIL," + SP + to_string(line_cnt) + SP + "lines");
+        return false;
+    }
+
+    msg.cerr_inf(test + SP + "OK," + SP + to_string(line_cnt) + SP + "lines");
+    return true;
+}
+
 void
 test_message(Msg& msg, unsigned arg)
 {
@@ -70,6 +2006,110 @@ test_message(Msg& msg, unsigned arg)
     msg.cerr_inf("be is" + SP + to_string(arg));
 }
 
+/** \fn    test_wide_run()
+ *  \brief Drives frames of 1 to 601 bytes through a Bus_src_eng of a
+ *  width with a Dat_wide dat field, optionally in part-frame mode, and
+ *  checks each frame's bytes and that multi-beat frames end with mod set
+ */
+
+template <unsigned T_be>
+bool test_wide_run(bool arg_part, unsigned & arg_frm_cnt)
+{
+    constexpr unsigned bytes   = (1 << T_be);
+    uint8_t            out[bytes];
+    test_eng<T_be>     fix(150);
+    vector<uint8_t>    got;
+    unsigned           frm_cnt = 0;
+    unsigned           mod_cnt = 0;
+    bool               ok      = true;
+
+    if (arg_part)
+    {
+        fix.eng.set_part(1, 20, 3, 30);
+    }
+
+    for (unsigned clk = 0 ; clk < 4000 ; clk++)
+    {
+        bool              dav = ((clk % 13) != 0);
+        const Bus<T_be> & b   = fix.step(dav);
+
+        if (!dav || !b.val)
+        {
+            continue;
+        }
+
+        if (b.sof)
+        {
+            got.clear();
+        }
+
+        dat_to_bytes<T_be>(b.dat, out);
+        got.insert(got.end(), out, out + bus_get_byte_cnt<T_be>(b));
+
+        if (b.eof)
+        {
+            unsigned n = frm_cnt++;
+
+            ok      = ok && (got.size() == fix.src.len(n));
+            mod_cnt = mod_cnt + ((mod_get_uint<T_be>(b.mod) != 0) ? 1 : 0);
+
+            for (unsigned i = 0 ; ok && (i < got.size()) ; i++)
+            {
+                ok = (got[i] == uint8_t((n % 5) + i));
+            }
+        }
+    }
+
+    arg_frm_cnt = frm_cnt;
+
+    return ok && (frm_cnt > 100) && (mod_cnt > 0);
+}
+
+/** \fn    test_wide()
+ *  \brief Checks the copy and ostream operators and the byte packing of
+ *  a Bus with a Dat_wide dat field, then test_wide_run() in whole-beat
+ *  and part-frame modes
+ */
+
+template <unsigned T_be>
+bool test_wide(Msg& msg)
+{
+    constexpr unsigned bytes    = (1 << T_be);
+    Bus<T_be>          bus      = bus_rst<T_be>();
+    Dat<T_be>          dat;
+    uint8_t            buf[bytes];
+    uint8_t            out[bytes];
+    unsigned           frm_cnt  = 0;
+    unsigned           part_cnt = 0;
+    bool               ok       = true;
+    string             test     = "testing Bus_src_eng<" + to_string(T_be) + ">:";
+
+    test_message(msg, T_be);
+
+    for (unsigned i = 0 ; i < bytes ; i++)
+    {
+        buf[i] = 0xA5 + i;
+    }
+
+    dat = dat_from_bytes<T_be>(buf, bytes);
+    dat_to_bytes<T_be>(dat, out);
+
+    ok = ok && (memcmp(buf, out, bytes) == 0) && ((dat.get_word(0) & 0xFF) == buf[bytes - 1]);
+    ok = test_operator_copy<T_be>(msg, bus, dat) && ok;
+    ok = test_operator_ostream<T_be>(msg, bus) && ok;
+    ok = test_wide_run<T_be>(false, frm_cnt) && ok;
+    ok = test_wide_run<T_be>(true, part_cnt) && ok;
+
+    if (!ok)
+    {
+        msg.cerr_err(test + SP + "FAIL");
+        return false;
+    }
+
+    msg.cerr_inf(test + SP + "OK," + SP + to_string(frm_cnt) + SP + "frames," + SP + to_string(part_cnt) + SP + "in part-frame mode");
+    return true;
+}
+
 int
 sc_main(int argc, char *argv[])
 {
@@ -199,6 +2239,231 @@ sc_main(int argc, char *argv[])
         msg.cerr_inf("instatiating Bus_src<4>: OK");
     }
 
+    if (enable_test_10)
+    {
+        bool tmp_pass = true;
+
+        cerr << NL;
+
+        for (unsigned i = 0 ; i <= be_max ; i++)
+        {
+            if (be_dispatch<bus_bits>(i) != (8U << i))
+            {
+                tmp_pass = false;
+            }
+        }
+
+        try
+        {
+            be_dispatch<bus_bits>(be_max + 1);
+            tmp_pass = false;
+        }
+        catch (string & err)
+        {
+        }
+
+        if (tmp_pass)
+        {
+            msg.cerr_inf("be_dispatch(): OK");
+        }
+        else
+        {
+            msg.cerr_err("be_dispatch(): FAIL");
+            pass = false;
+        }
+    }
+
+    if (enable_test_11)
+    {
+        cerr << NL;
+
+        pass = test_gearbox<3, 6>(msg) && pass;
+        pass = test_gearbox<6, 3>(msg) && pass;
+        pass = test_gearbox<0, 4>(msg) && pass;
+        pass = test_gearbox<2, 2>(msg) && pass;
+    }
+
+    if (enable_test_12)
+    {
+        cerr << NL;
+
+        pass = test_vl_bind<0, uint8_t>(msg)      && pass;
+        pass = test_vl_bind<3, uint64_t>(msg)     && pass;
+        pass = test_vl_bind<6, uint32_t[16]>(msg) && pass;
+    }
+
+    if (enable_test_13)
+    {
+        cerr << NL;
+
+#if defined(__cpp_impl_coroutine) && (__cpp_impl_coroutine >= 201902L)
+        pass = test_co_drv(msg) && pass;
+#else
+        msg.cerr_inf("coroutines not supported by the compiler, Co_drv not tested");
+#endif
+    }
+
+    if (enable_test_15)
+    {
+        cerr << NL;
+
+        pass = test_sched(msg) && pass;
+    }
+
+    if (enable_test_16)
+    {
+        cerr << NL;
+
+        pass = test_pace(msg, 16, 5, 0, 97)     && pass;
+        pass = test_pace(msg, 7992, 1000, 0, 0) && pass;
+        pass = test_pace(msg, 1, 3, 20, 97)     && pass;
+    }
+
+    if (enable_test_17)
+    {
+        cerr << NL;
+
+        pass = test_cell<0>(msg, true)  && pass;
+        pass = test_cell<3>(msg, false) && pass;
+        pass = test_cell<6>(msg, true)  && pass;
+    }
+
+    if (enable_test_18)
+    {
+        cerr << NL;
+
+        pass = test_part<0>(msg, 1) && pass;
+        pass = test_part<3>(msg, 2) && pass;
+        pass = test_part<6>(msg, 3) && pass;
+    }
+
+    if (enable_test_19)
+    {
+        cerr << NL;
+
+        pass = test_seg<6, 3>(msg, 65) && pass;
+        pass = test_seg<6, 0>(msg, 65) && pass;
+        pass = test_seg<4, 2>(msg, 0)  && pass;
+        pass = test_seg<2, 2>(msg, 0)  && pass;
+    }
+
+    if (enable_test_20)
+    {
+        pass = test_wide<7>(msg) && pass;
+        pass = test_wide<8>(msg) && pass;
+
+        cerr << NL;
+
+        pass = test_gearbox<3, 8>(msg) && pass;
+        pass = test_gearbox<8, 6>(msg) && pass;
+    }
+
+    if (enable_test_21)
+    {
+        cerr << NL;
+
+        pass = test_fcs<0>(msg) && pass;
+        pass = test_fcs<3>(msg) && pass;
+        pass = test_fcs<6>(msg) && pass;
+    }
+
+    if (enable_test_22)
+    {
+        cerr << NL;
+
+        pass = test_err<0>(msg, false) && pass;
+        pass = test_err<3>(msg, false) && pass;
+        pass = test_err<6>(msg, true)  && pass;
+    }
+
+    if (enable_test_23)
+    {
+        cerr << NL;
+
+        pass = test_rules<0>(msg) && pass;
+        pass = test_rules<3>(msg) && pass;
+        pass = test_rules<6>(msg) && pass;
+    }
+
+    if (enable_test_24)
+    {
+        cerr << NL;
+
+        pass = test_log(msg) && pass;
+    }
+
+    if (enable_test_27)
+    {
+        cerr << NL;
+
+        pass = test_shm(msg) && pass;
+    }
+
+    if (enable_test_28)
+    {
+        cerr << NL;
+
+        pass = test_cache(msg) && pass;
+    }
+
+    unique_ptr<test_mon_tb>   tb_09;
+    unique_ptr<test_array_tb> tb_14;
+    unique_ptr<test_split_tb> tb_25;
+    unique_ptr<test_merge_tb> tb_26;
+
+    if (enable_test_09)
+    {
+        tb_09 = unique_ptr<test_mon_tb>(new test_mon_tb("i_mon_tb"));
+    }
+
+    if (enable_test_14)
+    {
+        tb_14 = unique_ptr<test_array_tb>(new test_array_tb("i_array_tb"));
+    }
+
+    if (enable_test_25)
+    {
+        tb_25 = unique_ptr<test_split_tb>(new test_split_tb("i_split_tb"));
+    }
+
+    if (enable_test_26)
+    {
+        tb_26 = unique_ptr<test_merge_tb>(new test_merge_tb("i_merge_tb"));
+    }
+
+    if (enable_test_09 || enable_test_14 || enable_test_25 || enable_test_26)
+    {
+        sc_start(20, SC_US);
+    }
+
+    if (enable_test_09)
+    {
+        cerr << NL;
+
+        pass = test_mon(msg, *tb_09) && pass;
+    }
+
+    if (enable_test_14)
+    {
+        cerr << NL;
+
+        pass = test_src_array(msg, *tb_14) && pass;
+    }
+
+    if (enable_test_25)
+    {
+        cerr << NL;
+
+        pass = test_split(msg, *tb_25) && pass;
+    }
+
+    if (enable_test_26)
+    {
+        cerr << NL;
+
+        pass = test_merge(msg, *tb_26) && pass;
+    }
+
     cerr << NL;
 
     if (pass)